@@ -36,6 +36,23 @@ struct Output: optimizationtools::Output
     /** Elapsed time. */
     double time = 0.0;
 
+    /**
+     * True if 'added_sets' and 'removed_sets' contain the sets added to and
+     * removed from 'solution' since the previous call of the new solution
+     * callback.
+     *
+     * Set by the algorithms which track the modifications of their best
+     * solution, so that the callback doesn't have to compare the whole
+     * solutions.
+     */
+    bool solution_delta = false;
+
+    /** Sets added to 'solution' since the previous callback. */
+    std::vector<SetId> added_sets;
+
+    /** Sets removed from 'solution' since the previous callback. */
+    std::vector<SetId> removed_sets;
+
 
     std::string solution_value() const
     {
@@ -120,8 +137,16 @@ struct Parameters: optimizationtools::Parameters
                 {"VertexCoverDomination", reduction_parameters.vertex_cover_domination},
                 {"UnconfinedSets", reduction_parameters.unconfined_sets},
                 {"LinearProgramming", reduction_parameters.linear_programming},
+                {"LinearProgrammingMaximumNumberOfIterations", reduction_parameters.linear_programming_maximum_number_of_iterations},
+                {"Crown", reduction_parameters.crown},
+                {"CrownTimeLimit", reduction_parameters.crown_time_limit},
                 {"DominatedSetsRemoval", reduction_parameters.dominated_sets_removal},
-                {"DominatedElementsRemoval", reduction_parameters.dominated_elements_removal}});
+                {"DominatedElementsRemoval", reduction_parameters.dominated_elements_removal},
+                {"SmallComponentsMaximumNumberOfSets", reduction_parameters.small_components_maximum_number_of_sets},
+                {"AdaptiveRuleScheduling", reduction_parameters.adaptive_rule_scheduling},
+                {"MinimumRuleYield", reduction_parameters.minimum_rule_yield},
+                {"MinimumRuleTime", reduction_parameters.minimum_rule_time},
+                {"NumberOfThreads", reduction_parameters.number_of_threads}});
         return json;
     }
 
@@ -141,8 +166,16 @@ struct Parameters: optimizationtools::Parameters
             << std::setw(width) << std::left << "    Unconfined sets: " << reduction_parameters.unconfined_sets << std::endl
             << std::setw(width) << std::left << "    Vertex cover domination: " << reduction_parameters.vertex_cover_domination << std::endl
             << std::setw(width) << std::left << "    Linear programming: " << reduction_parameters.linear_programming << std::endl
+            << std::setw(width) << std::left << "    LP max. # of iterations: " << reduction_parameters.linear_programming_maximum_number_of_iterations << std::endl
+            << std::setw(width) << std::left << "    Crown: " << reduction_parameters.crown << std::endl
+            << std::setw(width) << std::left << "    Crown time limit: " << reduction_parameters.crown_time_limit << std::endl
             << std::setw(width) << std::left << "    Dominated sets removal: " << reduction_parameters.dominated_sets_removal << std::endl
             << std::setw(width) << std::left << "    Dominated elts removal: " << reduction_parameters.dominated_elements_removal << std::endl
+            << std::setw(width) << std::left << "    Small comp. max. # sets: " << reduction_parameters.small_components_maximum_number_of_sets << std::endl
+            << std::setw(width) << std::left << "    Adaptive rule scheduling: " << reduction_parameters.adaptive_rule_scheduling << std::endl
+            << std::setw(width) << std::left << "    Min. rule yield: " << reduction_parameters.minimum_rule_yield << std::endl
+            << std::setw(width) << std::left << "    Min. rule time: " << reduction_parameters.minimum_rule_time << std::endl
+            << std::setw(width) << std::left << "    # of threads: " << reduction_parameters.number_of_threads << std::endl
             ;
     }
 };
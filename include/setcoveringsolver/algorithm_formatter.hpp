@@ -22,8 +22,13 @@ public:
     void start(
             const std::string& algorithm_name);
 
-    void print_reduced_instance(
-            const Instance& reduced_instance);
+    /**
+     * Print the statistics of the reduction and the reduced instance.
+     *
+     * The statistics are also added to the json output.
+     */
+    void print_reduction(
+            const Reduction& reduction);
 
     /** Print the header. */
     void print_header();
@@ -32,11 +37,28 @@ public:
     void print(
             const std::string& s);
 
-    /** Update the solution. */
-    void update_solution(
+    /**
+     * Update the solution.
+     *
+     * Return true if the solution is better than the current one.
+     */
+    bool update_solution(
             const Solution& solution,
             const std::string& s);
 
+    /**
+     * Update the solution, given the sets added to and removed from the
+     * current solution 'output.solution'.
+     *
+     * They are passed on to the new solution callback, which can then update
+     * its own copy of the solution in time proportional to their number.
+     */
+    bool update_solution(
+            const Solution& solution,
+            const std::vector<SetId>& added_sets,
+            const std::vector<SetId>& removed_sets,
+            const std::string& s);
+
     /** Update the bound. */
     void update_bound(
             Cost bound,
@@ -67,51 +89,106 @@ inline const AlgorithmOutput solve_reduced_instance(
         AlgorithmOutput& output)
 {
     Reduction reduction(instance, parameters.reduction_parameters);
-    algorithm_formatter.print_reduced_instance(reduction.instance());
+    algorithm_formatter.print_reduction(reduction);
     algorithm_formatter.print_header();
 
-    algorithm_formatter.update_solution(
-            reduction.unreduce_solution(Solution(reduction.instance())),
-            "");
+    Solution unreduced_solution = reduction.unreduce_solution(Solution(reduction.instance()));
+    algorithm_formatter.update_solution(unreduced_solution, "");
     algorithm_formatter.update_bound(
             reduction.unreduce_bound(0),
             "");
 
+    // The sets of the solution of the reduced instance passed to the last
+    // callback. It is used to only unreduce the sets which have changed since.
+    optimizationtools::IndexedSet reduced_solution_sets(reduction.instance().number_of_sets());
+    bool reduced_solution_sets_up_to_date = false;
+    std::vector<SetId> added_sets;
+    std::vector<SetId> removed_sets;
+    auto unreduce_solution = [
+        &reduction,
+        &unreduced_solution,
+        &reduced_solution_sets,
+        &reduced_solution_sets_up_to_date,
+        &added_sets,
+        &removed_sets](
+                const Output& new_output)
+        {
+            const Solution& solution = new_output.solution;
+            if (new_output.solution_delta && reduced_solution_sets_up_to_date) {
+                // The algorithm gives the modified sets, in time proportional
+                // to their number.
+                for (SetId set_id: new_output.added_sets)
+                    reduced_solution_sets.add(set_id);
+                for (SetId set_id: new_output.removed_sets)
+                    reduced_solution_sets.remove(set_id);
+                reduction.unreduce_solution(
+                        unreduced_solution,
+                        new_output.added_sets,
+                        new_output.removed_sets);
+                return;
+            }
+            // Otherwise, compare the whole solutions, in time proportional to
+            // their number of sets.
+            added_sets.clear();
+            removed_sets.clear();
+            for (SetId set_id: solution.sets())
+                if (!reduced_solution_sets.contains(set_id))
+                    added_sets.push_back(set_id);
+            for (SetId set_id: reduced_solution_sets)
+                if (!solution.contains(set_id))
+                    removed_sets.push_back(set_id);
+            for (SetId set_id: added_sets)
+                reduced_solution_sets.add(set_id);
+            for (SetId set_id: removed_sets)
+                reduced_solution_sets.remove(set_id);
+            reduced_solution_sets_up_to_date = true;
+            reduction.unreduce_solution(unreduced_solution, added_sets, removed_sets);
+        };
+
     AlgorithmParameters new_parameters = parameters;
     new_parameters.reduction_parameters.reduce = false;
     new_parameters.verbosity_level = 0;
+    // Swapped with 'output.solution' and 'output.json' to keep them while
+    // 'output' is overwritten, without copying them. The JSON of the inner
+    // algorithm describes the reduced instance, so the outer one is kept.
     Solution solution_tmp(instance);
-    Solution unreduced_solution(instance);
+    nlohmann::json json_tmp;
     new_parameters.new_solution_callback = [
         &algorithm_formatter,
         &reduction,
         &output,
         &solution_tmp,
+        &json_tmp,
+        &unreduce_solution,
         &unreduced_solution](
                 const Output& new_output,
                 const std::string& s)
         {
-            solution_tmp = output.solution;
+            std::swap(solution_tmp, output.solution);
+            std::swap(json_tmp, output.json);
             Cost bound = output.bound;
             output = static_cast<const AlgorithmOutput&>(new_output);
-            output.solution = solution_tmp;
+            std::swap(solution_tmp, output.solution);
+            std::swap(json_tmp, output.json);
             output.bound = bound;
 
-            reduction.unreduce_solution(unreduced_solution, new_output.solution);
+            unreduce_solution(new_output);
             Cost unreduced_bound = reduction.unreduce_bound(new_output.bound);
             algorithm_formatter.update_solution(unreduced_solution, s);
             algorithm_formatter.update_bound(unreduced_bound, s);
         };
     auto new_output = algorithm(reduction.instance(), new_parameters);
 
-    solution_tmp = output.solution;
+    std::swap(solution_tmp, output.solution);
+    std::swap(json_tmp, output.json);
     Cost bound = output.bound;
     output = static_cast<const AlgorithmOutput&>(new_output);
-    output.solution = solution_tmp;
+    std::swap(solution_tmp, output.solution);
+    std::swap(json_tmp, output.json);
     output.bound = bound;
 
     std::string s = "";
-    reduction.unreduce_solution(unreduced_solution, new_output.solution);
+    unreduce_solution(new_output);
     Cost unreduced_bound = reduction.unreduce_bound(new_output.bound);
     algorithm_formatter.update_solution(unreduced_solution, s);
     algorithm_formatter.update_bound(unreduced_bound, s);
@@ -13,6 +13,23 @@ struct LargeNeighborhoodSearchParameters: Parameters
     /** Maximum number of iterations without improvement. */
     Counter maximum_number_of_iterations_without_improvement = -1;
 
+    /**
+     * Initial solution.
+     *
+     * If not set, the initial solution is computed with a greedy algorithm.
+     * The reduction must then be disabled.
+     */
+    const Solution* initial_solution = nullptr;
+
+    /**
+     * Initial penalties of the elements, for example the final penalties of
+     * a previous run.
+     *
+     * Non-positive penalties are replaced by 1. The reduction must then be
+     * disabled.
+     */
+    const std::vector<Penalty>* initial_penalties = nullptr;
+
 
     virtual nlohmann::json to_json() const override
     {
@@ -46,6 +63,14 @@ struct LargeNeighborhoodSearchOutput: Output
     /** Number of iterations. */
     Counter number_of_iterations = 0;
 
+    /**
+     * Penalties of the elements at the end of the search.
+     *
+     * Empty if the instance has been reduced, since the penalties are then
+     * the ones of the elements of the reduced instance.
+     */
+    std::vector<Penalty> penalties;
+
 
     virtual nlohmann::json to_json() const override
     {
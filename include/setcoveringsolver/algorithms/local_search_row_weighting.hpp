@@ -16,6 +16,15 @@ struct LocalSearchRowWeightingParameters: Parameters
     /** Best solution update frequency. */
     Counter best_solution_update_frequency = 1;
 
+    /**
+     * Initial penalties of the elements, for example the final penalties of
+     * a previous run.
+     *
+     * Non-positive penalties are replaced by the default initial penalty.
+     * The reduction must then be disabled.
+     */
+    const std::vector<Penalty>* initial_penalties = nullptr;
+
     virtual int format_width() const override { return 37; }
 
     virtual void format(std::ostream& os) const override
@@ -49,6 +58,14 @@ struct LocalSearchRowWeightingOutput: Output
     /** Number of iterations. */
     Counter number_of_iterations = 0;
 
+    /**
+     * Penalties of the elements at the end of the search.
+     *
+     * Empty if the instance has been reduced, since the penalties are then
+     * the ones of the elements of the reduced instance.
+     */
+    std::vector<Penalty> penalties;
+
 
     virtual int format_width() const override { return 31; }
 
@@ -71,6 +88,11 @@ struct LocalSearchRowWeightingOutput: Output
     }
 };
 
+/**
+ * Row weighting local search.
+ *
+ * If 'initial_solution' is set, the reduction must be disabled.
+ */
 const LocalSearchRowWeightingOutput local_search_row_weighting(
         const Instance& instance,
         std::mt19937_64& generator,
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "nlohmann/json.hpp"
+
 #include <cstdint>
+#include <cstddef>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -8,23 +11,86 @@
 namespace setcoveringsolver
 {
 
-using ElementId = int64_t;
-using ElementPos = int64_t;
-using SetId = int64_t;
-using SetPos = int64_t;
-using ComponentId = int64_t;
+/**
+ * Integer type used for the indices of the elements and of the sets.
+ *
+ * Building with 'SETCOVERINGSOLVER_32BIT_INDICES' halves the size of the
+ * adjacency arrays. In this case, the instance builder checks that the
+ * number of sets, of elements and of arcs fits.
+ */
+#if SETCOVERINGSOLVER_32BIT_INDICES
+using Index = int32_t;
+#else
+using Index = int64_t;
+#endif
+
+using ElementId = Index;
+using ElementPos = Index;
+using SetId = Index;
+using SetPos = Index;
+using ComponentId = Index;
 using Cost = int64_t;
 using Penalty = int64_t;
 using Counter = int64_t;
 using Seed = int64_t;
 
+/**
+ * View on a contiguous range of indices stored in an instance.
+ */
+template <typename Index>
+class IndexRange
+{
+
+public:
+
+    /** Constructor. */
+    IndexRange() { }
+
+    /** Constructor. */
+    IndexRange(
+            const Index* first,
+            const Index* last):
+        first_(first),
+        last_(last) { }
+
+    /** Get an iterator to the first index. */
+    inline const Index* begin() const { return first_; }
+
+    /** Get an iterator past the last index. */
+    inline const Index* end() const { return last_; }
+
+    /** Get the number of indices. */
+    inline std::size_t size() const { return last_ - first_; }
+
+    /** Return 'true' iff the range is empty. */
+    inline bool empty() const { return first_ == last_; }
+
+    /** Get the index at a given position. */
+    inline const Index& operator[](std::size_t pos) const { return first_[pos]; }
+
+    /** Get the first index. */
+    inline const Index& front() const { return *first_; }
+
+    /** Get the last index. */
+    inline const Index& back() const { return *(last_ - 1); }
+
+private:
+
+    /** Pointer to the first index. */
+    const Index* first_ = nullptr;
+
+    /** Pointer past the last index. */
+    const Index* last_ = nullptr;
+
+};
+
 /**
  * Structure for an element.
  */
 struct Element
 {
     /** Sets that cover the element. */
-    std::vector<SetId> sets;
+    IndexRange<SetId> sets;
 
     /**
      * Index of the connected component in which the element belongs.
@@ -42,7 +108,7 @@ struct Set
     Cost cost = 1;
 
     /** Elements covered by the set. */
-    std::vector<ElementId> elements;
+    IndexRange<ElementId> elements;
 
     /**
      * Index of the connected component in which the set belongs.
@@ -57,10 +123,78 @@ struct Set
 struct Component
 {
     /** Elements. */
-    std::vector<ElementId> elements;
+    IndexRange<ElementId> elements;
 
     /** Sets. */
-    std::vector<SetId> sets;
+    IndexRange<SetId> sets;
+};
+
+/**
+ * Scratch space for the neighbor queries answered on the fly.
+ *
+ * Each thread querying neighbors needs its own buffer.
+ */
+class NeighborsBuffer
+{
+
+public:
+
+    /** Constructor. */
+    NeighborsBuffer() { }
+
+    /** Start a new query on indices in [0, number_of_indices). */
+    inline void clear(Index number_of_indices)
+    {
+        if ((Index)marks_.size() < number_of_indices)
+            marks_.resize(number_of_indices, 0);
+        timestamp_++;
+        values_.clear();
+    }
+
+    /** Add an index to the current query if it is not already in it. */
+    inline void add(Index index)
+    {
+        if (marks_[index] == timestamp_)
+            return;
+        marks_[index] = timestamp_;
+        values_.push_back(index);
+    }
+
+    /** Get the indices of the current query. */
+    inline IndexRange<Index> values() const
+    {
+        return IndexRange<Index>(values_.data(), values_.data() + values_.size());
+    }
+
+private:
+
+    /** Indices of the current query. */
+    std::vector<Index> values_;
+
+    /** Timestamp of the last query in which each index has been added. */
+    std::vector<Counter> marks_;
+
+    /** Timestamp of the current query. */
+    Counter timestamp_ = 0;
+
+};
+
+/**
+ * 128-bit fingerprint of an instance.
+ */
+struct InstanceFingerprint
+{
+    /** First 64 bits. */
+    uint64_t high = 0;
+
+    /** Last 64 bits. */
+    uint64_t low = 0;
+
+    bool operator==(const InstanceFingerprint& fingerprint) const { return high == fingerprint.high && low == fingerprint.low; }
+    bool operator!=(const InstanceFingerprint& fingerprint) const { return !(*this == fingerprint); }
+
+    /** Get the fingerprint as a string of 32 hexadecimal digits. */
+    std::string to_string() const;
 };
 
 /**
@@ -76,40 +210,113 @@ public:
      */
 
     /** Get the number of elements. */
-    inline ElementId number_of_elements() const { return elements_.size(); }
+    inline ElementId number_of_elements() const { return element_components_.size(); }
 
     /** Get the number of sets. */
-    inline SetId number_of_sets() const { return sets_.size(); }
+    inline SetId number_of_sets() const { return set_costs_.size(); }
 
     /** Get the number of arcs. */
     inline ElementPos number_of_arcs() const { return number_of_arcs_; }
 
     /** Get the number of conntected components. */
-    inline ComponentId number_of_components() const { return components_.size(); }
+    inline ComponentId number_of_components() const { return number_of_components_; }
 
     /** Get the total cost of the sets. */
     inline Cost total_cost() const { return total_cost_; }
 
     /** Get an element. */
-    inline const Element& element(ElementId element_id) const { return elements_[element_id]; }
+    inline Element element(ElementId element_id) const
+    {
+        return {
+            IndexRange<SetId>(
+                    element_sets_.data() + element_sets_offsets_[element_id],
+                    element_sets_.data() + element_sets_offsets_[element_id + 1]),
+            element_components_[element_id]};
+    }
 
     /** Get a set. */
-    inline const Set& set(SetId set_id) const { return sets_[set_id]; }
+    inline Set set(SetId set_id) const
+    {
+        return {
+            set_costs_[set_id],
+            IndexRange<ElementId>(
+                    set_elements_.data() + set_elements_offsets_[set_id],
+                    set_elements_.data() + set_elements_offsets_[set_id + 1]),
+            set_components_[set_id]};
+    }
 
     /** Get a component. */
-    inline const Component& component(ComponentId component_id) const { return components_[component_id]; }
+    inline Component component(ComponentId component_id) const
+    {
+        return {
+            IndexRange<ElementId>(
+                    component_elements_.data() + component_elements_offsets_[component_id],
+                    component_elements_.data() + component_elements_offsets_[component_id + 1]),
+            IndexRange<SetId>(
+                    component_sets_.data() + component_sets_offsets_[component_id],
+                    component_sets_.data() + component_sets_offsets_[component_id + 1])};
+    }
 
     /** Get the number of elements in a component. */
-    inline ElementId number_of_elements(ComponentId component_id) const { return components_[component_id].elements.size(); }
+    inline ElementId number_of_elements(ComponentId component_id) const
+    {
+        return component_elements_offsets_[component_id + 1]
+            - component_elements_offsets_[component_id];
+    }
+
+    /*
+     * Renumbering
+     *
+     * The sets and the elements may have been renumbered when building the
+     * instance. The original ids are the ids of the input file.
+     */
+
+    /** Return 'true' iff the sets and the elements have been renumbered. */
+    inline bool renumbered() const { return !original_set_ids_.empty(); }
+
+    /** Get the original id of a set. */
+    inline SetId original_set_id(SetId set_id) const { return renumbered()? original_set_ids_[set_id]: set_id; }
+
+    /** Get the original id of an element. */
+    inline ElementId original_element_id(ElementId element_id) const { return renumbered()? original_element_ids_[element_id]: element_id; }
+
+    /** Get the id of a set from its original id. */
+    inline SetId set_id(SetId original_set_id) const { return renumbered()? renumbered_set_ids_[original_set_id]: original_set_id; }
+
+    /*
+     * Neighbors
+     *
+     * The neighbors are computed in parallel at the first query and stored in
+     * CSR arrays if they fit in the neighbors memory limit. Otherwise, each
+     * query computes them on the fly in the buffer, and the returned range is
+     * only valid until the next query with the same buffer.
+     *
+     * The first query must not be run concurrently with other queries.
+     */
+
+    /** Get the sets sharing an element with a set. */
+    IndexRange<SetId> set_neighbors(
+            SetId set_id,
+            NeighborsBuffer& buffer) const;
+
+    /** Get the elements sharing a set with an element. */
+    IndexRange<ElementId> element_neighbors(
+            ElementId element_id,
+            NeighborsBuffer& buffer) const;
 
-    /** Get set neighbors. */
-    const std::vector<std::vector<SetId>>& set_neighbors() const;
+    /** Get the sets covering an element or sharing an element with one of them. */
+    IndexRange<SetId> element_set_neighbors(
+            ElementId element_id,
+            NeighborsBuffer& buffer) const;
 
-    /** Get element neighbors. */
-    const std::vector<std::vector<ElementId>>& element_neighbors() const;
+    /** Return 'true' iff the set neighbors are stored in CSR arrays. */
+    bool set_neighbors_cached() const;
 
-    /** Get element set neighbors. */
-    const std::vector<std::vector<ElementId>>& element_set_neighbors() const;
+    /** Return 'true' iff the element neighbors are stored in CSR arrays. */
+    bool element_neighbors_cached() const;
+
+    /** Return 'true' iff the element set neighbors are stored in CSR arrays. */
+    bool element_set_neighbors_cached() const;
 
     /** Compute an estimate of the average number of neighbors of a set. */
     double compute_average_number_of_set_neighbors_estimate() const;
@@ -117,10 +324,30 @@ public:
     /** Compute an estimate of the average number of neighbors of an element. */
     double compute_average_number_of_element_neighbors_estimate() const;
 
+    /*
+     * Fingerprint
+     */
+
+    /**
+     * Get a fingerprint of the instance.
+     *
+     * It depends on the numbers of sets and of elements, on the costs of the
+     * sets and on the elements of each set. It doesn't depend on the order of
+     * the elements of a set, on the number of threads or on the index type.
+     * The original ids of a renumbered instance are not taken into account.
+     *
+     * The fingerprint is computed in parallel at the first call, which must not
+     * be run concurrently with other calls.
+     */
+    const InstanceFingerprint& fingerprint() const;
+
     /*
      * Export
      */
 
+    /** Export instance characteristics to a JSON structure. */
+    nlohmann::json to_json() const;
+
     /** Write the instance to a file. */
     void write(
             const std::string& instance_path,
@@ -161,11 +388,40 @@ private:
      * Attributes.
      */
 
-    /** Elements. */
-    std::vector<Element> elements_;
+    /** Costs of the sets. */
+    std::vector<Cost> set_costs_;
 
-    /** Sets. */
-    std::vector<Set> sets_;
+    /** Components of the sets. */
+    std::vector<ComponentId> set_components_;
+
+    /**
+     * Position in 'set_elements_' of the first element of each set.
+     *
+     * The elements of set 'set_id' are stored between positions
+     * 'set_elements_offsets_[set_id]' and 'set_elements_offsets_[set_id + 1]'.
+     */
+    std::vector<ElementPos> set_elements_offsets_;
+
+    /** Elements covered by the sets, stored contiguously. */
+    std::vector<ElementId> set_elements_;
+
+    /** Components of the elements. */
+    std::vector<ComponentId> element_components_;
+
+    /** Position in 'element_sets_' of the first set of each element. */
+    std::vector<SetPos> element_sets_offsets_;
+
+    /** Sets covering the elements, stored contiguously. */
+    std::vector<SetId> element_sets_;
+
+    /** Original ids of the sets, empty if they have not been renumbered. */
+    std::vector<SetId> original_set_ids_;
+
+    /** Ids of the sets from their original ids. */
+    std::vector<SetId> renumbered_set_ids_;
+
+    /** Original ids of the elements, empty if they have not been renumbered. */
+    std::vector<ElementId> original_element_ids_;
 
     /** Total cost of the sets. */
     Cost total_cost_ = 0;
@@ -173,17 +429,64 @@ private:
     /** Number of arcs. */
     ElementPos number_of_arcs_ = 0;
 
-    /** Components. */
-    std::vector<Component> components_;
+    /** Number of components. */
+    ComponentId number_of_components_ = 0;
+
+    /** Position in 'component_elements_' of the first element of each component. */
+    std::vector<ElementPos> component_elements_offsets_;
+
+    /** Elements of the components, stored contiguously. */
+    std::vector<ElementId> component_elements_;
+
+    /** Position in 'component_sets_' of the first set of each component. */
+    std::vector<SetPos> component_sets_offsets_;
+
+    /** Sets of the components, stored contiguously. */
+    std::vector<SetId> component_sets_;
+
+    /**
+     * Structure for the neighbors of the sets or of the elements.
+     */
+    struct NeighborsTable
+    {
+        /** 'true' iff the table has been computed. */
+        bool computed = false;
+
+        /** 'true' iff the neighbors are stored in the arrays below. */
+        bool cached = false;
+
+        /**
+         * Position in 'neighbors' of the first neighbor of each index.
+         *
+         * The total number of neighbors may exceed the range of the indices,
+         * so the positions are stored on 64 bits.
+         */
+        std::vector<Counter> offsets;
+
+        /** Neighbors, stored contiguously. */
+        std::vector<Index> neighbors;
+    };
+
+    /** Maximum memory used to store each neighbors table, in bytes. */
+    size_t neighbors_memory_limit_ = (size_t)1 << 32;
+
+    /** Number of threads used to compute the neighbors and the fingerprint. */
+    Counter number_of_threads_ = 1;
 
     /** Set neighbors. */
-    mutable std::vector<std::vector<SetId>> set_neighbors_;
+    mutable NeighborsTable set_neighbors_;
 
     /** Element neighbors. */
-    mutable std::vector<std::vector<ElementId>> element_neighbors_;
+    mutable NeighborsTable element_neighbors_;
 
     /** Element set neighbors. */
-    mutable std::vector<std::vector<ElementId>> element_set_neighbors_;
+    mutable NeighborsTable element_set_neighbors_;
+
+    /** 'true' iff the fingerprint has been computed. */
+    mutable bool fingerprint_computed_ = false;
+
+    /** Fingerprint. */
+    mutable InstanceFingerprint fingerprint_;
 
     /*
      * Private methods.
@@ -192,19 +495,46 @@ private:
     /** Create an instance manually. */
     Instance() { }
 
-    /** Compute the neighbors of the sets. */
-    void compute_set_neighbors(
-            Counter number_of_threads) const;
+    /**
+     * Fill the element and set lists of the components from the components
+     * of the elements and of the sets.
+     */
+    void compute_component_lists();
 
-    void compute_set_neighbors_worker(
-            SetId set_id_start,
-            SetId set_id_end) const;
+    /** Add the neighbors of a set to a buffer. */
+    void add_set_neighbors(
+            SetId set_id,
+            NeighborsBuffer& buffer) const;
 
-    /** Compute the neighbors of the elements. */
-    void compute_element_neighbors() const;
+    /** Add the neighbors of an element to a buffer. */
+    void add_element_neighbors(
+            ElementId element_id,
+            NeighborsBuffer& buffer) const;
 
-    /** Compute the set neighbors of the elements. */
-    void compute_element_set_neighbors() const;
+    /** Add the set neighbors of an element to a buffer. */
+    void add_element_set_neighbors(
+            ElementId element_id,
+            NeighborsBuffer& buffer) const;
+
+    /**
+     * Compute a neighbors table.
+     *
+     * 'add_neighbors' is one of the 'add_*_neighbors' methods.
+     */
+    void compute_neighbors_table(
+            NeighborsTable& table,
+            Index number_of_indices,
+            Index number_of_neighbor_indices,
+            void (Instance::*add_neighbors)(Index, NeighborsBuffer&) const) const;
+
+    /** Query a neighbors table. */
+    IndexRange<Index> neighbors(
+            NeighborsTable& table,
+            Index index,
+            Index number_of_indices,
+            Index number_of_neighbor_indices,
+            void (Instance::*add_neighbors)(Index, NeighborsBuffer&) const,
+            NeighborsBuffer& buffer) const;
 
     /*
      * Write to a file
@@ -219,7 +549,26 @@ private:
     /** Write an instance in 'dimacs2010_vc' format. */
     void write_dimacs2010_vc(std::ofstream& file) const;
 
+    /**
+     * Write an instance in 'binary' format.
+     *
+     * The file starts with a header of 9 64-bit words: the magic number, the
+     * version, the size of the indices, the numbers of sets, elements, arcs,
+     * components and sets belonging to a component, and whether the instance
+     * has been renumbered. The arrays of the instance follow, each padded to
+     * a multiple of 8 bytes.
+     */
+    void write_binary(std::ostream& file) const;
+
+    /** Magic number at the start of the files in 'binary' format. */
+    static constexpr uint64_t binary_magic_number = 0x314e534e49534353;
+
+    /** Version of the 'binary' format. */
+    static constexpr uint64_t binary_version = 2;
+
     friend class InstanceBuilder;
+    friend class InstanceUpdate;
+    friend class Reduction;
 
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "setcoveringsolver/instance.hpp"
+#include "setcoveringsolver/tokenizer.hpp"
 
 namespace setcoveringsolver
 {
@@ -37,13 +38,72 @@ public:
         //instance_.check_set_index(set_id);
         //instance_.check_element_index(element_id);
 
-        instance_.elements_[element_id].sets.push_back(set_id);
-        instance_.sets_[set_id].elements.push_back(element_id);
+        arcs_set_ids_.push_back(set_id);
+        arcs_element_ids_.push_back(element_id);
     }
 
+    /** Reserve memory for arcs added with 'add_arc'. */
+    void reserve_arcs(ElementPos number_of_arcs);
+
+    /**
+     * Add arcs given as two arrays of the same size (coordinate format).
+     *
+     * The arrays are moved into the builder when no arc has been added yet.
+     */
+    void add_arcs(
+            std::vector<SetId>&& set_ids,
+            std::vector<ElementId>&& element_ids);
+
+    /**
+     * Set the number of elements of each set.
+     *
+     * The elements of each set must then be written through 'set_elements'.
+     * The adjacency arrays are allocated once, and the sets of the elements
+     * are computed when building the instance. This can't be combined with
+     * 'add_arc' and 'add_arcs': 'set_numbers_of_elements' and 'build' throw a
+     * 'std::logic_error' if arcs have been added with them.
+     */
+    void set_numbers_of_elements(const std::vector<ElementPos>& numbers_of_elements);
+
+    /**
+     * Get a pointer to the elements of a set.
+     *
+     * The number of elements of the set must have been set with
+     * 'set_numbers_of_elements'.
+     */
+    inline ElementId* set_elements(SetId set_id)
+    {
+        return instance_.set_elements_.data() + instance_.set_elements_offsets_[set_id];
+    }
+
+    /** Remove the repeated arcs when building the instance. */
+    void set_remove_duplicate_arcs(bool remove_duplicate_arcs) { remove_duplicate_arcs_ = remove_duplicate_arcs; }
+
     /** Set the cost of all sets to 1. */
     void set_unicost();
 
+    /**
+     * Set the number of threads used to read instance files, to compute the
+     * connected components, the neighbors and the fingerprint.
+     */
+    void set_number_of_threads(Counter number_of_threads) { number_of_threads_ = number_of_threads; }
+
+    /**
+     * Set the maximum memory used to store each neighbors table of the
+     * instance, in bytes.
+     */
+    void set_neighbors_memory_limit(size_t neighbors_memory_limit) { instance_.neighbors_memory_limit_ = neighbors_memory_limit; }
+
+    /**
+     * Set how the sets and the elements are renumbered to improve memory
+     * locality.
+     *
+     * - "": keep the ids of the input
+     * - "bfs": breadth-first search order (Cuthill-McKee) in each component
+     * - "degree": decreasing degree order in each component
+     */
+    void set_renumbering(const std::string& renumbering);
+
     /** Read an instance from a file. */
     void read(
             const std::string& instance_path,
@@ -74,6 +134,15 @@ private:
      * Private methods
      */
 
+    /** Compute the adjacency arrays of the instance from the added arcs. */
+    void compute_adjacency();
+
+    /** Compute the sets of the elements from the elements of the sets. */
+    void compute_element_sets();
+
+    /** Remove the repeated arcs from the adjacency arrays. */
+    void remove_duplicate_arcs();
+
     /** Compute the number of arcs. */
     void compute_number_of_arcs();
 
@@ -83,24 +152,83 @@ private:
     /** Compute the connected components of the instance. */
     void compute_components();
 
+    /** Renumber the sets and the elements. */
+    void renumber();
+
+    /** Compute the component ids with a depth-first search. */
+    void compute_components_dfs();
+
+    /** Compute the component ids with a parallel union-find. */
+    void compute_components_union_find();
+
     /*
      * Read input file
      */
 
+    /** Read an instance in a text format with a tokenizer. */
+    void read(
+            Tokenizer& tokenizer,
+            const std::string& format);
+
+    /**
+     * Read the next integer of an instance file.
+     *
+     * Throw if the file is truncated.
+     */
+    template <typename T>
+    void read_int(
+            Tokenizer& tokenizer,
+            T& x,
+            const std::string& format);
+
     /** Read an instance file in 'fulkerson1974' format. */
-    void read_fulkerson1974(std::ifstream& file);
+    void read_fulkerson1974(Tokenizer& tokenizer);
 
     /** Read an instance file in 'balas1980' format. */
-    void read_balas1980(std::ifstream& file);
+    void read_balas1980(Tokenizer& tokenizer);
 
     /** Read an instance file in 'balas1996' format. */
-    void read_balas1996(std::ifstream& file);
+    void read_balas1996(Tokenizer& tokenizer);
 
     /** Read an instance file in 'faster1994' format. */
-    void read_faster1994(std::ifstream& file);
+    void read_faster1994(Tokenizer& tokenizer);
 
     /** Read an instance file in 'geccod2020' format. */
-    void read_geccod2020(std::ifstream& file);
+    void read_geccod2020(Tokenizer& tokenizer);
+
+    /** Read an instance file in 'pace2019' format. */
+    void read_pace2019_vc(Tokenizer& tokenizer);
+
+    /** Read an instance file in 'pace2025' format. */
+    void read_pace2025(Tokenizer& tokenizer);
+
+    /** Read an instance file in 'pace2025_ds' format. */
+    void read_pace2025_ds(Tokenizer& tokenizer);
+
+    /** Read an instance file in 'dimacs2010_vc' format. */
+    void read_dimacs2010_vc(Tokenizer& tokenizer);
+
+    /**
+     * Read an instance in 'binary' format from a range of characters.
+     *
+     * The range is usually a memory-mapped file. Its arrays are validated and
+     * copied directly into the instance. The adjacency arrays and the
+     * components don't need to be computed again when building the instance.
+     */
+    void read_binary(
+            const char* data,
+            size_t size);
+
+    /**
+     * Read an instance file in 'pace2025', 'pace2025_ds' or 'dimacs2010_vc'
+     * format.
+     *
+     * The file is memory-mapped and split into line-aligned chunks which are
+     * parsed in parallel.
+     */
+    void read_chunks(
+            const MappedFile& file,
+            const std::string& format);
 
     /*
      * Private attributes
@@ -109,6 +237,29 @@ private:
     /** Instance. */
     Instance instance_;
 
+    /** Sets of the arcs added so far. */
+    std::vector<SetId> arcs_set_ids_;
+
+    /** Elements of the arcs added so far. */
+    std::vector<ElementId> arcs_element_ids_;
+
+    /** Renumbering. */
+    std::string renumbering_;
+
+    /** Path of the instance file being read, for the error messages. */
+    std::string instance_path_;
+
+    /** Remove the repeated arcs when building the instance. */
+    bool remove_duplicate_arcs_ = false;
+
+    /**
+     * Number of threads used to read instance files, to compute the connected
+     * components, the neighbors and the fingerprint.
+     */
+    Counter number_of_threads_ = 1;
+
+    friend class Reduction;
+
 };
 
 }
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "setcoveringsolver/solution.hpp"
+
+namespace setcoveringsolver
+{
+
+/**
+ * Class to apply a small modification to an instance.
+ *
+ * The modifications are recorded and then applied at once with 'apply',
+ * which returns the updated instance. The sets and the elements are
+ * designated by their ids in the instance. Added sets and added elements get
+ * the ids following the ones of the instance, in the order of their addition.
+ *
+ * In the updated instance, the removed sets and elements are dropped and the
+ * remaining ones keep their relative order, followed by the added ones. The
+ * number of arcs, the total cost and the connected components are updated
+ * incrementally: only the components containing a removed set or a removed
+ * element are explored again.
+ */
+class InstanceUpdate
+{
+
+public:
+
+    /** Constructor. */
+    InstanceUpdate(const Instance& instance);
+
+    /** Add a set and return its id. */
+    SetId add_set(Cost cost = 1);
+
+    /** Add an element and return its id. */
+    ElementId add_element();
+
+    /**
+     * Add an arc between a set and an element.
+     *
+     * Arcs which already exist are ignored.
+     */
+    void add_arc(
+            SetId set_id,
+            ElementId element_id);
+
+    /** Remove a set. */
+    void remove_set(SetId set_id);
+
+    /** Remove an element. */
+    void remove_element(ElementId element_id);
+
+    /** Set the cost of a set. */
+    void set_cost(
+            SetId set_id,
+            Cost cost);
+
+    /** Build the updated instance. */
+    Instance apply();
+
+    /*
+     * Getters, available once the update has been applied
+     */
+
+    /** Get the id of a set in the updated instance, -1 if it has been removed. */
+    inline SetId updated_set_id(SetId set_id) const { return updated_set_ids_[set_id]; }
+
+    /** Get the id of an element in the updated instance, -1 if it has been removed. */
+    inline ElementId updated_element_id(ElementId element_id) const { return updated_element_ids_[element_id]; }
+
+    /**
+     * Convert a solution of the instance into a feasible solution of the
+     * updated instance.
+     *
+     * The sets of the solution which have not been removed are kept. The
+     * uncovered elements are then covered greedily, and the sets which became
+     * redundant are removed. The result is meant to warm start a local
+     * search.
+     */
+    Solution update_solution(
+            const Instance& updated_instance,
+            const Solution& solution) const;
+
+    /**
+     * Convert the element penalties of a local search on the instance into
+     * element penalties for the updated instance.
+     *
+     * The penalties of the added elements are set to 0, so that the local
+     * search uses its default initial penalty for them.
+     */
+    std::vector<Penalty> update_penalties(const std::vector<Penalty>& penalties) const;
+
+private:
+
+    /*
+     * Private methods
+     */
+
+    /** Check if a set index is within the range of the sets and of the added sets. */
+    void check_set_index(SetId set_id) const;
+
+    /** Check if an element index is within the range of the elements and of the added elements. */
+    void check_element_index(ElementId element_id) const;
+
+    /** Compute the connected components of the updated instance. */
+    void compute_components(
+            Instance& updated_instance,
+            const std::vector<std::pair<SetId, ElementId>>& arcs) const;
+
+    /** Compute the original ids of the updated instance. */
+    void compute_original_ids(Instance& updated_instance) const;
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance* instance_;
+
+    /** Costs of the added sets. */
+    std::vector<Cost> added_set_costs_;
+
+    /** Number of added elements. */
+    ElementId number_of_added_elements_ = 0;
+
+    /** Sets of the added arcs. */
+    std::vector<SetId> arcs_set_ids_;
+
+    /** Elements of the added arcs. */
+    std::vector<ElementId> arcs_element_ids_;
+
+    /** Removed sets. */
+    std::vector<SetId> removed_set_ids_;
+
+    /** Removed elements. */
+    std::vector<ElementId> removed_element_ids_;
+
+    /** New costs of the sets of the instance, in the order of the calls. */
+    std::vector<std::pair<SetId, Cost>> set_costs_;
+
+    /** Ids of the sets in the updated instance. */
+    std::vector<SetId> updated_set_ids_;
+
+    /** Ids of the elements in the updated instance. */
+    std::vector<ElementId> updated_element_ids_;
+
+};
+
+}
@@ -4,6 +4,8 @@
 
 #include "optimizationtools/utils/timer.hpp"
 
+#include <map>
+
 namespace setcoveringsolver
 {
 
@@ -34,14 +36,77 @@ struct ReductionParameters
     /** Enable linear programming reduction. */
     bool linear_programming = true;
 
+    /**
+     * Maximum number of iterations of the subgradient algorithm of the linear
+     * programming reduction, used when some elements are not covered by
+     * exactly 2 sets.
+     */
+    Counter linear_programming_maximum_number_of_iterations = 100;
+
     /** Enable unconfined sets reduction. */
     bool unconfined_sets = true;
 
+    /**
+     * Enable crown reduction.
+     *
+     * It is disabled by default since on large instances without crowns,
+     * each call costs up to 'crown_time_limit'.
+     */
+    bool crown = false;
+
+    /** Time limit of each call of the crown reduction. */
+    double crown_time_limit = 1.0;
+
     /** Enable dominated sets removal. */
     bool dominated_sets_removal = true;
 
     /** Enable dominated elements removal. */
     bool dominated_elements_removal = true;
+
+    /**
+     * Maximum number of sets of the components solved exactly at the end of
+     * the reduction.
+     *
+     * Components with more than 64 sets or more than 64 elements are never
+     * solved exactly.
+     */
+    SetId small_components_maximum_number_of_sets = 64;
+
+    /**
+     * Enable the adaptive scheduling of the reduction rules.
+     *
+     * A call of a rule lasting at least 'minimum_rule_time' seconds and
+     * removing fewer than 'minimum_rule_yield' sets and elements per second
+     * demotes the rule: it is skipped until the end of the round and during
+     * the following rounds. The number of skipped rounds starts at 1 and
+     * doubles each time the rule is demoted again; it is reset as soon as a
+     * call of the rule reaches the minimum yield.
+     *
+     * Since the yield is measured in time, the reduced instance may then
+     * depend on the speed of the machine and on the number of threads.
+     */
+    bool adaptive_rule_scheduling = false;
+
+    /** Minimum yield of a rule, in removed sets and elements per second. */
+    double minimum_rule_yield = 1e4;
+
+    /** Minimum duration of a call of a rule for it to be demoted. */
+    double minimum_rule_time = 1e-2;
+
+    /** Number of threads. */
+    Counter number_of_threads = 1;
+
+    /**
+     * Path of a file from which the reduction is loaded instead of being
+     * computed.
+     *
+     * The file must have been written for the same instance; the other
+     * parameters are then ignored.
+     */
+    std::string load_path;
+
+    /** Path of a file to which the reduction is written once computed. */
+    std::string save_path;
 };
 
 class Reduction
@@ -65,10 +130,91 @@ public:
             Solution& new_solution,
             const Solution& solution) const;
 
+    /**
+     * Update an unreduced solution after some sets have been added to and
+     * removed from the solution of the reduced instance.
+     *
+     * 'new_solution' must be the unreduction of the previous solution of the
+     * reduced instance. The time taken is proportional to the number of
+     * modified sets and to the size of their unreduction operations.
+     */
+    void unreduce_solution(
+            Solution& new_solution,
+            const std::vector<SetId>& added_sets,
+            const std::vector<SetId>& removed_sets) const;
+
     /** Unreduce a bound of the reduced instance. */
     Cost unreduce_bound(
             Cost bound) const;
 
+    /** Statistics of a reduction rule during a round. */
+    struct RuleStatistics
+    {
+        /** Name of the rule. */
+        std::string rule;
+
+        /** Round. */
+        Counter round = 0;
+
+        /** Number of calls of the rule during the round. */
+        Counter number_of_calls = 0;
+
+        /**
+         * Time spent in the rule.
+         *
+         * When the components are reduced in parallel, this is the sum of the
+         * times spent in each component.
+         */
+        double time = 0.0;
+
+        /** Number of sets removed. */
+        SetId number_of_removed_sets = 0;
+
+        /** Number of elements removed. */
+        ElementId number_of_removed_elements = 0;
+
+        /**
+         * Number of arcs removed.
+         *
+         * It may be negative for the folding rules, which add arcs.
+         */
+        Counter number_of_removed_arcs = 0;
+
+        /** Number of sets added to the mandatory sets. */
+        SetId number_of_mandatory_sets = 0;
+
+        /** Number of compactions of the reduction instance. */
+        Counter number_of_updates = 0;
+
+        /** Number of calls skipped by the adaptive rule scheduling. */
+        Counter number_of_skipped_calls = 0;
+    };
+
+    /**
+     * Get the statistics of the reduction rules.
+     *
+     * There is one entry per round and per rule called during the round.
+     * They are empty if the reduction has been loaded from a file.
+     */
+    const std::vector<RuleStatistics>& rule_statistics() const { return rule_statistics_; }
+
+    /** Export the statistics of the reduction in a json object. */
+    nlohmann::json to_json() const;
+
+    /** Write a formatted output of the statistics of the reduction to a stream. */
+    void format(
+            std::ostream& os,
+            int verbosity_level) const;
+
+    /**
+     * Write the reduction to a file.
+     *
+     * The file contains the reduced instance and the unreduction operations.
+     * It is keyed by the fingerprint of the original instance, so that it can
+     * only be loaded back for the same instance.
+     */
+    void write(const std::string& reduction_path) const;
+
 private:
 
     /**
@@ -89,55 +235,228 @@ private:
         std::vector<SetId> out;
     };
 
+    /** View on a set of the reduction instance. */
     struct ReductionSet
     {
         bool removed = false;
-        std::vector<ElementId> elements;
+        IndexRange<ElementId> elements;
         Cost cost;
     };
 
+    /** View on an element of the reduction instance. */
     struct ReductionElement
     {
         bool removed = false;
-        std::vector<SetId> sets;
+        IndexRange<SetId> sets;
+    };
+
+    /**
+     * Lists of neighbors stored in a single array.
+     *
+     * Each list occupies a slice of 'arcs' which may be longer than the list.
+     * Neighbors are removed in place. A list which outgrows its slice is
+     * moved to the end of 'arcs', and the abandoned slices are reclaimed by
+     * 'compact'.
+     */
+    struct AdjacencyLists
+    {
+        /** Position of the slice of each list in 'arcs'. */
+        std::vector<Counter> starts;
+
+        /** Size of each list. */
+        std::vector<Index> sizes;
+
+        /** Size of the slice of each list. */
+        std::vector<Index> capacities;
+
+        /** Neighbors. */
+        std::vector<Index> arcs;
+
+        /** Get the number of lists. */
+        Index number_of_lists() const { return this->sizes.size(); }
+
+        /** Get a list. */
+        IndexRange<Index> list(Index list_id) const
+        {
+            const Index* first = this->arcs.data() + this->starts[list_id];
+            return IndexRange<Index>(first, first + this->sizes[list_id]);
+        }
+
+        /** Remove all the neighbors of a list. */
+        void clear(Index list_id) { this->sizes[list_id] = 0; }
+
+        /** Add a neighbor at the end of a list. */
+        void push_back(
+                Index list_id,
+                Index neighbor);
+
+        /**
+         * Remove the neighbors of a list contained in 'neighbors'.
+         *
+         * Return 'true' iff the list has been modified.
+         */
+        bool remove(
+                Index list_id,
+                const optimizationtools::IndexedSet& neighbors);
+
+        /** Move a list to another (unused) list id. */
+        void move(
+                Index list_id,
+                Index new_list_id);
+
+        /** Remove the last list. */
+        void pop_back();
+
+        /**
+         * Move the slices of the lists to the start of 'arcs' so that no
+         * space remains between them.
+         */
+        void compact();
     };
 
+    /**
+     * Instance being reduced.
+     *
+     * Removed sets and elements are only marked as removed until 'update'
+     * discards them.
+     */
     struct ReductionInstance
     {
-        std::vector<ReductionSet> sets;
-        std::vector<ReductionElement> elements;
-
-        SetId number_of_sets() const { return this->sets.size(); }
-        SetId number_of_elements() const { return this->elements.size(); }
-        ReductionSet& set(SetId set_id) { return this->sets[set_id]; }
-        ReductionElement& element(ElementId element_id) { return this->elements[element_id]; }
-        const ReductionSet& set(SetId set_id) const { return this->sets[set_id]; }
-        const ReductionElement& element(ElementId element_id) const { return this->elements[element_id]; }
+        /** Cost of each set. */
+        std::vector<Cost> set_costs;
+
+        /** Removed sets. */
+        std::vector<bool> removed_sets;
+
+        /** Removed elements. */
+        std::vector<bool> removed_elements;
+
+        /** Elements of each set. */
+        AdjacencyLists set_elements;
+
+        /** Sets of each element. */
+        AdjacencyLists element_sets;
+
+        /** Number of sets which have not been removed. */
+        SetId number_of_remaining_sets = 0;
+
+        /** Number of elements which have not been removed. */
+        ElementId number_of_remaining_elements = 0;
+
+        /** Number of arcs between the remaining sets and elements. */
+        Counter number_of_remaining_arcs = 0;
+
+        SetId number_of_sets() const { return this->set_costs.size(); }
+        ElementId number_of_elements() const { return this->removed_elements.size(); }
+
+        ReductionSet set(SetId set_id) const
+        {
+            return {
+                this->removed_sets[set_id],
+                this->set_elements.list(set_id),
+                this->set_costs[set_id]};
+        }
+
+        ReductionElement element(ElementId element_id) const
+        {
+            return {
+                this->removed_elements[element_id],
+                this->element_sets.list(element_id)};
+        }
+    };
+
+    /**
+     * Consumers of the logs of the modified sets and elements.
+     *
+     * After their first call, the corresponding reduction rules only consider
+     * the sets and the elements close to the ones modified since their
+     * previous call, so that their cost is proportional to the modifications
+     * rather than to the size of the instance. The other rules always consider
+     * the whole instance.
+     */
+    enum class WorklistConsumer
+    {
+        MandatorySets,
+        IdenticalElements,
+        IdenticalSets,
+        SetFolding,
+        VertexCoverDomination,
+        DominatedSets2,
+        DominatedElements2,
+        DominatedSets,
+        DominatedElements,
+        Signatures,
+        NumberOfConsumers,
+    };
+
+    /** Position of a consumer in the logs of the modified sets and elements. */
+    struct WorklistPosition
+    {
+        /** 'true' iff the consumer has already considered the whole instance. */
+        bool started = false;
+
+        /** Position in the log of the modified sets. */
+        SetPos sets_position = 0;
+
+        /** Position in the log of the modified elements. */
+        ElementPos elements_position = 0;
+    };
+
+    /** Scheduling state of a reduction rule. */
+    struct RuleSchedule
+    {
+        /** First round during which the rule is called again. */
+        Counter next_round = 0;
+
+        /** Number of rounds skipped after the last demotion of the rule. */
+        Counter number_of_skipped_rounds = 0;
     };
 
     struct Tmp
     {
-        Tmp(const Instance& instance):
-            unreduction_operations(instance.number_of_sets()),
-            hashes_((std::max)(instance.number_of_elements(), instance.number_of_sets())),
-            indexed_set_((std::max)(instance.number_of_elements(), instance.number_of_sets())),
-            indexed_set_2_((std::max)(instance.number_of_elements(), instance.number_of_sets())),
-            indexed_set_3_((std::max)(instance.number_of_elements(), instance.number_of_sets())),
-            indexed_set_4_((std::max)(instance.number_of_elements(), instance.number_of_sets())),
-            indexed_set_5_((std::max)(instance.number_of_elements(), instance.number_of_sets())),
-            indexed_set_6_((std::max)(instance.number_of_elements(), instance.number_of_sets())),
-            indexed_set_7_((std::max)(instance.number_of_elements(), instance.number_of_sets())),
-            indexed_map_((std::max)(instance.number_of_elements(), instance.number_of_sets())),
-            random_((std::max)(instance.number_of_elements(), instance.number_of_sets())),
-            set_((std::max)(instance.number_of_elements(), instance.number_of_sets())) { }
+        Tmp(
+                SetId number_of_sets,
+                ElementId number_of_elements):
+            unreduction_operations(number_of_sets),
+            indexed_set_((std::max)(number_of_elements, number_of_sets)),
+            indexed_set_2_((std::max)(number_of_elements, number_of_sets)),
+            indexed_set_3_((std::max)(number_of_elements, number_of_sets)),
+            indexed_set_4_((std::max)(number_of_elements, number_of_sets)),
+            indexed_set_5_((std::max)(number_of_elements, number_of_sets)),
+            indexed_set_6_((std::max)(number_of_elements, number_of_sets)),
+            indexed_set_7_((std::max)(number_of_elements, number_of_sets)),
+            indexed_map_((std::max)(number_of_elements, number_of_sets)),
+            random_((std::max)(number_of_elements, number_of_sets)),
+            set_((std::max)(number_of_elements, number_of_sets)),
+            worklist_positions((int)WorklistConsumer::NumberOfConsumers),
+            modified_sets((std::max)(number_of_elements, number_of_sets)),
+            modified_elements((std::max)(number_of_elements, number_of_sets)),
+            affected_((std::max)(number_of_elements, number_of_sets))
+        {
+            std::uniform_int_distribution<uint64_t> distribution(
+                std::numeric_limits<uint64_t>::min(),
+                std::numeric_limits<uint64_t>::max()
+            );
+            for (SetId pos = 0; pos < (SetId)random_.size(); ++pos)
+                random_[pos] = distribution(generator_);
+        }
 
         ReductionInstance instance;
 
-        ReductionInstance instance_2;
-
+        /** For each set, the corresponding sets in the original instance. */
         std::vector<UnreductionOperations> unreduction_operations;
 
-        std::vector<int64_t> hashes_;
+        /** Mandatory sets (from the original instance). */
+        std::vector<SetId> mandatory_sets;
+
+        /** Statistics of the reduction rules. */
+        std::vector<RuleStatistics> rule_statistics;
+
+        /** Number of rounds performed. */
+        Counter number_of_rounds = 0;
+
+        /** Scheduling state of the reduction rules. */
+        std::map<std::string, RuleSchedule> rule_schedules;
 
         std::vector<uint64_t> random_;
 
@@ -160,6 +479,42 @@ private:
         optimizationtools::IndexedMap<SetPos> indexed_map_;
 
         std::mt19937_64 generator_;
+
+        /** Signatures of the sets of 'instance'. */
+        std::vector<uint64_t> set_signatures;
+
+        /** Signatures of the elements of 'instance'. */
+        std::vector<uint64_t> element_signatures;
+
+        /**
+         * Log of the sets whose list of elements has been modified.
+         *
+         * A set may appear several times, and removed sets are not discarded.
+         */
+        std::vector<SetId> modified_sets_log;
+
+        /**
+         * Log of the elements whose list of sets has been modified.
+         *
+         * An element may appear several times, and removed elements are not
+         * discarded.
+         */
+        std::vector<ElementId> modified_elements_log;
+
+        /** Positions of the consumers in the logs. */
+        std::vector<WorklistPosition> worklist_positions;
+
+        /** Sets modified since the previous call of a consumer. */
+        optimizationtools::IndexedSet modified_sets;
+
+        /** Elements modified since the previous call of a consumer. */
+        optimizationtools::IndexedSet modified_elements;
+
+        /** Sets or elements affected by a removal. */
+        optimizationtools::IndexedSet affected_;
+
+        /** Number of calls to 'update'. */
+        Counter number_of_updates = 0;
     };
 
     ReductionInstance instance_to_reduction(
@@ -168,20 +523,133 @@ private:
     bool check(
             const ReductionInstance& reduction_instance);
 
+    /**
+     * Return 'true' iff enough sets or elements have been removed for 'update'
+     * to be worth it.
+     */
     bool needs_update(
-            ReductionInstance& reduction_instance);
+            const ReductionInstance& reduction_instance) const;
 
-    void update(
-            ReductionInstance& reduction_instance,
-            std::vector<UnreductionOperations>& unreduction_operations);
+    /**
+     * Renumber the sets and the elements of the reduction instance to discard
+     * the removed ones.
+     *
+     * The adjacency lists are compacted in place and the logs of the modified
+     * sets and elements are renumbered accordingly.
+     */
+    void update(Tmp& tmp);
 
     Instance reduction_to_instance(
-            const ReductionInstance& reduction_instance);
+            const ReductionInstance& reduction_instance,
+            const ReductionParameters& parameters);
+
+    /**
+     * Compute the signatures of the sets and of the elements of the reduction
+     * instance.
+     *
+     * The signature of a set has one bit set per element it covers, and the
+     * signature of an element one bit set per set covering it. If a set is
+     * included in another set, its signature is included in the signature of
+     * the other set, so that most pairs are rejected with a single bit
+     * operation before checking the inclusion.
+     *
+     * After the first call, only the signatures of the sets and elements
+     * modified since the previous call are computed again.
+     */
+    void compute_signatures(Tmp& tmp);
+
+    /**
+     * Remove sets from the reduction instance.
+     *
+     * The elements covered by the removed sets are added to the log of the
+     * modified elements.
+     */
+    void remove_sets(
+            Tmp& tmp,
+            const optimizationtools::IndexedSet& sets_to_remove);
+
+    /**
+     * Remove elements from the reduction instance.
+     *
+     * The sets covering the removed elements are added to the log of the
+     * modified sets.
+     */
+    void remove_elements(
+            Tmp& tmp,
+            const optimizationtools::IndexedSet& elements_to_remove);
+
+    /**
+     * Collect in 'tmp.modified_sets' and 'tmp.modified_elements' the sets and
+     * the elements which have not been removed and have been modified since
+     * the previous call for the same consumer.
+     *
+     * Return 'false' if it is the first call for this consumer. In this case,
+     * the collections are left empty and the whole instance must be
+     * considered.
+     */
+    bool collect_modified(
+            Tmp& tmp,
+            WorklistConsumer consumer);
+
+    /** Add the elements of the sets of 'tmp.modified_sets' to 'tmp.modified_elements'. */
+    void add_elements_of_modified_sets(Tmp& tmp);
+
+    /** Add the sets of the elements of 'tmp.modified_elements' to 'tmp.modified_sets'. */
+    void add_sets_of_modified_elements(Tmp& tmp);
 
     /*
      * Private methods
      */
 
+    /**
+     * Call a reduction rule and record its statistics.
+     *
+     * If the adaptive rule scheduling is enabled and 'can_be_skipped' is
+     * 'true', the call is skipped while the rule is demoted.
+     */
+    template <typename RuleFunction>
+    bool apply_rule(
+            Tmp& tmp,
+            const ReductionParameters& parameters,
+            Counter round_number,
+            const std::string& rule,
+            RuleFunction rule_function,
+            bool can_be_skipped = true);
+
+    /**
+     * Apply the reduction rules until none of them applies.
+     *
+     * If 'split' is 'true', stop and return 'true' as soon as the instance has
+     * several connected components.
+     */
+    bool apply_rules(
+            Tmp& tmp,
+            const ReductionParameters& parameters,
+            bool split);
+
+    /**
+     * Compute the connected components of the reduction instance.
+     *
+     * The components are numbered in the order of their smallest set. Return
+     * the number of components.
+     */
+    ComponentId compute_components(
+            const ReductionInstance& reduction_instance,
+            std::vector<ComponentId>& sets_components,
+            std::vector<ComponentId>& elements_components) const;
+
+    /**
+     * Reduce the connected components of the reduction instance independently
+     * and merge them back.
+     *
+     * The components are reduced in parallel with
+     * 'parameters.number_of_threads' threads. The result doesn't depend on the
+     * number of threads.
+     */
+    void reduce_components(
+            Tmp& tmp,
+            const ReductionParameters& parameters);
+
     /**
      * Remove mandatory sets.
      *
@@ -191,11 +659,27 @@ private:
      */
     bool reduce_mandatory_sets(Tmp& tmp);
 
-    /** Remove identical elements. */
-    bool reduce_identical_elements(Tmp& tmp);
+    /**
+     * Remove identical elements.
+     *
+     * When all the elements are considered, they are grouped by number of
+     * sets and hash with a parallel radix sort, and only the elements of a
+     * same group are compared.
+     */
+    bool reduce_identical_elements(
+            Tmp& tmp,
+            const ReductionParameters& parameters);
 
-    /** Remove identical sets. */
-    bool reduce_identical_sets(Tmp& tmp);
+    /**
+     * Remove identical sets.
+     *
+     * When all the sets are considered, they are grouped by number of
+     * elements and hash with a parallel radix sort, and only the sets of a
+     * same group are compared.
+     */
+    bool reduce_identical_sets(
+            Tmp& tmp,
+            const ReductionParameters& parameters);
 
     /**
      * Perform set folding reduction.
@@ -217,7 +701,9 @@ private:
      *   Real-World Graphs" (Lamm et al., 2019)
      *   https://doi.org/10.1137/1.9781611975499.12
      */
-    bool reduce_twin(Tmp& tmp);
+    bool reduce_twin(
+            Tmp& tmp,
+            const ReductionParameters& parameters);
 
     /**
      * Perform domination reduction.
@@ -257,20 +743,46 @@ private:
 
     /**
      * Perform linear programming reduction.
+     *
+     * If all the elements are covered by exactly 2 sets, the linear
+     * relaxation is half-integral and is solved exactly as a bipartite vertex
+     * cover problem. Otherwise, 'reduce_reduced_cost_fixing' is called.
      */
     bool reduce_linear_programming(
             Tmp& tmp,
             const ReductionParameters& parameters);
 
+    /**
+     * Fix sets with the reduced costs of the Lagrangian relaxation of the
+     * covering constraints.
+     *
+     * The multipliers are computed with a subgradient algorithm and the upper
+     * bound with a greedy algorithm completing the solutions of the
+     * relaxation. A set is removed if the solutions containing it cost at
+     * least the upper bound, and fixed if the solutions not containing it
+     * cost at least the upper bound.
+     *
+     * "A lagrangian heuristic for set-covering problems" (Beasley, 1990)
+     */
+    bool reduce_reduced_cost_fixing(
+            Tmp& tmp,
+            const ReductionParameters& parameters);
+
     /**
      * Perform crown reduction.
      *
+     * The crowns are searched in the structure of the elements covered by
+     * two sets; the auxiliary matching is computed with the Hopcroft-Karp
+     * algorithm.
+     *
      * Generalization from vertex cover:
      * - "Crown Reductions and Decompositions: Theoretical Results and Practical
      *   Methods" (Suters, 2004)
      *   https://trace.tennessee.edu/utk_gradthes/2225/
      */
-    bool reduce_crown(Tmp& tmp);
+    bool reduce_crown(
+            Tmp& tmp,
+            const ReductionParameters& parameters);
 
     /**
      * Remove elements dominated by elements covered by 2 sets.
@@ -289,6 +801,9 @@ private:
      * This is Reduction Rule 5 in:
      * "Exact algorithms for dominating set" (an Rooij et Bodlaender, 2011)
      * https://doi.org/10.1016/j.dam.2011.07.001
+     *
+     * All the elements are checked, in parallel with
+     * 'parameters.number_of_threads' threads.
      */
     bool reduce_dominated_elements(
             Tmp& tmp,
@@ -311,12 +826,36 @@ private:
      * This is Reduction Rule 3 in:
      * "Exact algorithms for dominating set" (an Rooij et Bodlaender, 2011)
      * https://doi.org/10.1016/j.dam.2011.07.001
+     *
+     * All the sets are checked, in parallel with
+     * 'parameters.number_of_threads' threads.
      */
     bool reduce_dominated_sets(
             Tmp& tmp,
             const ReductionParameters& parameters);
 
-    void reduce_small_components(Tmp& tmp);
+    /**
+     * Remove the connected components of the reduced instance which can be
+     * solved to optimality.
+     *
+     * Components with at most
+     * 'parameters.small_components_maximum_number_of_sets' sets are solved by
+     * branch-and-bound. The other components are removed if a heuristic
+     * solution reaches a lower bound. The components are solved in parallel
+     * with 'parameters.number_of_threads' threads.
+     */
+    void reduce_small_components(
+            Tmp& tmp,
+            const ReductionParameters& parameters);
+
+    /** Read a reduction written by 'write'. */
+    void read(const std::string& reduction_path);
+
+    /** Magic number at the start of the reduction files. */
+    static constexpr uint64_t binary_magic_number = 0x314e444552534353;
+
+    /** Version of the format of the reduction files. */
+    static constexpr uint64_t binary_version = 1;
 
     /*
      * Private attributes
@@ -340,6 +879,15 @@ private:
      **/
     Cost extra_cost_;
 
+    /** Number of rounds. */
+    Counter number_of_rounds_ = 0;
+
+    /** Time spent to reduce the instance. */
+    double time_ = 0.0;
+
+    /** Statistics of the reduction rules. */
+    std::vector<RuleStatistics> rule_statistics_;
+
 };
 
 }
@@ -116,6 +116,13 @@ private:
      * Private methods
      */
 
+    /**
+     * Get the original ids of the sets of the solution.
+     *
+     * They are sorted if the instance has been renumbered.
+     */
+    std::vector<SetId> original_set_ids() const;
+
     /** Write an instance file in 'geco2020' format. */
     void write_gecco2020(
             std::ofstream& file) const;
@@ -160,7 +167,9 @@ void Solution::add(SetId set_id)
         elements_.set(element_id, elements_[element_id] + 1);
     }
     sets_.add(set_id);
-    component_costs_[component_id] += instance().set(set_id).cost;
+    // Sets which don't cover any element don't belong to any component.
+    if (component_id != -1)
+        component_costs_[component_id] += instance().set(set_id).cost;
     cost_ += instance().set(set_id).cost;
 }
 
@@ -180,7 +189,8 @@ void Solution::remove(SetId set_id)
             component_number_of_elements_[component_id]--;
     }
     sets_.remove(set_id);
-    component_costs_[component_id] -= instance().set(set_id).cost;
+    if (component_id != -1)
+        component_costs_[component_id] -= instance().set(set_id).cost;
     cost_ -= instance().set(set_id).cost;
 }
 
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace setcoveringsolver
+{
+
+/**
+ * Read-only view of the whole content of a file.
+ *
+ * The file is memory-mapped when the platform supports it, and read into
+ * memory otherwise.
+ */
+class MappedFile
+{
+
+public:
+
+    /** Constructor. */
+    MappedFile(const std::string& path);
+
+    /** Destructor. */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** Get a pointer to the first character of the file. */
+    inline const char* data() const { return data_; }
+
+    /** Get the size of the file. */
+    inline size_t size() const { return size_; }
+
+private:
+
+    /** Pointer to the first character of the file. */
+    const char* data_ = nullptr;
+
+    /** Size of the file. */
+    size_t size_ = 0;
+
+    /** Content of the file if it could not be memory-mapped. */
+    std::vector<char> buffer_;
+
+    /** 'true' iff the file is memory-mapped. */
+    bool mapped_ = false;
+
+};
+
+/**
+ * Interface for a stream of characters read by a tokenizer.
+ */
+class CharacterSource
+{
+
+public:
+
+    /** Destructor. */
+    virtual ~CharacterSource() { }
+
+    /**
+     * Read at most 'size' characters into 'buffer'.
+     *
+     * Return the number of characters read, 0 at the end of the stream.
+     */
+    virtual size_t read(
+            char* buffer,
+            size_t size) = 0;
+
+};
+
+/**
+ * Character source reading from a 'FILE*'.
+ */
+class FileSource: public CharacterSource
+{
+
+public:
+
+    /** Constructor. */
+    FileSource(FILE* file): file_(file) { }
+
+    virtual size_t read(
+            char* buffer,
+            size_t size) override
+    {
+        return fread(buffer, 1, size, file_);
+    }
+
+private:
+
+    /** File. */
+    FILE* file_;
+
+};
+
+/** Compression formats of instance files. */
+enum class CompressionFormat
+{
+    None,
+    Gzip,
+    Xz,
+};
+
+/** Detect the compression format of a file from its magic bytes. */
+CompressionFormat detect_compression_format(
+        const char* data,
+        size_t size);
+
+/**
+ * Character source decompressing a compressed file.
+ *
+ * The decompression runs on a separate thread which fills a bounded queue of
+ * blocks, so that it is pipelined with the parsing of the decompressed
+ * characters.
+ */
+class DecompressingSource: public CharacterSource
+{
+
+public:
+
+    /** Constructor. */
+    DecompressingSource(
+            const char* data,
+            size_t size,
+            CompressionFormat compression_format);
+
+    /** Destructor. */
+    virtual ~DecompressingSource();
+
+    DecompressingSource(const DecompressingSource&) = delete;
+    DecompressingSource& operator=(const DecompressingSource&) = delete;
+
+    virtual size_t read(
+            char* buffer,
+            size_t size) override;
+
+private:
+
+    /** Size of the decompressed blocks. */
+    static constexpr size_t block_size_ = 1 << 20;
+
+    /** Maximum number of decompressed blocks waiting to be read. */
+    static constexpr size_t maximum_number_of_blocks_ = 4;
+
+    /** Compressed data. */
+    const char* data_;
+
+    /** Size of the compressed data. */
+    size_t size_;
+
+    /** Compression format. */
+    CompressionFormat compression_format_;
+
+    /** Decompressed blocks waiting to be read. */
+    std::deque<std::vector<char>> blocks_;
+
+    /** Block being read. */
+    std::vector<char> block_;
+
+    /** Position of the next character to read in 'block_'. */
+    size_t block_position_ = 0;
+
+    /** 'true' iff the decompression thread has finished. */
+    bool finished_ = false;
+
+    /** 'true' iff the decompression thread must stop. */
+    bool stop_ = false;
+
+    /** Exception thrown by the decompression thread. */
+    std::exception_ptr exception_;
+
+    /** Mutex protecting the queue. */
+    std::mutex mutex_;
+
+    /** Condition variable signaling a change of the queue. */
+    std::condition_variable condition_variable_;
+
+    /** Decompression thread. */
+    std::thread thread_;
+
+    /** Function run by the decompression thread. */
+    void decompress();
+
+    /** Decompress a file in gzip format. */
+    void decompress_gzip();
+
+    /** Decompress a file in xz format. */
+    void decompress_xz();
+
+    /**
+     * Add a decompressed block to the queue.
+     *
+     * Return 'false' if the decompression must stop.
+     */
+    bool push_block(std::vector<char>&& block);
+
+};
+
+/**
+ * Integer tokenizer.
+ *
+ * The characters are either a range in memory, for example a memory-mapped
+ * file, or are read by blocks from a character source.
+ */
+class Tokenizer
+{
+
+public:
+
+    /** Constructor from a range of characters. */
+    Tokenizer(
+            const char* begin,
+            const char* end):
+        position_(begin),
+        end_(end) { }
+
+    /** Constructor from a character source. */
+    Tokenizer(
+            CharacterSource& source,
+            size_t buffer_size = 1 << 21):
+        buffer_(buffer_size),
+        source_(&source) { }
+
+    /**
+     * Get a pointer to the next character.
+     *
+     * The pointer is only meaningful for a tokenizer built from a range of
+     * characters.
+     */
+    inline const char* position() const { return position_; }
+
+    /** Return 'true' iff all the characters have been read. */
+    inline bool eof() { return !fill(); }
+
+    /** Get the next character without consuming it. */
+    inline char peek() { return fill()? *position_: EOF; }
+
+    /** Skip the characters until the end of the current line. */
+    inline void skip_line()
+    {
+        while (fill()) {
+            const char* line_end = (const char*)memchr(position_, '\n', end_ - position_);
+            if (line_end != nullptr) {
+                position_ = line_end + 1;
+                return;
+            }
+            position_ = end_;
+        }
+    }
+
+    /**
+     * Read the next integer of the current line.
+     *
+     * Non-digit characters are skipped, except a '-' right before the digits.
+     * Return 'false' and consume the end of the line if the line doesn't
+     * contain any other integer.
+     */
+    template <typename T>
+    inline bool read_int_on_line(T& x)
+    {
+        // Skip non-digit characters.
+        char c = ' ';
+        char previous_character;
+        do {
+            if (!fill())
+                return false;
+            previous_character = c;
+            c = *(position_++);
+            if (c == '\n')
+                return false;
+        } while (c < '0' || c > '9');
+
+        x = read_digits<T>(c, previous_character == '-');
+        return true;
+    }
+
+    /**
+     * Read the next integer, possibly on a following line.
+     *
+     * Return 'false' if there is no other integer.
+     */
+    template <typename T>
+    inline bool read_int(T& x)
+    {
+        // Skip non-digit characters.
+        char c = ' ';
+        char previous_character;
+        do {
+            if (!fill())
+                return false;
+            previous_character = c;
+            c = *(position_++);
+        } while (c < '0' || c > '9');
+
+        x = read_digits<T>(c, previous_character == '-');
+        return true;
+    }
+
+private:
+
+    /** Pointer to the next character. */
+    const char* position_ = nullptr;
+
+    /** Pointer past the last available character. */
+    const char* end_ = nullptr;
+
+    /** Buffer for the characters read from the source. */
+    std::vector<char> buffer_;
+
+    /** Character source, 'nullptr' for a range of characters. */
+    CharacterSource* source_ = nullptr;
+
+    /**
+     * Make sure that a character is available.
+     *
+     * Return 'false' if all the characters have been read.
+     */
+    inline bool fill()
+    {
+        if (position_ != end_)
+            return true;
+        if (source_ == nullptr)
+            return false;
+        size_t size = source_->read(buffer_.data(), buffer_.size());
+        position_ = buffer_.data();
+        end_ = buffer_.data() + size;
+        return size > 0;
+    }
+
+    /**
+     * Read the remaining digits of an integer starting with 'c'.
+     *
+     * The absolute value is checked against the range of 'T' before each
+     * digit is added, so that it never overflows.
+     */
+    template <typename T>
+    inline T read_digits(
+            char c,
+            bool negative)
+    {
+        static_assert(std::is_signed<T>::value, "T must be a signed type.");
+        // The magnitude of the lowest value of 'T' is 'max + 1'.
+        uint64_t maximum_value = (uint64_t)std::numeric_limits<T>::max()
+            + (negative? 1: 0);
+        uint64_t value = c - '0';
+        while (fill() && *position_ >= '0' && *position_ <= '9') {
+            uint64_t digit = *position_ - '0';
+            if (value > (maximum_value - digit) / 10) {
+                throw std::overflow_error(
+                        "setcoveringsolver::Tokenizer: "
+                        "value too large for the index type.");
+            }
+            value = value * 10 + digit;
+            position_++;
+        }
+        if (negative)
+            return (value == 0)? 0: -(T)(value - 1) - 1;
+        return value;
+    }
+
+};
+
+}
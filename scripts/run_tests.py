@@ -1,4 +1,5 @@
 import argparse
+import json
 import sys
 import os
 
@@ -56,3 +57,98 @@ if args.tests is None or "greedy" in args.tests:
         print()
     print()
     print()
+
+
+if args.tests is None or "reduction" in args.tests:
+    print("Reduction")
+    print("---------")
+    print()
+
+    reduction_data = [
+            (os.path.join("beasley1987", "scpa1.txt"), "orlibrary"),
+            (os.path.join("beasley1987", "scpe5.txt"), "orlibrary") ]
+
+    for instance, instance_format in reduction_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        fingerprints = {}
+        for reduce in [0, 1]:
+            json_output_path = os.path.join(
+                    args.directory,
+                    "reduction",
+                    instance + "_reduce_" + str(reduce) + ".json")
+            if not os.path.exists(os.path.dirname(json_output_path)):
+                os.makedirs(os.path.dirname(json_output_path))
+            command = (
+                    main
+                    + "  --verbosity-level 1"
+                    + "  --input \"" + instance_path + "\""
+                    + "  --format \"" + instance_format + "\""
+                    + "  --algorithm greedy"
+                    + "  --reduce " + str(reduce)
+                    + "  --output \"" + json_output_path + "\"")
+            print(command)
+            status = os.system(command)
+            if status != 0:
+                sys.exit(1)
+            with open(json_output_path) as json_output_file:
+                json_output = json.load(json_output_file)
+            # The statistics of the reduction must be kept in the final output.
+            if reduce and "Reduction" not in json_output:
+                print("Missing \"Reduction\" in " + json_output_path + ".")
+                sys.exit(1)
+            fingerprints[reduce] = json_output["Instance"]["Fingerprint"]
+        # The instance of the output is the input instance, not the reduced
+        # one.
+        if fingerprints[0] != fingerprints[1]:
+            print("Different fingerprints with and without reduction for "
+                  + instance_path + ".")
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+if args.tests is None or "update" in args.tests:
+    print("Update")
+    print("------")
+    print()
+
+    update_data = [
+            (os.path.join("beasley1987", "scpa1.txt"), "orlibrary"),
+            (os.path.join("beasley1987", "scpe5.txt"), "orlibrary") ]
+
+    for instance, instance_format in update_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "update",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        # Solve the instance, remove some sets, and solve the updated instance
+        # from the solution and the penalties of the first run.
+        command = (
+                main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm local-search-row-weighting"
+                + "  --maximum-number-of-iterations 10000"
+                + "  --update-remove-sets 0 1 2"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        with open(json_output_path) as json_output_file:
+            json_output = json.load(json_output_file)
+        if not json_output["Output"]["Solution"]["Feasible"]:
+            print("Infeasible solution in " + json_output_path + ".")
+            sys.exit(1)
+        print()
+    print()
+    print()
@@ -10,6 +10,7 @@ void AlgorithmFormatter::start(
         const std::string& algorithm_name)
 {
     output_.json["Parameters"] = parameters_.to_json();
+    output_.json["Instance"] = output_.solution.instance().to_json();
 
     if (parameters_.verbosity_level == 0)
         return;
@@ -56,16 +57,23 @@ void AlgorithmFormatter::print_header()
     print("");
 }
 
-void AlgorithmFormatter::print_reduced_instance(
-        const Instance& reduced_instance)
+void AlgorithmFormatter::print_reduction(
+        const Reduction& reduction)
 {
+    output_.json["Reduction"] = reduction.to_json();
+
     if (parameters_.verbosity_level == 0)
         return;
+    *os_
+        << std::endl
+        << "Reduction" << std::endl
+        << "---------" << std::endl;
+    reduction.format(*os_, parameters_.verbosity_level);
     *os_
         << std::endl
         << "Reduced instance" << std::endl
         << "----------------" << std::endl;
-    reduced_instance.format(*os_, parameters_.verbosity_level);
+    reduction.instance().format(*os_, parameters_.verbosity_level);
 }
 
 void AlgorithmFormatter::print(
@@ -83,7 +91,7 @@ void AlgorithmFormatter::print(
         << std::setw(24) << s << std::endl;
 }
 
-void AlgorithmFormatter::update_solution(
+bool AlgorithmFormatter::update_solution(
         const Solution& solution,
         const std::string& s)
 {
@@ -99,7 +107,39 @@ void AlgorithmFormatter::update_solution(
         output_.json["IntermediaryOutputs"].push_back(output_.to_json());
         if (parameters_.enable_new_solution_callback)
             parameters_.new_solution_callback(output_, s);
+        return true;
     }
+    return false;
+}
+
+bool AlgorithmFormatter::update_solution(
+        const Solution& solution,
+        const std::vector<SetId>& added_sets,
+        const std::vector<SetId>& removed_sets,
+        const std::string& s)
+{
+    if (optimizationtools::is_solution_strictly_better(
+                objective_direction(),
+                output_.solution.feasible(),
+                output_.solution.objective_value(),
+                solution.feasible(),
+                solution.objective_value())) {
+        output_.time = parameters_.timer.elapsed_time();
+        output_.solution = solution;
+        print(s);
+        output_.json["IntermediaryOutputs"].push_back(output_.to_json());
+        if (parameters_.enable_new_solution_callback) {
+            output_.solution_delta = true;
+            output_.added_sets = added_sets;
+            output_.removed_sets = removed_sets;
+            parameters_.new_solution_callback(output_, s);
+            output_.solution_delta = false;
+            output_.added_sets.clear();
+            output_.removed_sets.clear();
+        }
+        return true;
+    }
+    return false;
 }
 
 void AlgorithmFormatter::update_bound(
@@ -114,8 +154,12 @@ void AlgorithmFormatter::update_bound(
         output_.bound = bound;
         print(s);
         output_.json["IntermediaryOutputs"].push_back(output_.to_json());
-        if (parameters_.enable_new_solution_callback)
+        if (parameters_.enable_new_solution_callback) {
+            // The solution hasn't changed since the previous callback.
+            output_.solution_delta = true;
             parameters_.new_solution_callback(output_, s);
+            output_.solution_delta = false;
+        }
     }
 }
 
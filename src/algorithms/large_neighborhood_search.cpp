@@ -51,8 +51,35 @@ const LargeNeighborhoodSearchOutput setcoveringsolver::large_neighborhood_search
     }
 
     // Reduction.
-    if (parameters.reduction_parameters.reduce)
-        return solve_reduced_instance(large_neighborhood_search, instance, parameters, algorithm_formatter, output);
+    if (parameters.reduction_parameters.reduce) {
+        // The initial solution and the initial penalties refer to the sets and
+        // the elements of the unreduced instance.
+        if (parameters.initial_solution != nullptr
+                || parameters.initial_penalties != nullptr) {
+            throw std::invalid_argument(
+                    "setcoveringsolver::large_neighborhood_search: "
+                    "an initial solution or initial penalties are given "
+                    "while the reduction is enabled; "
+                    "set 'reduction_parameters.reduce' to 'false'.");
+        }
+        return solve_reduced_instance(
+                [](
+                    const Instance& instance,
+                    const LargeNeighborhoodSearchParameters& parameters)
+                {
+                    LargeNeighborhoodSearchOutput output = large_neighborhood_search(
+                            instance,
+                            parameters);
+                    // The penalties are the ones of the elements of the
+                    // reduced instance.
+                    output.penalties.clear();
+                    return output;
+                },
+                instance,
+                parameters,
+                algorithm_formatter,
+                output);
+    }
 
     algorithm_formatter.print_header();
 
@@ -64,7 +91,9 @@ const LargeNeighborhoodSearchOutput setcoveringsolver::large_neighborhood_search
     algorithm_formatter.update_bound(bound, "trivial bound");
 
     // Compute initial greedy solution.
-    {
+    if (parameters.initial_solution != nullptr) {
+        algorithm_formatter.update_solution(*parameters.initial_solution, "initial solution");
+    } else {
         Parameters greedy_parameters;
         greedy_parameters.timer = parameters.timer;
         greedy_parameters.reduction_parameters.reduce = false;
@@ -77,7 +106,23 @@ const LargeNeighborhoodSearchOutput setcoveringsolver::large_neighborhood_search
 
     // Initialize local search structures.
     std::vector<LargeNeighborhoodSearchSet> sets(instance.number_of_sets());
+    if (parameters.initial_penalties != nullptr
+            && (ElementId)parameters.initial_penalties->size() != instance.number_of_elements()) {
+        throw std::invalid_argument(
+                "setcoveringsolver::large_neighborhood_search: "
+                "wrong number of initial penalties; "
+                "initial_penalties.size(): " + std::to_string(parameters.initial_penalties->size()) + "; "
+                "number_of_elements: " + std::to_string(instance.number_of_elements()) + ".");
+    }
     std::vector<Penalty> solution_penalties(instance.number_of_elements(), 1);
+    if (parameters.initial_penalties != nullptr) {
+        for (ElementId element_id = 0;
+                element_id < instance.number_of_elements();
+                ++element_id) {
+            if ((*parameters.initial_penalties)[element_id] > 0)
+                solution_penalties[element_id] = (*parameters.initial_penalties)[element_id];
+        }
+    }
     for (SetId set_id: solution.sets())
         for (ElementId element_id: instance.set(set_id).elements)
             if (solution.covers(element_id) == 1)
@@ -92,6 +137,11 @@ const LargeNeighborhoodSearchOutput setcoveringsolver::large_neighborhood_search
 
     optimizationtools::IndexedSet added_sets(instance.number_of_sets());
     optimizationtools::IndexedSet removed_sets(instance.number_of_sets());
+    // Sets added to and removed from the best solution since it has last been
+    // given to the algorithm formatter, that is, compared to
+    // 'output.solution'.
+    optimizationtools::IndexedSet best_added_sets(instance.number_of_sets());
+    optimizationtools::IndexedSet best_removed_sets(instance.number_of_sets());
 
     Counter iterations_without_improvment = 0;
     Cost best_cost = solution.cost();
@@ -259,6 +309,20 @@ const LargeNeighborhoodSearchOutput setcoveringsolver::large_neighborhood_search
         // Update best solution.
         //std::cout << "cost " << solution.cost() << std::endl;
         if (best_cost >= solution.cost()){
+            for (SetId set_id: added_sets) {
+                if (best_removed_sets.contains(set_id)) {
+                    best_removed_sets.remove(set_id);
+                } else {
+                    best_added_sets.add(set_id);
+                }
+            }
+            for (SetId set_id: removed_sets) {
+                if (best_added_sets.contains(set_id)) {
+                    best_added_sets.remove(set_id);
+                } else {
+                    best_removed_sets.add(set_id);
+                }
+            }
             added_sets.clear();
             removed_sets.clear();
             if (best_cost > solution.cost()) {
@@ -279,8 +343,13 @@ const LargeNeighborhoodSearchOutput setcoveringsolver::large_neighborhood_search
 
     std::stringstream ss;
     ss << "iteration " << output.number_of_iterations;
-    algorithm_formatter.update_solution(solution, ss.str());
+    algorithm_formatter.update_solution(
+            solution,
+            std::vector<SetId>(best_added_sets.begin(), best_added_sets.end()),
+            std::vector<SetId>(best_removed_sets.begin(), best_removed_sets.end()),
+            ss.str());
 
+    output.penalties = solution_penalties;
     algorithm_formatter.end();
     return output;
 }
@@ -678,16 +678,30 @@ const LocalSearchRowWeightingOutput setcoveringsolver::local_search_row_weightin
 
     // Reduction.
     if (parameters.reduction_parameters.reduce) {
+        // The initial solution and the initial penalties refer to the sets and
+        // the elements of the unreduced instance.
+        if (initial_solution != nullptr
+                || parameters.initial_penalties != nullptr) {
+            throw std::invalid_argument(
+                    "setcoveringsolver::local_search_row_weighting: "
+                    "an initial solution or initial penalties are given "
+                    "while the reduction is enabled; "
+                    "set 'reduction_parameters.reduce' to 'false'.");
+        }
         return solve_reduced_instance(
                 [&generator](
                     const Instance& instance,
                     const LocalSearchRowWeightingParameters& parameters)
                 {
-                    return local_search_row_weighting(
+                    LocalSearchRowWeightingOutput output = local_search_row_weighting(
                             instance,
                             generator,
                             nullptr,
                             parameters);
+                    // The penalties are the ones of the elements of the
+                    // reduced instance.
+                    output.penalties.clear();
+                    return output;
                 },
                 instance,
                 parameters,
@@ -724,6 +738,17 @@ const LocalSearchRowWeightingOutput setcoveringsolver::local_search_row_weightin
     optimizationtools::IndexedSet solution_tmp(instance.number_of_sets());
     for (SetId set_id: solution.sets())
         solution_tmp.add(set_id);
+    // Sets added to and removed from the current best solution since it has
+    // last been given to the algorithm formatter, that is, compared to
+    // 'output.solution'.
+    optimizationtools::IndexedSet solution_tmp_added_sets(instance.number_of_sets());
+    optimizationtools::IndexedSet solution_tmp_removed_sets(instance.number_of_sets());
+    for (SetId set_id: solution_tmp)
+        if (!output.solution.contains(set_id))
+            solution_tmp_added_sets.add(set_id);
+    for (SetId set_id: output.solution.sets())
+        if (!solution_tmp.contains(set_id))
+            solution_tmp_removed_sets.add(set_id);
 
     std::vector<SetPos> sets_id_to_component_pos(instance.number_of_sets(), -1);
     optimizationtools::IndexedSet scores_in_to_update(instance.number_of_sets());
@@ -756,14 +781,27 @@ const LocalSearchRowWeightingOutput setcoveringsolver::local_search_row_weightin
         sets[set_id].last_addition = 0;
 
     // Initialize element penalties and set scores.
+    if (parameters.initial_penalties != nullptr
+            && (ElementId)parameters.initial_penalties->size() != instance.number_of_elements()) {
+        throw std::invalid_argument(
+                "setcoveringsolver::local_search_row_weighting: "
+                "wrong number of initial penalties; "
+                "initial_penalties.size(): " + std::to_string(parameters.initial_penalties->size()) + "; "
+                "number_of_elements: " + std::to_string(instance.number_of_elements()) + ".");
+    }
     Penalty solution_penalty = 0;
     std::vector<Penalty> solution_penalties(instance.number_of_elements(), 1);
     for (ElementId element_id = 0;
             element_id < instance.number_of_elements();
             ++element_id) {
-        solution_penalties[element_id] = (std::max)(
-                (Penalty)1,
-                (Penalty)(1e4 / instance.element(element_id).sets.size()));
+        if (parameters.initial_penalties != nullptr
+                && (*parameters.initial_penalties)[element_id] > 0) {
+            solution_penalties[element_id] = (*parameters.initial_penalties)[element_id];
+        } else {
+            solution_penalties[element_id] = (std::max)(
+                    (Penalty)1,
+                    (Penalty)(1e4 / instance.element(element_id).sets.size()));
+        }
         if (solution.covers(element_id) == 1)
             for (SetId set_id: instance.element(element_id).sets)
                 if (solution.contains(set_id))
@@ -826,7 +864,14 @@ const LocalSearchRowWeightingOutput setcoveringsolver::local_search_row_weightin
                     solution_best.add(set_id);
                 std::stringstream ss;
                 ss << "it " << output.number_of_iterations;
-                algorithm_formatter.update_solution(solution_best, ss.str());
+                if (algorithm_formatter.update_solution(
+                            solution_best,
+                            std::vector<SetId>(solution_tmp_added_sets.begin(), solution_tmp_added_sets.end()),
+                            std::vector<SetId>(solution_tmp_removed_sets.begin(), solution_tmp_removed_sets.end()),
+                            ss.str())) {
+                    solution_tmp_added_sets.clear();
+                    solution_tmp_removed_sets.clear();
+                }
             }
         }
 
@@ -835,9 +880,19 @@ const LocalSearchRowWeightingOutput setcoveringsolver::local_search_row_weightin
                 if (solution.contains(set_id)
                         && !solution_tmp.contains(set_id)) {
                     solution_tmp.add(set_id);
+                    if (solution_tmp_removed_sets.contains(set_id)) {
+                        solution_tmp_removed_sets.remove(set_id);
+                    } else {
+                        solution_tmp_added_sets.add(set_id);
+                    }
                 } else if (!solution.contains(set_id)
                         && solution_tmp.contains(set_id)) {
                     solution_tmp.remove(set_id);
+                    if (solution_tmp_added_sets.contains(set_id)) {
+                        solution_tmp_added_sets.remove(set_id);
+                    } else {
+                        solution_tmp_removed_sets.add(set_id);
+                    }
                 }
             }
             // Update statistics
@@ -867,6 +922,7 @@ const LocalSearchRowWeightingOutput setcoveringsolver::local_search_row_weightin
                 }
                 // If all components are optimal, stop here.
                 if (all_component_optimal) {
+                    output.penalties = solution_penalties;
                     algorithm_formatter.end();
                     return output;
                 }
@@ -935,9 +991,17 @@ const LocalSearchRowWeightingOutput setcoveringsolver::local_search_row_weightin
             solution_best.add(set_id);
         std::stringstream ss;
         ss << "it " << output.number_of_iterations;
-        algorithm_formatter.update_solution(solution_best, ss.str());
+        if (algorithm_formatter.update_solution(
+                    solution_best,
+                    std::vector<SetId>(solution_tmp_added_sets.begin(), solution_tmp_added_sets.end()),
+                    std::vector<SetId>(solution_tmp_removed_sets.begin(), solution_tmp_removed_sets.end()),
+                    ss.str())) {
+            solution_tmp_added_sets.clear();
+            solution_tmp_removed_sets.clear();
+        }
     }
 
+    output.penalties = solution_penalties;
     algorithm_formatter.end();
     return output;
 }
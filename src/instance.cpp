@@ -1,104 +1,343 @@
 #include "setcoveringsolver/instance.hpp"
 
-#include "optimizationtools/containers/indexed_set.hpp"
-
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <iomanip>
 #include <thread>
 
 using namespace setcoveringsolver;
 
-const std::vector<std::vector<SetId>>& Instance::set_neighbors() const
+void Instance::compute_component_lists()
+{
+    // Sets which don't cover any element don't belong to any component.
+    ComponentId number_of_components = number_of_components_;
+    std::vector<ElementPos>& element_offsets = component_elements_offsets_;
+    std::vector<SetPos>& set_offsets = component_sets_offsets_;
+    element_offsets.assign(number_of_components + 1, 0);
+    set_offsets.assign(number_of_components + 1, 0);
+    for (ElementId element_id = 0;
+            element_id < number_of_elements();
+            ++element_id) {
+        element_offsets[element_components_[element_id] + 1]++;
+    }
+    for (SetId set_id = 0; set_id < number_of_sets(); ++set_id)
+        if (set_components_[set_id] != -1)
+            set_offsets[set_components_[set_id] + 1]++;
+    for (ComponentId component_id = 0;
+            component_id < number_of_components;
+            ++component_id) {
+        element_offsets[component_id + 1] += element_offsets[component_id];
+        set_offsets[component_id + 1] += set_offsets[component_id];
+    }
+    component_elements_.resize(element_offsets[number_of_components]);
+    component_sets_.resize(set_offsets[number_of_components]);
+    std::vector<ElementPos> element_positions(element_offsets.begin(), element_offsets.end() - 1);
+    std::vector<SetPos> set_positions(set_offsets.begin(), set_offsets.end() - 1);
+    for (ElementId element_id = 0;
+            element_id < number_of_elements();
+            ++element_id) {
+        ComponentId component_id = element_components_[element_id];
+        component_elements_[element_positions[component_id]++] = element_id;
+    }
+    for (SetId set_id = 0; set_id < number_of_sets(); ++set_id) {
+        ComponentId component_id = set_components_[set_id];
+        if (component_id != -1)
+            component_sets_[set_positions[component_id]++] = set_id;
+    }
+}
+
+IndexRange<SetId> Instance::set_neighbors(
+        SetId set_id,
+        NeighborsBuffer& buffer) const
 {
-    if (set_neighbors_.empty())
-        compute_set_neighbors(1);
-    return set_neighbors_;
+    return neighbors(
+            set_neighbors_,
+            set_id,
+            number_of_sets(),
+            number_of_sets(),
+            &Instance::add_set_neighbors,
+            buffer);
 }
 
-const std::vector<std::vector<ElementId>>& Instance::element_neighbors() const
+IndexRange<ElementId> Instance::element_neighbors(
+        ElementId element_id,
+        NeighborsBuffer& buffer) const
 {
-    if (element_neighbors_.empty())
-        compute_element_neighbors();
-    return element_neighbors_;
+    return neighbors(
+            element_neighbors_,
+            element_id,
+            number_of_elements(),
+            number_of_elements(),
+            &Instance::add_element_neighbors,
+            buffer);
 }
 
-const std::vector<std::vector<ElementId>>& Instance::element_set_neighbors() const
+IndexRange<SetId> Instance::element_set_neighbors(
+        ElementId element_id,
+        NeighborsBuffer& buffer) const
 {
-    if (element_set_neighbors_.empty())
-        compute_element_set_neighbors();
-    return element_set_neighbors_;
+    return neighbors(
+            element_set_neighbors_,
+            element_id,
+            number_of_elements(),
+            number_of_sets(),
+            &Instance::add_element_set_neighbors,
+            buffer);
 }
 
-void Instance::compute_set_neighbors(
-        Counter number_of_threads) const
+bool Instance::set_neighbors_cached() const
 {
-    set_neighbors_ = std::vector<std::vector<SetId>>(number_of_sets());
-    std::vector<std::thread> threads;
-    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id)
-        threads.push_back(std::thread(&Instance::compute_set_neighbors_worker,
-                    this,
-                    thread_id       * number_of_sets() / number_of_threads,
-                    (thread_id + 1) * number_of_sets() / number_of_threads));
-    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id)
-        threads[thread_id].join();
+    if (!set_neighbors_.computed)
+        compute_neighbors_table(set_neighbors_, number_of_sets(), number_of_sets(), &Instance::add_set_neighbors);
+    return set_neighbors_.cached;
 }
 
-void Instance::compute_set_neighbors_worker(
-        SetId s_start,
-        SetId s_end) const
+bool Instance::element_neighbors_cached() const
 {
-    optimizationtools::IndexedSet neighbors(number_of_sets());
-    for (SetId set_id_1 = s_start; set_id_1 < s_end; ++set_id_1) {
-        neighbors.clear();
-        for (ElementId element_id: set(set_id_1).elements)
-            for (SetId set_id_2: element(element_id).sets)
-                neighbors.add(set_id_2);
-        if (neighbors.contains(set_id_1))
-            neighbors.remove(set_id_1);
-        for (SetId set_id_2: neighbors)
-            set_neighbors_[set_id_1].push_back(set_id_2);
+    if (!element_neighbors_.computed)
+        compute_neighbors_table(element_neighbors_, number_of_elements(), number_of_elements(), &Instance::add_element_neighbors);
+    return element_neighbors_.cached;
+}
+
+bool Instance::element_set_neighbors_cached() const
+{
+    if (!element_set_neighbors_.computed)
+        compute_neighbors_table(element_set_neighbors_, number_of_elements(), number_of_sets(), &Instance::add_element_set_neighbors);
+    return element_set_neighbors_.cached;
+}
+
+void Instance::add_set_neighbors(
+        SetId set_id,
+        NeighborsBuffer& buffer) const
+{
+    for (ElementId element_id: set(set_id).elements)
+        for (SetId set_id_2: element(element_id).sets)
+            if (set_id_2 != set_id)
+                buffer.add(set_id_2);
+}
+
+void Instance::add_element_neighbors(
+        ElementId element_id,
+        NeighborsBuffer& buffer) const
+{
+    for (SetId set_id: element(element_id).sets)
+        for (ElementId element_id_2: set(set_id).elements)
+            if (element_id_2 != element_id)
+                buffer.add(element_id_2);
+}
+
+void Instance::add_element_set_neighbors(
+        ElementId element_id,
+        NeighborsBuffer& buffer) const
+{
+    for (SetId set_id: element(element_id).sets)
+        for (ElementId element_id_2: set(set_id).elements)
+            for (SetId set_id_2: element(element_id_2).sets)
+                buffer.add(set_id_2);
+}
+
+void Instance::compute_neighbors_table(
+        NeighborsTable& table,
+        Index number_of_indices,
+        Index number_of_neighbor_indices,
+        void (Instance::*add_neighbors)(Index, NeighborsBuffer&) const) const
+{
+    table = NeighborsTable();
+    table.computed = true;
+    Counter number_of_threads = (std::max)((Counter)1, number_of_threads_);
+    std::vector<std::thread> threads;
+
+    // Count the neighbors of each index.
+    table.offsets.assign(number_of_indices + 1, 0);
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([this, &table, number_of_indices, number_of_neighbor_indices, add_neighbors, number_of_threads, thread_id]()
+        {
+            NeighborsBuffer buffer;
+            for (Index index = thread_id * number_of_indices / number_of_threads;
+                    index < (thread_id + 1) * number_of_indices / number_of_threads;
+                    ++index) {
+                buffer.clear(number_of_neighbor_indices);
+                (this->*add_neighbors)(index, buffer);
+                table.offsets[index + 1] = buffer.values().size();
+            }
+        }));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+    threads.clear();
+    for (Index index = 0; index < number_of_indices; ++index)
+        table.offsets[index + 1] += table.offsets[index];
+
+    // Give up storing the table if it doesn't fit in the memory limit.
+    size_t size = table.offsets.size() * sizeof(table.offsets[0])
+        + (size_t)table.offsets.back() * sizeof(Index);
+    if (size > neighbors_memory_limit_) {
+        table.offsets = std::vector<Counter>();
+        return;
+    }
+
+    // Fill the table.
+    table.neighbors.resize(table.offsets.back());
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([this, &table, number_of_indices, number_of_neighbor_indices, add_neighbors, number_of_threads, thread_id]()
+        {
+            NeighborsBuffer buffer;
+            for (Index index = thread_id * number_of_indices / number_of_threads;
+                    index < (thread_id + 1) * number_of_indices / number_of_threads;
+                    ++index) {
+                buffer.clear(number_of_neighbor_indices);
+                (this->*add_neighbors)(index, buffer);
+                std::copy(
+                        buffer.values().begin(),
+                        buffer.values().end(),
+                        table.neighbors.begin() + table.offsets[index]);
+            }
+        }));
     }
+    for (std::thread& thread: threads)
+        thread.join();
+    table.cached = true;
 }
 
-void Instance::compute_element_neighbors() const
+IndexRange<Index> Instance::neighbors(
+        NeighborsTable& table,
+        Index index,
+        Index number_of_indices,
+        Index number_of_neighbor_indices,
+        void (Instance::*add_neighbors)(Index, NeighborsBuffer&) const,
+        NeighborsBuffer& buffer) const
 {
-    element_neighbors_ = std::vector<std::vector<ElementId>>(number_of_elements());
-    optimizationtools::IndexedSet neighbors(number_of_elements());
-    for (ElementId element_id_1 = 0; element_id_1 < number_of_elements(); ++element_id_1) {
-        neighbors.clear();
-        for (SetId set_id: element(element_id_1).sets)
-            for (ElementId element_id_2: set(set_id).elements)
-                if (element_id_2 != element_id_1)
-                    neighbors.add(element_id_2);
-        for (ElementId element_id_2: neighbors)
-            element_neighbors_[element_id_1].push_back(element_id_2);
+    if (!table.computed) {
+        compute_neighbors_table(
+                table,
+                number_of_indices,
+                number_of_neighbor_indices,
+                add_neighbors);
     }
+    if (table.cached) {
+        return IndexRange<Index>(
+                table.neighbors.data() + table.offsets[index],
+                table.neighbors.data() + table.offsets[index + 1]);
+    }
+    buffer.clear(number_of_neighbor_indices);
+    (this->*add_neighbors)(index, buffer);
+    return buffer.values();
 }
 
-void Instance::compute_element_set_neighbors() const
+std::string InstanceFingerprint::to_string() const
 {
-    element_set_neighbors_ = std::vector<std::vector<SetId>>(number_of_elements());
-    const auto& set_neighbors = this->set_neighbors();
-    optimizationtools::IndexedSet neighbors(number_of_sets());
-    for (ElementId element_id = 0;
-            element_id < number_of_elements();
-            ++element_id) {
-        neighbors.clear();
-        for (SetId set_id: element(element_id).sets) {
-            neighbors.add(set_id);
-            for (SetId set_id_2: set_neighbors[set_id])
-                neighbors.add(set_id_2);
-        }
-        for (SetId set_id: neighbors)
-            element_set_neighbors_[element_id].push_back(set_id);
+    char buffer[33];
+    snprintf(
+            buffer,
+            sizeof(buffer),
+            "%016llx%016llx",
+            (unsigned long long)high,
+            (unsigned long long)low);
+    return buffer;
+}
+
+namespace
+{
+
+/** Mix the bits of a 64-bit integer (finalizer of SplitMix64). */
+inline uint64_t fingerprint_mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111eb;
+    x ^= x >> 31;
+    return x;
+}
+
+}
+
+const InstanceFingerprint& Instance::fingerprint() const
+{
+    if (fingerprint_computed_)
+        return fingerprint_;
+
+    // Each set and each arc contributes a hash which only depends on its
+    // content. The contributions are summed, so that the result doesn't
+    // depend on the order in which they are visited.
+    Counter number_of_threads = (number_of_arcs() >= (1 << 16))?
+        (std::max)((Counter)1, number_of_threads_):
+        1;
+    std::vector<InstanceFingerprint> sums(number_of_threads);
+    std::vector<std::thread> threads;
+
+    // Split the sets so that each thread gets about the same number of arcs.
+    std::vector<SetId> set_bounds(number_of_threads + 1, number_of_sets());
+    set_bounds[0] = 0;
+    for (Counter thread_id = 1; thread_id < number_of_threads; ++thread_id) {
+        set_bounds[thread_id] = std::upper_bound(
+                set_elements_offsets_.begin(),
+                set_elements_offsets_.end() - 1,
+                (ElementPos)(thread_id * (int64_t)number_of_arcs() / number_of_threads))
+            - set_elements_offsets_.begin();
     }
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([this, &sums, &set_bounds, thread_id]()
+        {
+            InstanceFingerprint sum;
+            for (SetId set_id = set_bounds[thread_id];
+                    set_id < set_bounds[thread_id + 1];
+                    ++set_id) {
+                uint64_t set_hash_high = fingerprint_mix((uint64_t)set_id + 0x9e3779b97f4a7c15);
+                uint64_t set_hash_low = fingerprint_mix((uint64_t)set_id ^ 0x2545f4914f6cdd1d);
+                uint64_t cost_hash = fingerprint_mix((uint64_t)set_costs_[set_id] ^ 0xd6e8feb86659fd93);
+                sum.high += fingerprint_mix(set_hash_high ^ cost_hash);
+                sum.low += fingerprint_mix(set_hash_low ^ cost_hash);
+                for (ElementPos pos = set_elements_offsets_[set_id];
+                        pos < set_elements_offsets_[set_id + 1];
+                        ++pos) {
+                    uint64_t element_id = set_elements_[pos];
+                    sum.high += fingerprint_mix(set_hash_high + element_id * 0xc2b2ae3d27d4eb4f);
+                    sum.low += fingerprint_mix(set_hash_low + element_id * 0x165667b19e3779f9);
+                }
+            }
+            sums[thread_id] = sum;
+        }));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+
+    InstanceFingerprint sum;
+    for (const InstanceFingerprint& thread_sum: sums) {
+        sum.high += thread_sum.high;
+        sum.low += thread_sum.low;
+    }
+    fingerprint_.high = fingerprint_mix(
+            fingerprint_mix(sum.high + (uint64_t)number_of_sets())
+            ^ (uint64_t)number_of_elements());
+    fingerprint_.low = fingerprint_mix(
+            fingerprint_mix(sum.low ^ (uint64_t)number_of_sets())
+            + (uint64_t)number_of_elements() * 0x9e3779b97f4a7c15);
+    fingerprint_computed_ = true;
+    return fingerprint_;
+}
+
+nlohmann::json Instance::to_json() const
+{
+    return nlohmann::json {
+        {"NumberOfElements", number_of_elements()},
+        {"NumberOfSets", number_of_sets()},
+        {"NumberOfArcs", number_of_arcs()},
+        {"NumberOfComponents", number_of_components()},
+        {"TotalCost", total_cost()},
+        {"Fingerprint", fingerprint().to_string()},
+    };
 }
 
 void Instance::write(
         const std::string& instance_path,
         const std::string& format) const
 {
-    std::ofstream file(instance_path);
+    std::ios_base::openmode mode = std::ios::out;
+    if (format == "binary")
+        mode |= std::ios::binary;
+    std::ofstream file(instance_path, mode);
     if (!file.good()) {
         throw std::runtime_error(
                 "Unable to open file \"" + instance_path + "\".");
@@ -118,6 +357,8 @@ void Instance::write(
         //write_faster1994(file);
     } else if (format == "dimacs2010_vc") {
         write_dimacs2010_vc(file);
+    } else if (format == "binary") {
+        write_binary(file);
     } else {
         throw std::invalid_argument(
                 "Unknown instance format \"" + format + "\".");
@@ -179,9 +420,59 @@ void Instance::write_dimacs2010_vc(std::ofstream& file) const
     }
 }
 
+namespace
+{
+
+/** Write an array in 'binary' format, padded to a multiple of 8 bytes. */
+template <typename T>
+void write_binary_array(
+        std::ostream& file,
+        const std::vector<T>& values)
+{
+    size_t size = values.size() * sizeof(T);
+    file.write((const char*)values.data(), size);
+    const char padding[8] = {};
+    file.write(padding, (8 - size % 8) % 8);
+}
+
+}
+
+void Instance::write_binary(std::ostream& file) const
+{
+    // Header. The magic number also allows detecting a file written on a
+    // platform with a different byte order.
+    std::vector<uint64_t> header = {
+        binary_magic_number,
+        binary_version,
+        sizeof(Index),
+        (uint64_t)number_of_sets(),
+        (uint64_t)number_of_elements(),
+        (uint64_t)number_of_arcs(),
+        (uint64_t)number_of_components(),
+        (uint64_t)component_sets_.size(),
+        (uint64_t)renumbered()};
+    write_binary_array(file, header);
+
+    write_binary_array(file, set_costs_);
+    write_binary_array(file, set_components_);
+    write_binary_array(file, set_elements_offsets_);
+    write_binary_array(file, set_elements_);
+    write_binary_array(file, element_components_);
+    write_binary_array(file, element_sets_offsets_);
+    write_binary_array(file, element_sets_);
+    write_binary_array(file, component_elements_offsets_);
+    write_binary_array(file, component_elements_);
+    write_binary_array(file, component_sets_offsets_);
+    write_binary_array(file, component_sets_);
+    if (renumbered()) {
+        write_binary_array(file, original_set_ids_);
+        write_binary_array(file, original_element_ids_);
+    }
+}
+
 double Instance::compute_average_number_of_set_neighbors_estimate() const
 {
-    SetPos number_of_set_neighbors_estimate = 0;
+    Counter number_of_set_neighbors_estimate = 0;
     for (ElementId element_id = 0;
             element_id < this->number_of_elements();
             ++element_id) {
@@ -193,7 +484,7 @@ double Instance::compute_average_number_of_set_neighbors_estimate() const
 
 double Instance::compute_average_number_of_element_neighbors_estimate() const
 {
-    ElementPos number_of_element_neighbors_estimate = 0;
+    Counter number_of_element_neighbors_estimate = 0;
     for (SetId set_id = 0;
             set_id < this->number_of_sets();
             ++set_id) {
@@ -218,6 +509,7 @@ void Instance::format(
             << "Average number of elt. neighbors estimate:    " << compute_average_number_of_element_neighbors_estimate() << std::endl
             << "Total cost:                                   " << total_cost() << std::endl
             << "Number of connected components:               " << number_of_components() << std::endl
+            << "Fingerprint:                                  " << fingerprint().to_string() << std::endl
             ;
     }
 
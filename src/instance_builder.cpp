@@ -2,7 +2,12 @@
 
 #include "optimizationtools/utils/utils.hpp"
 
-#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <thread>
 
 using namespace setcoveringsolver;
 
@@ -12,46 +17,140 @@ void InstanceBuilder::move(
         ElementId new_number_of_elements)
 {
     instance_ = std::move(instance);
-    for (SetId set_id = 0;
-            set_id < instance_.number_of_sets();
-            ++set_id) {
-        instance_.sets_[set_id].elements.clear();
-        instance_.sets_[set_id].cost = 1;
-        instance_.sets_[set_id].component = -1;
-    }
-    instance_.sets_.resize(new_number_of_sets);
-    for (ElementId element_id = 0;
-            element_id < instance_.number_of_elements();
-            ++element_id) {
-        instance_.elements_[element_id].sets.clear();
-        instance_.elements_[element_id].component = -1;
-    }
-    instance_.elements_.resize(new_number_of_elements);
+    instance_.set_costs_.assign(new_number_of_sets, 1);
+    instance_.set_components_.assign(new_number_of_sets, -1);
+    instance_.element_components_.assign(new_number_of_elements, -1);
+    instance_.set_elements_offsets_.clear();
+    instance_.set_elements_.clear();
+    instance_.element_sets_offsets_.clear();
+    instance_.element_sets_.clear();
     instance_.total_cost_ = 0;
     instance_.number_of_arcs_ = 0;
-    instance_.components_.clear();
-    instance_.element_neighbors_.clear();
-    instance_.set_neighbors_.clear();
+    instance_.number_of_components_ = 0;
+    instance_.component_elements_offsets_.clear();
+    instance_.component_elements_.clear();
+    instance_.component_sets_offsets_.clear();
+    instance_.component_sets_.clear();
+    instance_.original_set_ids_.clear();
+    instance_.renumbered_set_ids_.clear();
+    instance_.original_element_ids_.clear();
+    instance_.set_neighbors_ = Instance::NeighborsTable();
+    instance_.element_neighbors_ = Instance::NeighborsTable();
+    instance_.element_set_neighbors_ = Instance::NeighborsTable();
+    instance_.fingerprint_computed_ = false;
+    arcs_set_ids_.clear();
+    arcs_element_ids_.clear();
 }
 
 void InstanceBuilder::add_sets(SetId number_of_sets)
 {
-    instance_.sets_.insert(instance_.sets_.end(), number_of_sets, Set());
+    if (number_of_sets < 0) {
+        throw std::invalid_argument(
+                "setcoveringsolver::InstanceBuilder::add_sets: "
+                "negative number of sets; "
+                "number_of_sets: " + std::to_string(number_of_sets) + ".");
+    }
+    if ((int64_t)instance_.number_of_sets() + number_of_sets
+            > std::numeric_limits<SetId>::max()) {
+        throw std::overflow_error(
+                "setcoveringsolver::InstanceBuilder::add_sets: "
+                "too many sets for the index type; "
+                "number_of_sets: " + std::to_string(
+                    (int64_t)instance_.number_of_sets() + number_of_sets) + ".");
+    }
+    instance_.set_costs_.insert(
+            instance_.set_costs_.end(),
+            number_of_sets,
+            1);
+    instance_.set_components_.insert(
+            instance_.set_components_.end(),
+            number_of_sets,
+            -1);
 }
 
 void InstanceBuilder::add_elements(ElementId number_of_elements)
 {
-    instance_.elements_.insert(
-            instance_.elements_.end(),
+    if (number_of_elements < 0) {
+        throw std::invalid_argument(
+                "setcoveringsolver::InstanceBuilder::add_elements: "
+                "negative number of elements; "
+                "number_of_elements: " + std::to_string(number_of_elements) + ".");
+    }
+    if ((int64_t)instance_.number_of_elements() + number_of_elements
+            > std::numeric_limits<ElementId>::max()) {
+        throw std::overflow_error(
+                "setcoveringsolver::InstanceBuilder::add_elements: "
+                "too many elements for the index type; "
+                "number_of_elements: " + std::to_string(
+                    (int64_t)instance_.number_of_elements() + number_of_elements) + ".");
+    }
+    instance_.element_components_.insert(
+            instance_.element_components_.end(),
             number_of_elements,
-            Element());
+            -1);
 }
 
 void InstanceBuilder::set_cost(
         SetId set_id,
         Cost cost)
 {
-    instance_.sets_[set_id].cost = cost;
+    instance_.set_costs_[set_id] = cost;
+}
+
+void InstanceBuilder::reserve_arcs(ElementPos number_of_arcs)
+{
+    arcs_set_ids_.reserve(number_of_arcs);
+    arcs_element_ids_.reserve(number_of_arcs);
+}
+
+void InstanceBuilder::add_arcs(
+        std::vector<SetId>&& set_ids,
+        std::vector<ElementId>&& element_ids)
+{
+    if (set_ids.size() != element_ids.size()) {
+        throw std::invalid_argument(
+                "setcoveringsolver::InstanceBuilder::add_arcs: "
+                "arrays of different sizes; "
+                "set_ids.size(): " + std::to_string(set_ids.size()) + "; "
+                "element_ids.size(): " + std::to_string(element_ids.size()) + ".");
+    }
+    if (arcs_set_ids_.empty()) {
+        arcs_set_ids_ = std::move(set_ids);
+        arcs_element_ids_ = std::move(element_ids);
+    } else {
+        arcs_set_ids_.insert(arcs_set_ids_.end(), set_ids.begin(), set_ids.end());
+        arcs_element_ids_.insert(arcs_element_ids_.end(), element_ids.begin(), element_ids.end());
+    }
+}
+
+void InstanceBuilder::set_numbers_of_elements(
+        const std::vector<ElementPos>& numbers_of_elements)
+{
+    if ((SetId)numbers_of_elements.size() != instance_.number_of_sets()) {
+        throw std::invalid_argument(
+                "setcoveringsolver::InstanceBuilder::set_numbers_of_elements: "
+                "wrong number of sets; "
+                "numbers_of_elements.size(): " + std::to_string(numbers_of_elements.size()) + "; "
+                "number_of_sets: " + std::to_string(instance_.number_of_sets()) + ".");
+    }
+    if (!arcs_set_ids_.empty()) {
+        throw std::logic_error(
+                "setcoveringsolver::InstanceBuilder::set_numbers_of_elements: "
+                "arcs already added with 'add_arc' or 'add_arcs'; "
+                "number_of_arcs_added: " + std::to_string(arcs_set_ids_.size()) + ".");
+    }
+    std::vector<ElementPos>& set_offsets = instance_.set_elements_offsets_;
+    set_offsets.resize(instance_.number_of_sets() + 1);
+    set_offsets[0] = 0;
+    for (SetId set_id = 0; set_id < instance_.number_of_sets(); ++set_id) {
+        if (numbers_of_elements[set_id] > std::numeric_limits<ElementPos>::max() - set_offsets[set_id]) {
+            throw std::overflow_error(
+                    "setcoveringsolver::InstanceBuilder::set_numbers_of_elements: "
+                    "too many arcs for the index type.");
+        }
+        set_offsets[set_id + 1] = set_offsets[set_id] + numbers_of_elements[set_id];
+    }
+    instance_.set_elements_.resize(set_offsets.back());
 }
 
 void InstanceBuilder::set_unicost()
@@ -60,52 +159,110 @@ void InstanceBuilder::set_unicost()
         set_cost(set_id, 1);
 }
 
+void InstanceBuilder::set_renumbering(const std::string& renumbering)
+{
+    if (renumbering != ""
+            && renumbering != "bfs"
+            && renumbering != "degree") {
+        throw std::invalid_argument(
+                "Unknown renumbering \"" + renumbering + "\".");
+    }
+    renumbering_ = renumbering;
+}
+
 void InstanceBuilder::read(
         const std::string& instance_path,
         const std::string& format)
 {
-    std::ifstream file(instance_path);
-    if (!file.good()) {
-        throw std::runtime_error(
-                "Unable to open file \"" + instance_path + "\".");
+    instance_path_ = instance_path;
+    MappedFile file(instance_path);
+
+    // Compressed files are decompressed on the fly and parsed sequentially.
+    CompressionFormat compression_format = detect_compression_format(
+            file.data(),
+            file.size());
+    if (compression_format != CompressionFormat::None) {
+        if (format == "binary") {
+            throw std::invalid_argument(
+                    "setcoveringsolver::InstanceBuilder::read: "
+                    "compressed files in binary format are not supported.");
+        }
+        DecompressingSource source(
+                file.data(),
+                file.size(),
+                compression_format);
+        Tokenizer tokenizer(source);
+        read(tokenizer, format);
+        return;
+    }
+
+    if (format == "pace2025"
+            || format == "pace2025_ds"
+            || format == "dimacs2010_vc") {
+        read_chunks(file, format);
+        return;
+    }
+    if (format == "binary") {
+        read_binary(file.data(), file.size());
+        return;
     }
 
+    Tokenizer tokenizer(file.data(), file.data() + file.size());
+    read(tokenizer, format);
+}
+
+void InstanceBuilder::read(
+        Tokenizer& tokenizer,
+        const std::string& format)
+{
     if (format == "gecco2020" || format == "gecco") {
-        read_geccod2020(file);
+        read_geccod2020(tokenizer);
     } else if (format == "fulkerson1974" || format == "sts") {
-        read_fulkerson1974(file);
+        read_fulkerson1974(tokenizer);
     } else if (format == "balas1980" || format == "orlibrary") {
-        read_balas1980(file);
+        read_balas1980(tokenizer);
     } else if (format == "balas1996") {
-        read_balas1996(file);
+        read_balas1996(tokenizer);
     } else if (format == "faster1994"
             || format == "faster"
             || format == "wedelin1995"
             || format == "wedelin") {
-        read_faster1994(file);
+        read_faster1994(tokenizer);
     } else if (format == "pace2019_vc") {
-        FILE* file = fopen(instance_path.c_str(), "r");
-        read_pace2019_vc(file);
+        read_pace2019_vc(tokenizer);
     } else if (format == "pace2025") {
-        FILE* file = fopen(instance_path.c_str(), "r");
-        read_pace2025(file);
+        read_pace2025(tokenizer);
     } else if (format == "pace2025_ds") {
-        FILE* file = fopen(instance_path.c_str(), "r");
-        read_pace2025_ds(file);
+        read_pace2025_ds(tokenizer);
     } else if (format == "dimacs2010_vc") {
-        FILE* file = fopen(instance_path.c_str(), "r");
-        read_dimacs2010_vc(file);
+        read_dimacs2010_vc(tokenizer);
     } else {
         throw std::invalid_argument(
                 "Unknown instance format \"" + format + "\".");
     }
 }
 
-void InstanceBuilder::read_geccod2020(std::ifstream& file)
+template <typename T>
+void InstanceBuilder::read_int(
+        Tokenizer& tokenizer,
+        T& x,
+        const std::string& format)
 {
-    ElementId number_of_elements;
-    SetId number_of_sets;
-    file >> number_of_elements >> number_of_sets;
+    if (!tokenizer.read_int(x)) {
+        throw std::runtime_error(
+                "setcoveringsolver::InstanceBuilder::read: "
+                "truncated file; "
+                "instance_path: \"" + instance_path_ + "\"; "
+                "format: \"" + format + "\".");
+    }
+}
+
+void InstanceBuilder::read_geccod2020(Tokenizer& tokenizer)
+{
+    ElementId number_of_elements = 0;
+    SetId number_of_sets = 0;
+    read_int(tokenizer, number_of_elements, "gecco2020");
+    read_int(tokenizer, number_of_sets, "gecco2020");
 
     add_elements(number_of_elements);
     add_sets(number_of_sets);
@@ -113,25 +270,27 @@ void InstanceBuilder::read_geccod2020(std::ifstream& file)
     for (SetId set_id = 0; set_id < number_of_sets; ++set_id)
         set_cost(set_id, 1);
 
-    ElementId element_id_tmp;
-    SetId element_number_of_sets;
-    SetId set_id;
+    ElementId element_id_tmp = 0;
+    SetId element_number_of_sets = 0;
+    SetId set_id = 0;
     for (ElementId element_id = 0;
             element_id < number_of_elements;
             ++element_id) {
-        file >> element_id_tmp >> element_number_of_sets;
+        read_int(tokenizer, element_id_tmp, "gecco2020");
+        read_int(tokenizer, element_number_of_sets, "gecco2020");
         for (SetPos set_pos = 0; set_pos < element_number_of_sets; ++set_pos) {
-            file >> set_id;
+            read_int(tokenizer, set_id, "gecco2020");
             add_arc(set_id, element_id);
         }
     }
 }
 
-void InstanceBuilder::read_fulkerson1974(std::ifstream& file)
+void InstanceBuilder::read_fulkerson1974(Tokenizer& tokenizer)
 {
-    SetId number_of_sets;
-    ElementId number_of_elements;
-    file >> number_of_sets >> number_of_elements;
+    SetId number_of_sets = 0;
+    ElementId number_of_elements = 0;
+    read_int(tokenizer, number_of_sets, "fulkerson1974");
+    read_int(tokenizer, number_of_elements, "fulkerson1974");
 
     add_elements(number_of_elements);
     add_sets(number_of_sets);
@@ -139,194 +298,129 @@ void InstanceBuilder::read_fulkerson1974(std::ifstream& file)
     for (SetId set_id = 0; set_id < number_of_sets; ++set_id)
         set_cost(set_id, 1);
 
-    SetId set_id;
+    SetId set_id = 0;
     for (ElementId element_id = 0;
             element_id < number_of_elements;
             ++element_id) {
         for (SetPos set_pos = 0; set_pos < 3; ++set_pos) {
-            file >> set_id;
+            read_int(tokenizer, set_id, "fulkerson1974");
             add_arc(set_id - 1, element_id);
         }
     }
 }
 
-void InstanceBuilder::read_balas1980(std::ifstream& file)
+void InstanceBuilder::read_balas1980(Tokenizer& tokenizer)
 {
-    ElementId number_of_elements;
-    SetId number_of_sets;
-    file >> number_of_elements >> number_of_sets;
+    ElementId number_of_elements = 0;
+    SetId number_of_sets = 0;
+    read_int(tokenizer, number_of_elements, "balas1980");
+    read_int(tokenizer, number_of_sets, "balas1980");
 
     add_elements(number_of_elements);
     add_sets(number_of_sets);
 
-    Cost cost;
+    Cost cost = 0;
     for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
-        file >> cost;
+        read_int(tokenizer, cost, "balas1980");
         set_cost(set_id, cost);
     }
 
-    SetId set_id;
-    SetId element_number_of_sets;
+    SetId set_id = 0;
+    SetId element_number_of_sets = 0;
     for (ElementId element_id = 0;
             element_id < number_of_elements;
             ++element_id) {
-        file >> element_number_of_sets;
+        read_int(tokenizer, element_number_of_sets, "balas1980");
         for (SetPos set_pos = 0; set_pos < element_number_of_sets; ++set_pos) {
-            file >> set_id;
+            read_int(tokenizer, set_id, "balas1980");
             add_arc(set_id - 1, element_id);
         }
     }
 }
 
-void InstanceBuilder::read_balas1996(std::ifstream& file)
+void InstanceBuilder::read_balas1996(Tokenizer& tokenizer)
 {
-    SetId number_of_sets;
-    ElementId number_of_elements;
-    file >> number_of_sets >> number_of_elements;
+    SetId number_of_sets = 0;
+    ElementId number_of_elements = 0;
+    read_int(tokenizer, number_of_sets, "balas1996");
+    read_int(tokenizer, number_of_elements, "balas1996");
 
     add_elements(number_of_elements);
     add_sets(number_of_sets);
 
-    Cost cost;
+    Cost cost = 0;
     for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
-        file >> cost;
+        read_int(tokenizer, cost, "balas1996");
         set_cost(set_id, cost);
     }
 
-    ElementId element_id;
-    ElementId set_number_of_elements;
+    ElementId element_id = 0;
+    ElementId set_number_of_elements = 0;
     for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
-        file >> set_number_of_elements;
+        read_int(tokenizer, set_number_of_elements, "balas1996");
         for (ElementPos element_pos = 0;
                 element_pos < set_number_of_elements;
                 ++element_pos) {
-            file >> element_id;
-            element_id--;
+            read_int(tokenizer, element_id, "balas1996");
             add_arc(set_id, element_id - 1);
         }
     }
 }
 
-void InstanceBuilder::read_faster1994(std::ifstream& file)
+void InstanceBuilder::read_faster1994(Tokenizer& tokenizer)
 {
-    ElementId number_of_elements;
-    SetId number_of_sets;
-    file >> number_of_elements >> number_of_sets;
+    ElementId number_of_elements = 0;
+    SetId number_of_sets = 0;
+    read_int(tokenizer, number_of_elements, "faster1994");
+    read_int(tokenizer, number_of_sets, "faster1994");
 
     add_elements(number_of_elements);
     add_sets(number_of_sets);
 
-    Cost cost;
-    ElementId element_id;
-    ElementId set_number_of_elements;
+    Cost cost = 0;
+    ElementId element_id = 0;
+    ElementId set_number_of_elements = 0;
     for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
-        file >> cost >> set_number_of_elements;
+        read_int(tokenizer, cost, "faster1994");
+        read_int(tokenizer, set_number_of_elements, "faster1994");
         set_cost(set_id, cost);
         for (ElementPos element_pos = 0;
                 element_pos < set_number_of_elements;
                 ++element_pos) {
-            file >> element_id;
+            read_int(tokenizer, element_id, "faster1994");
             add_arc(set_id, element_id - 1);
         }
     }
 }
 
-inline char peek_char(
-        FILE* file,
-        char* buf,
-        size_t BUF_SIZE,
-        size_t& buf_pos,
-        size_t& buf_len)
-{
-    if (buf_pos >= buf_len) {
-        buf_len = fread(buf, 1, BUF_SIZE, file);
-        buf_pos = 0;
-        if (buf_len == 0) return EOF;
-    }
-    return buf[buf_pos];
-}
-
-inline char get_char(
-        FILE* file,
-        char* buf,
-        size_t BUF_SIZE,
-        size_t& buf_pos,
-        size_t& buf_len)
-{
-    if (buf_pos >= buf_len) {
-        buf_len = fread(buf, 1, BUF_SIZE, file);
-        buf_pos = 0;
-        if (buf_len == 0) return EOF;
-    }
-    return buf[buf_pos++];
-}
-
-inline void skip_line(
-        FILE* file,
-        char* buf,
-        size_t BUF_SIZE,
-        size_t& buf_pos,
-        size_t& buf_len)
-{
-    char c;
-    while ((c = get_char(file, buf, BUF_SIZE, buf_pos, buf_len)) != '\n' && c != EOF) {}
-}
-
-inline bool read_next_int_on_line(
-        FILE* file,
-        char* buf,
-        size_t BUF_SIZE,
-        size_t& buf_pos,
-        size_t& buf_len,
-        int64_t &x)
+void InstanceBuilder::read_pace2019_vc(FILE* file)
 {
-    x = 0;
-    char c;
-
-    // Skip non-digit characters
-    do {
-        c = get_char(file, buf, BUF_SIZE, buf_pos, buf_len);
-        if (c == '\n' || c == EOF) return false;
-    } while (c < '0' || c > '9');
-
-    // Parse integer
-    do {
-        x = x * 10 + (c - '0');
-        c = get_char(file, buf, BUF_SIZE, buf_pos, buf_len);
-    } while (c >= '0' && c <= '9');
-
-    // If we hit newline, we’ve reached the end of the line
-    if (c == '\n') buf_pos--; // allow outer loop to see the newline
-    return true;
+    FileSource source(file);
+    Tokenizer tokenizer(source);
+    read_pace2019_vc(tokenizer);
 }
 
-void InstanceBuilder::read_pace2019_vc(FILE* file)
+void InstanceBuilder::read_pace2019_vc(Tokenizer& tokenizer)
 {
-    const size_t BUF_SIZE = 1 << 21;
-    char buf[BUF_SIZE];
-    size_t buf_pos = 0;
-    size_t buf_len = 0;
-
-    // Skip lines until we find the problem line: p ds <vertices> <edges>
-    char c;
     SetId set_id_1 = -1;
     SetId set_id_2 = -1;
     ElementId element_id = 0;
-    while ((c = peek_char(file, buf, BUF_SIZE, buf_pos, buf_len)) != EOF) {
+    while (!tokenizer.eof()) {
+        char c = tokenizer.peek();
         if (c == 'c') {
-            skip_line(file, buf, BUF_SIZE, buf_pos, buf_len);
+            tokenizer.skip_line();
         } else if (c == 'p') {
             SetId number_of_vertices = -1;
-            SetId number_of_edges = -1;
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, number_of_vertices);
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, number_of_edges);
+            ElementId number_of_edges = -1;
+            tokenizer.read_int_on_line(number_of_vertices);
+            tokenizer.read_int_on_line(number_of_edges);
             add_elements(number_of_edges);
             add_sets(number_of_vertices);
-            skip_line(file, buf, BUF_SIZE, buf_pos, buf_len);
+            tokenizer.skip_line();
         } else {
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, set_id_1);
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, set_id_2);
-            skip_line(file, buf, BUF_SIZE, buf_pos, buf_len);
+            tokenizer.read_int_on_line(set_id_1);
+            tokenizer.read_int_on_line(set_id_2);
+            tokenizer.skip_line();
             add_arc(set_id_1 - 1, element_id);
             add_arc(set_id_2 - 1, element_id);
             element_id++;
@@ -336,28 +430,29 @@ void InstanceBuilder::read_pace2019_vc(FILE* file)
 
 void InstanceBuilder::read_pace2025(FILE* file)
 {
-    const size_t BUF_SIZE = 1 << 21;
-    char buf[BUF_SIZE];
-    size_t buf_pos = 0;
-    size_t buf_len = 0;
+    FileSource source(file);
+    Tokenizer tokenizer(source);
+    read_pace2025(tokenizer);
+}
 
-    // Skip lines until we find the problem line: p ds <vertices> <edges>
-    char c;
+void InstanceBuilder::read_pace2025(Tokenizer& tokenizer)
+{
     SetId set_id = -1;
     ElementId element_id = 0;
-    while ((c = peek_char(file, buf, BUF_SIZE, buf_pos, buf_len)) != EOF) {
+    while (!tokenizer.eof()) {
+        char c = tokenizer.peek();
         if (c == 'c') {
-            skip_line(file, buf, BUF_SIZE, buf_pos, buf_len);
+            tokenizer.skip_line();
         } else if (c == 'p') {
             SetId number_of_sets = -1;
-            SetId number_of_elements = -1;
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, number_of_sets);
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, number_of_elements);
+            ElementId number_of_elements = -1;
+            tokenizer.read_int_on_line(number_of_sets);
+            tokenizer.read_int_on_line(number_of_elements);
             add_elements(number_of_elements);
             add_sets(number_of_sets);
-            skip_line(file, buf, BUF_SIZE, buf_pos, buf_len);
+            tokenizer.skip_line();
         } else {
-            while (read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, set_id))
+            while (tokenizer.read_int_on_line(set_id))
                 add_arc(set_id - 1, element_id);
             element_id++;
         }
@@ -366,32 +461,33 @@ void InstanceBuilder::read_pace2025(FILE* file)
 
 void InstanceBuilder::read_pace2025_ds(FILE* file)
 {
-    const size_t BUF_SIZE = 1 << 21;
-    char buf[BUF_SIZE];
-    size_t buf_pos = 0;
-    size_t buf_len = 0;
+    FileSource source(file);
+    Tokenizer tokenizer(source);
+    read_pace2025_ds(tokenizer);
+}
 
-    // Skip lines until we find the problem line: p ds <vertices> <edges>
-    char c;
+void InstanceBuilder::read_pace2025_ds(Tokenizer& tokenizer)
+{
     SetId set_id_1 = -1;
     SetId set_id_2 = -1;
-    while ((c = peek_char(file, buf, BUF_SIZE, buf_pos, buf_len)) != EOF) {
+    while (!tokenizer.eof()) {
+        char c = tokenizer.peek();
         if (c == 'c') {
-            skip_line(file, buf, BUF_SIZE, buf_pos, buf_len);
+            tokenizer.skip_line();
         } else if (c == 'p') {
             SetId number_of_vertices = -1;
             SetId number_of_edges = -1;
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, number_of_vertices);
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, number_of_edges);
+            tokenizer.read_int_on_line(number_of_vertices);
+            tokenizer.read_int_on_line(number_of_edges);
             add_elements(number_of_vertices);
             add_sets(number_of_vertices);
             for (SetId set_id = 0; set_id < number_of_vertices; ++set_id)
                 add_arc(set_id, set_id);
-            skip_line(file, buf, BUF_SIZE, buf_pos, buf_len);
+            tokenizer.skip_line();
         } else {
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, set_id_1);
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, set_id_2);
-            skip_line(file, buf, BUF_SIZE, buf_pos, buf_len);
+            tokenizer.read_int_on_line(set_id_1);
+            tokenizer.read_int_on_line(set_id_2);
+            tokenizer.skip_line();
             add_arc(set_id_1 - 1, set_id_2 - 1);
             add_arc(set_id_2 - 1, set_id_1 - 1);
         }
@@ -400,31 +496,32 @@ void InstanceBuilder::read_pace2025_ds(FILE* file)
 
 void InstanceBuilder::read_dimacs2010_vc(FILE* file)
 {
-    const size_t BUF_SIZE = 1 << 21;
-    char buf[BUF_SIZE];
-    size_t buf_pos = 0;
-    size_t buf_len = 0;
+    FileSource source(file);
+    Tokenizer tokenizer(source);
+    read_dimacs2010_vc(tokenizer);
+}
 
-    // Skip lines until we find the problem line: p ds <vertices> <edges>
-    char c;
+void InstanceBuilder::read_dimacs2010_vc(Tokenizer& tokenizer)
+{
     SetId set_id_1 = 1;
     SetId set_id_2 = -1;
     ElementId element_id = 0;
     bool first = true;
-    while ((c = peek_char(file, buf, BUF_SIZE, buf_pos, buf_len)) != EOF) {
+    while (!tokenizer.eof()) {
         if (first) {
             first = false;
             SetId number_of_sets = -1;
             ElementId number_of_elements = -1;
             SetId tmp;
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, number_of_sets);
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, number_of_elements);
-            read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, tmp);
+            tokenizer.read_int_on_line(number_of_sets);
+            tokenizer.read_int_on_line(number_of_elements);
             add_elements(number_of_elements);
             add_sets(number_of_sets);
-            skip_line(file, buf, BUF_SIZE, buf_pos, buf_len);
+            // The format field is optional.
+            if (tokenizer.read_int_on_line(tmp))
+                tokenizer.skip_line();
         } else {
-            while (read_next_int_on_line(file, buf, BUF_SIZE, buf_pos, buf_len, set_id_2)) {
+            while (tokenizer.read_int_on_line(set_id_2)) {
                 if (set_id_2 > set_id_1) {
                     add_arc(set_id_1 - 1, element_id);
                     add_arc(set_id_2 - 1, element_id);
@@ -436,78 +533,1280 @@ void InstanceBuilder::read_dimacs2010_vc(FILE* file)
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////// Binary format ////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+/**
+ * Reader of the successive arrays of a file in 'binary' format.
+ */
+class BinaryReader
+{
+
+public:
+
+    /** Constructor. */
+    BinaryReader(
+            const char* begin,
+            const char* end):
+        position_(begin),
+        end_(end) { }
+
+    /** Return 'true' iff all the characters have been read. */
+    bool eof() const { return position_ == end_; }
+
+    /**
+     * Read an array of 'number_of_values' values stored on 'value_size'
+     * bytes each.
+     *
+     * If the size of the values in the file differs from the size of 'T', the
+     * values are converted.
+     */
+    template <typename T>
+    void read_array(
+            std::vector<T>& values,
+            uint64_t number_of_values,
+            uint64_t value_size,
+            const std::string& name)
+    {
+        uint64_t remaining_size = end_ - position_;
+        if (number_of_values > remaining_size / value_size) {
+            throw std::runtime_error(
+                    "setcoveringsolver::InstanceBuilder::read_binary: "
+                    "truncated file; "
+                    "array: " + name + ".");
+        }
+        uint64_t size = number_of_values * value_size;
+        values.resize(number_of_values);
+        if (value_size == sizeof(T)) {
+            memcpy(values.data(), position_, size);
+        } else if (value_size == sizeof(int32_t)) {
+            convert<int32_t>(values, name);
+        } else {
+            convert<int64_t>(values, name);
+        }
+        position_ += (std::min)(remaining_size, size + (8 - size % 8) % 8);
+    }
+
+private:
+
+    /** Pointer to the next character. */
+    const char* position_;
+
+    /** Pointer past the last character. */
+    const char* end_;
+
+    /** Convert the values of the next array from type 'U'. */
+    template <typename U, typename T>
+    void convert(
+            std::vector<T>& values,
+            const std::string& name)
+    {
+        for (size_t pos = 0; pos < values.size(); ++pos) {
+            U value;
+            memcpy(&value, position_ + pos * sizeof(U), sizeof(U));
+            if (value > std::numeric_limits<T>::max()
+                    || value < std::numeric_limits<T>::lowest()) {
+                throw std::overflow_error(
+                        "setcoveringsolver::InstanceBuilder::read_binary: "
+                        "value too large for the index type; "
+                        "array: " + name + "; "
+                        "value: " + std::to_string(value) + ".");
+            }
+            values[pos] = value;
+        }
+    }
+
+};
+
+/** Check that the offsets of a CSR array are consistent. */
+template <typename Pos>
+void check_binary_offsets(
+        const std::vector<Pos>& offsets,
+        uint64_t size,
+        const std::string& name)
+{
+    bool ok = (offsets.front() == 0 && (uint64_t)offsets.back() == size);
+    for (size_t pos = 1; ok && pos < offsets.size(); ++pos)
+        ok = (offsets[pos - 1] <= offsets[pos]);
+    if (!ok) {
+        throw std::runtime_error(
+                "setcoveringsolver::InstanceBuilder::read_binary: "
+                "invalid offsets; "
+                "array: " + name + ".");
+    }
+}
+
+/** Check that the ids of an array belong to [first, last). */
+template <typename Id>
+void check_binary_ids(
+        const std::vector<Id>& ids,
+        Id first,
+        Id last,
+        const std::string& name)
+{
+    for (Id id: ids) {
+        if (id < first || id >= last) {
+            throw std::runtime_error(
+                    "setcoveringsolver::InstanceBuilder::read_binary: "
+                    "invalid id; "
+                    "array: " + name + "; "
+                    "id: " + std::to_string(id) + ".");
+        }
+    }
+}
+
+/**
+ * Check that the sets of the elements are the transpose of the elements of
+ * the sets.
+ *
+ * The lists of the file may be in any order, so the transpose of the elements
+ * of the sets is computed and compared to them as multisets.
+ */
+void check_binary_transpose(const Instance& instance)
+{
+    std::vector<ElementPos> positions(instance.number_of_elements() + 1, 0);
+    for (SetId set_id = 0; set_id < instance.number_of_sets(); ++set_id)
+        for (ElementId element_id: instance.set(set_id).elements)
+            positions[element_id + 1]++;
+    for (ElementId element_id = 0;
+            element_id < instance.number_of_elements();
+            ++element_id) {
+        if (positions[element_id + 1] != (ElementPos)instance.element(element_id).sets.size()) {
+            throw std::runtime_error(
+                    "setcoveringsolver::InstanceBuilder::read_binary: "
+                    "inconsistent adjacency; "
+                    "element_id: " + std::to_string(element_id) + ".");
+        }
+        positions[element_id + 1] += positions[element_id];
+    }
+    std::vector<SetId> element_sets(positions[instance.number_of_elements()]);
+    for (SetId set_id = 0; set_id < instance.number_of_sets(); ++set_id)
+        for (ElementId element_id: instance.set(set_id).elements)
+            element_sets[positions[element_id]++] = set_id;
+
+    // After the loop above, 'positions[element_id]' is the end of the sets of
+    // element 'element_id'.
+    std::vector<SetPos> sets_counts(instance.number_of_sets(), 0);
+    ElementPos begin = 0;
+    for (ElementId element_id = 0;
+            element_id < instance.number_of_elements();
+            ++element_id) {
+        ElementPos end = positions[element_id];
+        for (ElementPos pos = begin; pos < end; ++pos)
+            sets_counts[element_sets[pos]]++;
+        bool ok = true;
+        for (SetId set_id: instance.element(element_id).sets) {
+            if (sets_counts[set_id] == 0)
+                ok = false;
+            sets_counts[set_id]--;
+        }
+        for (ElementPos pos = begin; pos < end; ++pos)
+            sets_counts[element_sets[pos]] = 0;
+        if (!ok) {
+            throw std::runtime_error(
+                    "setcoveringsolver::InstanceBuilder::read_binary: "
+                    "inconsistent adjacency; "
+                    "element_id: " + std::to_string(element_id) + ".");
+        }
+        begin = end;
+    }
+}
+
+/**
+ * Check that the components of the elements and of the sets are consistent
+ * with the arcs and with the lists of the components.
+ *
+ * A component which is the union of several connected components is still
+ * valid, since the algorithms only rely on the absence of arcs between
+ * components.
+ */
+void check_binary_components(const Instance& instance)
+{
+    auto error = [](const std::string& name)
+    {
+        return std::runtime_error(
+                "setcoveringsolver::InstanceBuilder::read_binary: "
+                "inconsistent components; "
+                "array: " + name + ".");
+    };
+
+    for (SetId set_id = 0; set_id < instance.number_of_sets(); ++set_id) {
+        const Set set = instance.set(set_id);
+        // Sets which don't cover any element don't belong to any component.
+        if ((set.component == -1) != (set.elements.size() == 0))
+            throw error("set_components");
+        for (ElementId element_id: set.elements)
+            if (instance.element(element_id).component != set.component)
+                throw error("element_components");
+    }
+
+    std::vector<uint8_t> elements_listed(instance.number_of_elements(), 0);
+    std::vector<uint8_t> sets_listed(instance.number_of_sets(), 0);
+    for (ComponentId component_id = 0;
+            component_id < instance.number_of_components();
+            ++component_id) {
+        const Component component = instance.component(component_id);
+        if (component.elements.size() == 0)
+            throw error("component_elements_offsets");
+        for (ElementId element_id: component.elements) {
+            if (elements_listed[element_id]
+                    || instance.element(element_id).component != component_id) {
+                throw error("component_elements");
+            }
+            elements_listed[element_id] = 1;
+        }
+        for (SetId set_id: component.sets) {
+            if (sets_listed[set_id]
+                    || instance.set(set_id).component != component_id) {
+                throw error("component_sets");
+            }
+            sets_listed[set_id] = 1;
+        }
+    }
+    // The elements are all listed, since there are as many listed elements as
+    // elements.
+    for (SetId set_id = 0; set_id < instance.number_of_sets(); ++set_id)
+        if (instance.set(set_id).component != -1 && !sets_listed[set_id])
+            throw error("component_sets");
+}
+
+}
+
+void InstanceBuilder::read_binary(
+        const char* data,
+        size_t size)
+{
+    // Read and check the header.
+    std::vector<uint64_t> header(9);
+    size_t header_size = header.size() * sizeof(uint64_t);
+    if (size < header_size) {
+        throw std::runtime_error(
+                "setcoveringsolver::InstanceBuilder::read_binary: "
+                "truncated file; "
+                "size: " + std::to_string(size) + ".");
+    }
+    memcpy(header.data(), data, header_size);
+    if (header[0] != Instance::binary_magic_number) {
+        throw std::runtime_error(
+                "setcoveringsolver::InstanceBuilder::read_binary: "
+                "not a file in binary format or written on a platform "
+                "with a different byte order.");
+    }
+    if (header[1] != Instance::binary_version) {
+        throw std::runtime_error(
+                "setcoveringsolver::InstanceBuilder::read_binary: "
+                "unsupported version; "
+                "version: " + std::to_string(header[1]) + "; "
+                "supported version: " + std::to_string(Instance::binary_version) + ".");
+    }
+    uint64_t index_size = header[2];
+    if (index_size != sizeof(int32_t) && index_size != sizeof(int64_t)) {
+        throw std::runtime_error(
+                "setcoveringsolver::InstanceBuilder::read_binary: "
+                "invalid index size; "
+                "index_size: " + std::to_string(index_size) + ".");
+    }
+    for (int pos = 3; pos < 8; ++pos) {
+        if (header[pos] >= (uint64_t)std::numeric_limits<Index>::max()) {
+            throw std::overflow_error(
+                    "setcoveringsolver::InstanceBuilder::read_binary: "
+                    "instance too large for the index type; "
+                    "value: " + std::to_string(header[pos]) + ".");
+        }
+    }
+    SetId number_of_sets = header[3];
+    ElementId number_of_elements = header[4];
+    ElementPos number_of_arcs = header[5];
+    ComponentId number_of_components = header[6];
+    SetPos number_of_component_sets = header[7];
+    bool renumbered = (header[8] != 0);
+
+    // Read the arrays.
+    BinaryReader reader(data + header_size, data + size);
+    Instance& instance = instance_;
+    reader.read_array(instance.set_costs_, number_of_sets, sizeof(Cost), "set_costs");
+    reader.read_array(instance.set_components_, number_of_sets, index_size, "set_components");
+    reader.read_array(instance.set_elements_offsets_, number_of_sets + 1, index_size, "set_elements_offsets");
+    reader.read_array(instance.set_elements_, number_of_arcs, index_size, "set_elements");
+    reader.read_array(instance.element_components_, number_of_elements, index_size, "element_components");
+    reader.read_array(instance.element_sets_offsets_, number_of_elements + 1, index_size, "element_sets_offsets");
+    reader.read_array(instance.element_sets_, number_of_arcs, index_size, "element_sets");
+    reader.read_array(instance.component_elements_offsets_, number_of_components + 1, index_size, "component_elements_offsets");
+    reader.read_array(instance.component_elements_, number_of_elements, index_size, "component_elements");
+    reader.read_array(instance.component_sets_offsets_, number_of_components + 1, index_size, "component_sets_offsets");
+    reader.read_array(instance.component_sets_, number_of_component_sets, index_size, "component_sets");
+    if (renumbered) {
+        reader.read_array(instance.original_set_ids_, number_of_sets, index_size, "original_set_ids");
+        reader.read_array(instance.original_element_ids_, number_of_elements, index_size, "original_element_ids");
+    }
+    if (!reader.eof()) {
+        throw std::runtime_error(
+                "setcoveringsolver::InstanceBuilder::read_binary: "
+                "unexpected data at the end of the file.");
+    }
+    instance.number_of_components_ = number_of_components;
+
+    // Check the arrays, so that the instance can be used safely.
+    check_binary_ids<ComponentId>(instance.set_components_, -1, number_of_components, "set_components");
+    check_binary_offsets(instance.set_elements_offsets_, number_of_arcs, "set_elements_offsets");
+    check_binary_ids<ElementId>(instance.set_elements_, 0, number_of_elements, "set_elements");
+    check_binary_ids<ComponentId>(instance.element_components_, 0, number_of_components, "element_components");
+    check_binary_offsets(instance.element_sets_offsets_, number_of_arcs, "element_sets_offsets");
+    check_binary_ids<SetId>(instance.element_sets_, 0, number_of_sets, "element_sets");
+    check_binary_offsets(instance.component_elements_offsets_, number_of_elements, "component_elements_offsets");
+    check_binary_ids<ElementId>(instance.component_elements_, 0, number_of_elements, "component_elements");
+    check_binary_offsets(instance.component_sets_offsets_, number_of_component_sets, "component_sets_offsets");
+    check_binary_ids<SetId>(instance.component_sets_, 0, number_of_sets, "component_sets");
+    check_binary_transpose(instance);
+    check_binary_components(instance);
+    if (renumbered) {
+        check_binary_ids<SetId>(instance.original_set_ids_, 0, number_of_sets, "original_set_ids");
+        check_binary_ids<ElementId>(instance.original_element_ids_, 0, number_of_elements, "original_element_ids");
+        instance.renumbered_set_ids_.assign(number_of_sets, -1);
+        for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
+            SetId original_set_id = instance.original_set_ids_[set_id];
+            if (instance.renumbered_set_ids_[original_set_id] != -1) {
+                throw std::runtime_error(
+                        "setcoveringsolver::InstanceBuilder::read_binary: "
+                        "invalid permutation; "
+                        "array: original_set_ids.");
+            }
+            instance.renumbered_set_ids_[original_set_id] = set_id;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//////////////////////////// Multi-threaded reading ////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Structure for the arcs read from a chunk of an instance file.
+ */
+struct ChunkArcs
+{
+    /** Sets of the arcs. */
+    std::vector<SetId> set_ids;
+
+    /**
+     * Elements of the arcs.
+     *
+     * For the formats in which elements are numbered in order of appearance,
+     * they are numbered from 0 in each chunk.
+     */
+    std::vector<ElementId> element_ids;
+
+    /** Number of elements numbered in the chunk. */
+    ElementId number_of_elements = 0;
+
+    /** Index of the first line of the chunk ('dimacs2010_vc' format only). */
+    SetId first_line = 0;
+
+    /** Exception thrown while reading the chunk. */
+    std::exception_ptr exception;
+};
+
+inline void read_chunk_pace2025(
+        const char* begin,
+        const char* end,
+        ChunkArcs& chunk)
+{
+    Tokenizer tokenizer(begin, end);
+    SetId set_id = -1;
+    while (!tokenizer.eof()) {
+        if (tokenizer.peek() == 'c') {
+            tokenizer.skip_line();
+        } else {
+            while (tokenizer.read_int_on_line(set_id)) {
+                chunk.set_ids.push_back(set_id - 1);
+                chunk.element_ids.push_back(chunk.number_of_elements);
+            }
+            chunk.number_of_elements++;
+        }
+    }
+}
+
+inline void read_chunk_pace2025_ds(
+        const char* begin,
+        const char* end,
+        ChunkArcs& chunk)
+{
+    Tokenizer tokenizer(begin, end);
+    SetId set_id_1 = -1;
+    SetId set_id_2 = -1;
+    while (!tokenizer.eof()) {
+        if (tokenizer.peek() == 'c') {
+            tokenizer.skip_line();
+        } else {
+            tokenizer.read_int_on_line(set_id_1);
+            tokenizer.read_int_on_line(set_id_2);
+            tokenizer.skip_line();
+            chunk.set_ids.push_back(set_id_1 - 1);
+            chunk.element_ids.push_back(set_id_2 - 1);
+            chunk.set_ids.push_back(set_id_2 - 1);
+            chunk.element_ids.push_back(set_id_1 - 1);
+        }
+    }
+}
+
+inline void read_chunk_dimacs2010_vc(
+        const char* begin,
+        const char* end,
+        ChunkArcs& chunk)
+{
+    Tokenizer tokenizer(begin, end);
+    SetId set_id_1 = chunk.first_line + 1;
+    SetId set_id_2 = -1;
+    while (!tokenizer.eof()) {
+        while (tokenizer.read_int_on_line(set_id_2)) {
+            if (set_id_2 > set_id_1) {
+                chunk.set_ids.push_back(set_id_1 - 1);
+                chunk.element_ids.push_back(chunk.number_of_elements);
+                chunk.set_ids.push_back(set_id_2 - 1);
+                chunk.element_ids.push_back(chunk.number_of_elements);
+                chunk.number_of_elements++;
+            }
+        }
+        set_id_1++;
+    }
+}
+
+inline void read_chunk(
+        const std::string& format,
+        const char* begin,
+        const char* end,
+        ChunkArcs& chunk)
+{
+    try {
+        if (format == "pace2025") {
+            read_chunk_pace2025(begin, end, chunk);
+        } else if (format == "pace2025_ds") {
+            read_chunk_pace2025_ds(begin, end, chunk);
+        } else {
+            read_chunk_dimacs2010_vc(begin, end, chunk);
+        }
+    } catch (...) {
+        chunk.exception = std::current_exception();
+    }
+}
+
+void InstanceBuilder::read_chunks(
+        const MappedFile& file,
+        const std::string& format)
+{
+    const char* end = file.data() + file.size();
+
+    // Read the header.
+    Tokenizer tokenizer(file.data(), end);
+    if (format == "pace2025") {
+        while (tokenizer.peek() == 'c')
+            tokenizer.skip_line();
+        if (tokenizer.peek() == 'p') {
+            SetId number_of_sets = -1;
+            ElementId number_of_elements = -1;
+            tokenizer.read_int_on_line(number_of_sets);
+            tokenizer.read_int_on_line(number_of_elements);
+            add_elements(number_of_elements);
+            add_sets(number_of_sets);
+            tokenizer.skip_line();
+        }
+    } else if (format == "pace2025_ds") {
+        while (tokenizer.peek() == 'c')
+            tokenizer.skip_line();
+        if (tokenizer.peek() == 'p') {
+            SetId number_of_vertices = -1;
+            SetId number_of_edges = -1;
+            tokenizer.read_int_on_line(number_of_vertices);
+            tokenizer.read_int_on_line(number_of_edges);
+            add_elements(number_of_vertices);
+            add_sets(number_of_vertices);
+            for (SetId set_id = 0; set_id < number_of_vertices; ++set_id)
+                add_arc(set_id, set_id);
+            tokenizer.skip_line();
+        }
+    } else {
+        SetId number_of_sets = -1;
+        ElementId number_of_elements = -1;
+        SetId tmp;
+        tokenizer.read_int_on_line(number_of_sets);
+        tokenizer.read_int_on_line(number_of_elements);
+        add_elements(number_of_elements);
+        add_sets(number_of_sets);
+        // The format field is optional.
+        if (tokenizer.read_int_on_line(tmp))
+            tokenizer.skip_line();
+    }
+    const char* begin = tokenizer.position();
+
+    // Split the rest of the file into line-aligned chunks. Small files are
+    // read by a single thread.
+    const ptrdiff_t minimum_chunk_size = 1 << 20;
+    Counter number_of_chunks = (std::max)((Counter)1, (std::min)(
+                number_of_threads_,
+                (Counter)((end - begin) / minimum_chunk_size)));
+    std::vector<const char*> chunk_begins(number_of_chunks + 1, end);
+    chunk_begins[0] = begin;
+    for (Counter chunk_id = 1; chunk_id < number_of_chunks; ++chunk_id) {
+        const char* position = (std::max)(
+                chunk_begins[chunk_id - 1],
+                begin + (end - begin) * chunk_id / number_of_chunks);
+        const char* line_end = (const char*)memchr(position, '\n', end - position);
+        chunk_begins[chunk_id] = (line_end == nullptr)? end: line_end + 1;
+    }
+
+    // In 'dimacs2010_vc' format, the set of a line is given by its index, so
+    // each chunk needs the index of its first line.
+    std::vector<ChunkArcs> chunks(number_of_chunks);
+    if (format == "dimacs2010_vc") {
+        std::vector<SetId> chunk_number_of_lines(number_of_chunks, 0);
+        std::vector<std::thread> threads;
+        for (Counter chunk_id = 0; chunk_id < number_of_chunks; ++chunk_id) {
+            threads.push_back(std::thread([&chunk_number_of_lines, &chunk_begins, chunk_id]()
+            {
+                chunk_number_of_lines[chunk_id] = std::count(
+                        chunk_begins[chunk_id],
+                        chunk_begins[chunk_id + 1],
+                        '\n');
+            }));
+        }
+        for (Counter chunk_id = 0; chunk_id < number_of_chunks; ++chunk_id)
+            threads[chunk_id].join();
+        for (Counter chunk_id = 1; chunk_id < number_of_chunks; ++chunk_id) {
+            chunks[chunk_id].first_line = chunks[chunk_id - 1].first_line
+                + chunk_number_of_lines[chunk_id - 1];
+        }
+    }
+
+    // Parse the chunks. The first chunk is appended directly to the arcs
+    // already added.
+    chunks[0].set_ids = std::move(arcs_set_ids_);
+    chunks[0].element_ids = std::move(arcs_element_ids_);
+    std::vector<std::thread> threads;
+    for (Counter chunk_id = 0; chunk_id < number_of_chunks; ++chunk_id) {
+        threads.push_back(std::thread(
+                    read_chunk,
+                    std::cref(format),
+                    chunk_begins[chunk_id],
+                    chunk_begins[chunk_id + 1],
+                    std::ref(chunks[chunk_id])));
+    }
+    for (Counter chunk_id = 0; chunk_id < number_of_chunks; ++chunk_id)
+        threads[chunk_id].join();
+    for (Counter chunk_id = 0; chunk_id < number_of_chunks; ++chunk_id)
+        if (chunks[chunk_id].exception)
+            std::rethrow_exception(chunks[chunk_id].exception);
+
+    arcs_set_ids_ = std::move(chunks[0].set_ids);
+    arcs_element_ids_ = std::move(chunks[0].element_ids);
+
+    // Compute the position of the arcs and the first element of each chunk.
+    std::vector<ElementPos> chunk_arc_offsets(number_of_chunks + 1);
+    std::vector<ElementId> chunk_element_offsets(number_of_chunks + 1);
+    chunk_arc_offsets[0] = 0;
+    chunk_arc_offsets[1] = arcs_set_ids_.size();
+    chunk_element_offsets[0] = 0;
+    chunk_element_offsets[1] = chunks[0].number_of_elements;
+    for (Counter chunk_id = 1; chunk_id < number_of_chunks; ++chunk_id) {
+        chunk_arc_offsets[chunk_id + 1] = chunk_arc_offsets[chunk_id]
+            + chunks[chunk_id].set_ids.size();
+        chunk_element_offsets[chunk_id + 1] = chunk_element_offsets[chunk_id]
+            + chunks[chunk_id].number_of_elements;
+    }
+
+    // Merge the arcs of the chunks.
+    arcs_set_ids_.resize(chunk_arc_offsets[number_of_chunks]);
+    arcs_element_ids_.resize(chunk_arc_offsets[number_of_chunks]);
+    threads.clear();
+    for (Counter chunk_id = 1; chunk_id < number_of_chunks; ++chunk_id) {
+        threads.push_back(std::thread([
+                this,
+                &chunks,
+                &chunk_arc_offsets,
+                &chunk_element_offsets,
+                chunk_id]()
+        {
+            ChunkArcs& chunk = chunks[chunk_id];
+            ElementPos arc_offset = chunk_arc_offsets[chunk_id];
+            ElementId element_offset = chunk_element_offsets[chunk_id];
+            for (ElementPos arc_pos = 0;
+                    arc_pos < (ElementPos)chunk.set_ids.size();
+                    ++arc_pos) {
+                arcs_set_ids_[arc_offset + arc_pos] = chunk.set_ids[arc_pos];
+                arcs_element_ids_[arc_offset + arc_pos] = chunk.element_ids[arc_pos] + element_offset;
+            }
+            chunk.set_ids = std::vector<SetId>();
+            chunk.element_ids = std::vector<ElementId>();
+        }));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////// Build /////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
+void InstanceBuilder::compute_adjacency()
+{
+    if (arcs_set_ids_.size() > (size_t)std::numeric_limits<ElementPos>::max()) {
+        throw std::overflow_error(
+                "setcoveringsolver::InstanceBuilder::build: "
+                "too many arcs for the index type; "
+                "number_of_arcs: " + std::to_string(arcs_set_ids_.size()) + ".");
+    }
+
+    // Count the number of elements of each set and the number of sets of
+    // each element.
+    std::vector<ElementPos>& set_offsets = instance_.set_elements_offsets_;
+    std::vector<SetPos>& element_offsets = instance_.element_sets_offsets_;
+    set_offsets.assign(instance_.number_of_sets() + 1, 0);
+    element_offsets.assign(instance_.number_of_elements() + 1, 0);
+    for (ElementPos arc_id = 0;
+            arc_id < (ElementPos)arcs_set_ids_.size();
+            ++arc_id) {
+        SetId set_id = arcs_set_ids_[arc_id];
+        ElementId element_id = arcs_element_ids_[arc_id];
+        if (set_id < 0 || set_id >= instance_.number_of_sets()
+                || element_id < 0 || element_id >= instance_.number_of_elements()) {
+            throw std::invalid_argument(
+                    "setcoveringsolver::InstanceBuilder::build: "
+                    "invalid arc; "
+                    "set_id: " + std::to_string(set_id) + "; "
+                    "element_id: " + std::to_string(element_id) + ".");
+        }
+        set_offsets[set_id]++;
+        element_offsets[element_id]++;
+    }
+
+    // Turn the counts into start positions.
+    ElementPos set_offset = 0;
+    for (SetId set_id = 0; set_id <= instance_.number_of_sets(); ++set_id) {
+        ElementPos number_of_elements = set_offsets[set_id];
+        set_offsets[set_id] = set_offset;
+        set_offset += number_of_elements;
+    }
+    SetPos element_offset = 0;
+    for (ElementId element_id = 0;
+            element_id <= instance_.number_of_elements();
+            ++element_id) {
+        SetPos number_of_sets = element_offsets[element_id];
+        element_offsets[element_id] = element_offset;
+        element_offset += number_of_sets;
+    }
+
+    // Scatter the arcs. The order in which the arcs have been added is kept
+    // for each set and each element. After this step, the offset of a set
+    // (resp. element) is the start position of the next one.
+    instance_.set_elements_.resize(arcs_set_ids_.size());
+    instance_.element_sets_.resize(arcs_set_ids_.size());
+    for (ElementPos arc_id = 0;
+            arc_id < (ElementPos)arcs_set_ids_.size();
+            ++arc_id) {
+        SetId set_id = arcs_set_ids_[arc_id];
+        ElementId element_id = arcs_element_ids_[arc_id];
+        instance_.set_elements_[set_offsets[set_id]++] = element_id;
+        instance_.element_sets_[element_offsets[element_id]++] = set_id;
+    }
+
+    // Shift the offsets back.
+    for (SetId set_id = instance_.number_of_sets(); set_id > 0; --set_id)
+        set_offsets[set_id] = set_offsets[set_id - 1];
+    set_offsets[0] = 0;
+    for (ElementId element_id = instance_.number_of_elements();
+            element_id > 0;
+            --element_id) {
+        element_offsets[element_id] = element_offsets[element_id - 1];
+    }
+    element_offsets[0] = 0;
+
+    arcs_set_ids_ = std::vector<SetId>();
+    arcs_element_ids_ = std::vector<ElementId>();
+}
+
+void InstanceBuilder::compute_element_sets()
+{
+    ElementId number_of_elements = instance_.number_of_elements();
+    SetId number_of_sets = instance_.number_of_sets();
+    ElementPos number_of_arcs = instance_.set_elements_.size();
+    std::vector<SetPos>& element_offsets = instance_.element_sets_offsets_;
+    instance_.element_sets_.resize(number_of_arcs);
+
+    if (number_of_threads_ <= 1 || number_of_arcs < (1 << 16)) {
+        // Iterating over the sets in order, the sets of each element are
+        // sorted.
+        element_offsets.assign(number_of_elements + 1, 0);
+        for (ElementId element_id: instance_.set_elements_)
+            element_offsets[element_id + 1]++;
+        for (ElementId element_id = 0;
+                element_id < number_of_elements;
+                ++element_id) {
+            element_offsets[element_id + 1] += element_offsets[element_id];
+        }
+        std::vector<SetPos> positions(element_offsets.begin(), element_offsets.end() - 1);
+        for (SetId set_id = 0; set_id < number_of_sets; ++set_id)
+            for (ElementId element_id: instance_.set(set_id).elements)
+                instance_.element_sets_[positions[element_id]++] = set_id;
+        return;
+    }
+
+    // Count and scatter in parallel. The sets of each element are then
+    // sorted so that the result doesn't depend on the scheduling.
+    Counter number_of_threads = number_of_threads_;
+    std::vector<std::atomic<SetPos>> positions(number_of_elements);
+    for (ElementId element_id = 0;
+            element_id < number_of_elements;
+            ++element_id) {
+        positions[element_id].store(0, std::memory_order_relaxed);
+    }
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([this, &positions, number_of_arcs, number_of_threads, thread_id]()
+        {
+            for (ElementPos arc_pos = thread_id * number_of_arcs / number_of_threads;
+                    arc_pos < (thread_id + 1) * number_of_arcs / number_of_threads;
+                    ++arc_pos) {
+                positions[instance_.set_elements_[arc_pos]].fetch_add(1, std::memory_order_relaxed);
+            }
+        }));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+    threads.clear();
+    element_offsets.resize(number_of_elements + 1);
+    element_offsets[0] = 0;
+    for (ElementId element_id = 0;
+            element_id < number_of_elements;
+            ++element_id) {
+        element_offsets[element_id + 1] = element_offsets[element_id]
+            + positions[element_id].load(std::memory_order_relaxed);
+        positions[element_id].store(element_offsets[element_id], std::memory_order_relaxed);
+    }
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([this, &positions, number_of_sets, number_of_threads, thread_id]()
+        {
+            for (SetId set_id = thread_id * number_of_sets / number_of_threads;
+                    set_id < (thread_id + 1) * number_of_sets / number_of_threads;
+                    ++set_id) {
+                for (ElementId element_id: instance_.set(set_id).elements) {
+                    SetPos pos = positions[element_id].fetch_add(1, std::memory_order_relaxed);
+                    instance_.element_sets_[pos] = set_id;
+                }
+            }
+        }));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+    threads.clear();
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([this, &element_offsets, number_of_elements, number_of_threads, thread_id]()
+        {
+            for (ElementId element_id = thread_id * number_of_elements / number_of_threads;
+                    element_id < (thread_id + 1) * number_of_elements / number_of_threads;
+                    ++element_id) {
+                std::sort(
+                        instance_.element_sets_.begin() + element_offsets[element_id],
+                        instance_.element_sets_.begin() + element_offsets[element_id + 1]);
+            }
+        }));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+}
+
+namespace
+{
+
+/**
+ * Remove the repeated values of each list of a CSR array.
+ *
+ * The first occurrence of each value is kept.
+ */
+template <typename Pos, typename Value>
+void remove_duplicate_values(
+        std::vector<Pos>& offsets,
+        std::vector<Value>& values,
+        Value number_of_values)
+{
+    std::vector<Pos> marks(number_of_values, -1);
+    Pos new_pos = 0;
+    Pos first_pos = 0;
+    for (size_t list_id = 0; list_id + 1 < offsets.size(); ++list_id) {
+        Pos last_pos = offsets[list_id + 1];
+        offsets[list_id] = new_pos;
+        for (Pos pos = first_pos; pos < last_pos; ++pos) {
+            Value value = values[pos];
+            if (marks[value] == (Pos)list_id)
+                continue;
+            marks[value] = list_id;
+            values[new_pos] = value;
+            new_pos++;
+        }
+        first_pos = last_pos;
+    }
+    offsets.back() = new_pos;
+    values.resize(new_pos);
+}
+
+}
+
+void InstanceBuilder::remove_duplicate_arcs()
+{
+    remove_duplicate_values(
+            instance_.set_elements_offsets_,
+            instance_.set_elements_,
+            instance_.number_of_elements());
+    if (!instance_.element_sets_offsets_.empty()) {
+        remove_duplicate_values(
+                instance_.element_sets_offsets_,
+                instance_.element_sets_,
+                instance_.number_of_sets());
+    }
+}
+
 void InstanceBuilder::compute_number_of_arcs()
 {
-    instance_.total_cost_ = 0;
-    for (SetId set_id = 0; set_id < instance_.number_of_sets(); ++set_id)
-        instance_.total_cost_ += instance_.set(set_id).cost;
+    instance_.number_of_arcs_ = instance_.set_elements_.size();
 }
 
 void InstanceBuilder::compute_total_cost()
 {
-    instance_.number_of_arcs_ = 0;
+    instance_.total_cost_ = 0;
     for (SetId set_id = 0; set_id < instance_.number_of_sets(); ++set_id)
-        instance_.number_of_arcs_ += instance_.set(set_id).elements.size();
+        instance_.total_cost_ += instance_.set(set_id).cost;
 }
 
-void InstanceBuilder::compute_components()
+void InstanceBuilder::compute_components_dfs()
 {
-    if (!instance_.components_.empty())
-        return;
     for (ElementId element_id = 0;
             element_id < instance_.number_of_elements();
             ++element_id)
-        instance_.elements_[element_id].component = -1;
+        instance_.element_components_[element_id] = -1;
     for (SetId set_id = 0; set_id < instance_.number_of_sets(); ++set_id)
-        instance_.sets_[set_id].component = -1;
+        instance_.set_components_[set_id] = -1;
 
     ElementId element_id_0 = 0;
     for (ComponentId component_id = 0;; ++component_id) {
         while (element_id_0 < instance_.number_of_elements()
-                && (instance_.element(element_id_0).component != -1))
+                && (instance_.element_components_[element_id_0] != -1))
             element_id_0++;
         if (element_id_0 == instance_.number_of_elements())
             break;
-        instance_.components_.push_back(Component());
+        instance_.number_of_components_++;
         std::vector<ElementId> stack {element_id_0};
-        instance_.elements_[element_id_0].component = component_id;
+        instance_.element_components_[element_id_0] = component_id;
         while (!stack.empty()) {
             ElementId element_id = stack.back();
             stack.pop_back();
             for (SetId set_id: instance_.element(element_id).sets) {
-                if (instance_.set(set_id).component != -1)
+                if (instance_.set_components_[set_id] != -1)
                     continue;
-                instance_.sets_[set_id].component = component_id;
+                instance_.set_components_[set_id] = component_id;
                 for (ElementId element_id_next: instance_.set(set_id).elements) {
-                    if (instance_.element(element_id_next).component != -1)
+                    if (instance_.element_components_[element_id_next] != -1)
                         continue;
-                    instance_.elements_[element_id_next].component = component_id;
+                    instance_.element_components_[element_id_next] = component_id;
                     stack.push_back(element_id_next);
                 }
             }
         }
     }
+}
+
+namespace
+{
+
+/**
+ * Find the root of an element in a union-find forest.
+ *
+ * The parent of an element is never larger than the element. Paths are
+ * halved on the way up.
+ */
+inline ElementId union_find_root(
+        std::vector<std::atomic<ElementId>>& parents,
+        ElementId element_id)
+{
+    for (;;) {
+        ElementId parent_id = parents[element_id].load(std::memory_order_relaxed);
+        if (parent_id == element_id)
+            return element_id;
+        ElementId grand_parent_id = parents[parent_id].load(std::memory_order_relaxed);
+        if (grand_parent_id != parent_id) {
+            parents[element_id].compare_exchange_weak(
+                    parent_id,
+                    grand_parent_id,
+                    std::memory_order_relaxed);
+        }
+        element_id = grand_parent_id;
+    }
+}
+
+/**
+ * Merge the trees of two elements in a union-find forest.
+ *
+ * The root with the largest id is linked to the other one, so that the root
+ * of a tree is its smallest element.
+ */
+inline void union_find_unite(
+        std::vector<std::atomic<ElementId>>& parents,
+        ElementId element_id_1,
+        ElementId element_id_2)
+{
+    for (;;) {
+        element_id_1 = union_find_root(parents, element_id_1);
+        element_id_2 = union_find_root(parents, element_id_2);
+        if (element_id_1 == element_id_2)
+            return;
+        if (element_id_1 < element_id_2)
+            std::swap(element_id_1, element_id_2);
+        ElementId expected_parent_id = element_id_1;
+        if (parents[element_id_1].compare_exchange_strong(
+                    expected_parent_id,
+                    element_id_2)) {
+            return;
+        }
+    }
+}
+
+}
 
+void InstanceBuilder::compute_components_union_find()
+{
+    ElementId number_of_elements = instance_.number_of_elements();
+    SetId number_of_sets = instance_.number_of_sets();
+    ElementPos number_of_arcs = instance_.number_of_arcs();
+    const std::vector<ElementPos>& set_offsets = instance_.set_elements_offsets_;
+    Counter number_of_threads = number_of_threads_;
+    std::vector<std::thread> threads;
+
+    std::vector<std::atomic<ElementId>> parents(number_of_elements);
     for (ElementId element_id = 0;
-            element_id < instance_.number_of_elements();
+            element_id < number_of_elements;
             ++element_id) {
-        instance_.components_[instance_.element(element_id).component].elements.push_back(element_id);
+        parents[element_id].store(element_id, std::memory_order_relaxed);
     }
-    for (SetId set_id = 0; set_id < instance_.number_of_sets(); ++set_id) {
-        if (instance_.set(set_id).component != -1)
-            instance_.components_[instance_.set(set_id).component].sets.push_back(set_id);
+
+    // Unite the elements of each set. The sets are split so that each thread
+    // gets about the same number of arcs.
+    std::vector<SetId> set_bounds(number_of_threads + 1, number_of_sets);
+    set_bounds[0] = 0;
+    for (Counter thread_id = 1; thread_id < number_of_threads; ++thread_id) {
+        set_bounds[thread_id] = std::upper_bound(
+                set_offsets.begin(),
+                set_offsets.end() - 1,
+                thread_id * number_of_arcs / number_of_threads)
+            - set_offsets.begin();
+    }
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([this, &parents, &set_bounds, thread_id]()
+        {
+            for (SetId set_id = set_bounds[thread_id];
+                    set_id < set_bounds[thread_id + 1];
+                    ++set_id) {
+                IndexRange<ElementId> elements = instance_.set(set_id).elements;
+                for (size_t pos = 1; pos < elements.size(); ++pos)
+                    union_find_unite(parents, elements[0], elements[pos]);
+            }
+        }));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+    threads.clear();
+
+    // Number the components by increasing smallest element, as the DFS does.
+    // The roots of the trees are the smallest elements of the components.
+    std::vector<ComponentId> number_of_roots(number_of_threads + 1, 0);
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([&parents, &number_of_roots, number_of_elements, number_of_threads, thread_id]()
+        {
+            for (ElementId element_id = thread_id * number_of_elements / number_of_threads;
+                    element_id < (thread_id + 1) * number_of_elements / number_of_threads;
+                    ++element_id) {
+                if (parents[element_id].load(std::memory_order_relaxed) == element_id)
+                    number_of_roots[thread_id + 1]++;
+            }
+        }));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+    threads.clear();
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id)
+        number_of_roots[thread_id + 1] += number_of_roots[thread_id];
+    instance_.number_of_components_ = number_of_roots[number_of_threads];
+
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([this, &parents, &number_of_roots, number_of_elements, number_of_threads, thread_id]()
+        {
+            ComponentId component_id = number_of_roots[thread_id];
+            for (ElementId element_id = thread_id * number_of_elements / number_of_threads;
+                    element_id < (thread_id + 1) * number_of_elements / number_of_threads;
+                    ++element_id) {
+                if (parents[element_id].load(std::memory_order_relaxed) == element_id)
+                    instance_.element_components_[element_id] = component_id++;
+            }
+        }));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+    threads.clear();
+
+    // Label the other elements and the sets.
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([this, &parents, number_of_elements, number_of_sets, number_of_threads, thread_id]()
+        {
+            for (ElementId element_id = thread_id * number_of_elements / number_of_threads;
+                    element_id < (thread_id + 1) * number_of_elements / number_of_threads;
+                    ++element_id) {
+                ElementId root_id = union_find_root(parents, element_id);
+                if (root_id != element_id)
+                    instance_.element_components_[element_id] = instance_.element_components_[root_id];
+            }
+        }));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+    threads.clear();
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([this, number_of_sets, number_of_threads, thread_id]()
+        {
+            for (SetId set_id = thread_id * number_of_sets / number_of_threads;
+                    set_id < (thread_id + 1) * number_of_sets / number_of_threads;
+                    ++set_id) {
+                IndexRange<ElementId> elements = instance_.set(set_id).elements;
+                instance_.set_components_[set_id] = (elements.empty())?
+                    -1:
+                    instance_.element_components_[elements[0]];
+            }
+        }));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+}
+
+void InstanceBuilder::compute_components()
+{
+    if (!instance_.component_elements_offsets_.empty())
+        return;
+
+    // The parallel union-find only pays off on large instances.
+    if (number_of_threads_ > 1
+            && instance_.number_of_arcs() >= (1 << 16)) {
+        compute_components_union_find();
+    } else {
+        compute_components_dfs();
+    }
+
+    instance_.compute_component_lists();
+}
+
+void InstanceBuilder::renumber()
+{
+    ElementId number_of_elements = instance_.number_of_elements();
+    SetId number_of_sets = instance_.number_of_sets();
+
+    // Compute the new order of the elements and of the sets. The components
+    // are kept in the same order, so that their ids don't change.
+    std::vector<ElementId> element_order;
+    element_order.reserve(number_of_elements);
+    std::vector<SetId> set_order;
+    set_order.reserve(number_of_sets);
+    auto element_degree = [this](ElementId element_id) { return instance_.element(element_id).sets.size(); };
+    auto set_degree = [this](SetId set_id) { return instance_.set(set_id).elements.size(); };
+    std::vector<uint8_t> elements_visited(number_of_elements, 0);
+    std::vector<uint8_t> sets_visited(number_of_sets, 0);
+    for (ComponentId component_id = 0;
+            component_id < instance_.number_of_components();
+            ++component_id) {
+        Component component = instance_.component(component_id);
+
+        if (renumbering_ == "degree") {
+            ElementPos first_element_pos = element_order.size();
+            element_order.insert(element_order.end(), component.elements.begin(), component.elements.end());
+            std::stable_sort(
+                    element_order.begin() + first_element_pos,
+                    element_order.end(),
+                    [&element_degree](ElementId element_id_1, ElementId element_id_2)
+                    {
+                        return element_degree(element_id_1) > element_degree(element_id_2);
+                    });
+            SetPos first_set_pos = set_order.size();
+            set_order.insert(set_order.end(), component.sets.begin(), component.sets.end());
+            std::stable_sort(
+                    set_order.begin() + first_set_pos,
+                    set_order.end(),
+                    [&set_degree](SetId set_id_1, SetId set_id_2)
+                    {
+                        return set_degree(set_id_1) > set_degree(set_id_2);
+                    });
+            continue;
+        }
+
+        // Cuthill-McKee: breadth-first search from an element of minimum
+        // degree, the neighbors being visited by increasing degree.
+        ElementId element_id_0 = *std::min_element(
+                component.elements.begin(),
+                component.elements.end(),
+                [&element_degree](ElementId element_id_1, ElementId element_id_2)
+                {
+                    return element_degree(element_id_1) < element_degree(element_id_2);
+                });
+        ElementPos element_pos = element_order.size();
+        element_order.push_back(element_id_0);
+        elements_visited[element_id_0] = 1;
+        while (element_pos < (ElementPos)element_order.size()) {
+            ElementId element_id = element_order[element_pos];
+            element_pos++;
+            SetPos first_set_pos = set_order.size();
+            for (SetId set_id: instance_.element(element_id).sets) {
+                if (sets_visited[set_id])
+                    continue;
+                sets_visited[set_id] = 1;
+                set_order.push_back(set_id);
+            }
+            std::stable_sort(
+                    set_order.begin() + first_set_pos,
+                    set_order.end(),
+                    [&set_degree](SetId set_id_1, SetId set_id_2)
+                    {
+                        return set_degree(set_id_1) < set_degree(set_id_2);
+                    });
+            for (SetPos set_pos = first_set_pos;
+                    set_pos < (SetPos)set_order.size();
+                    ++set_pos) {
+                ElementPos first_element_pos = element_order.size();
+                for (ElementId element_id_next: instance_.set(set_order[set_pos]).elements) {
+                    if (elements_visited[element_id_next])
+                        continue;
+                    elements_visited[element_id_next] = 1;
+                    element_order.push_back(element_id_next);
+                }
+                std::stable_sort(
+                        element_order.begin() + first_element_pos,
+                        element_order.end(),
+                        [&element_degree](ElementId element_id_1, ElementId element_id_2)
+                        {
+                            return element_degree(element_id_1) < element_degree(element_id_2);
+                        });
+            }
+        }
+    }
+    // Sets which don't cover any element are put at the end.
+    for (SetId set_id = 0; set_id < number_of_sets; ++set_id)
+        if (instance_.set_components_[set_id] == -1)
+            set_order.push_back(set_id);
+
+    std::vector<ElementId> new_element_ids(number_of_elements);
+    for (ElementId element_id = 0;
+            element_id < number_of_elements;
+            ++element_id) {
+        new_element_ids[element_order[element_id]] = element_id;
+    }
+    std::vector<SetId> new_set_ids(number_of_sets);
+    for (SetId set_id = 0; set_id < number_of_sets; ++set_id)
+        new_set_ids[set_order[set_id]] = set_id;
+
+    // Permute the costs and the adjacency arrays.
+    std::vector<Cost> set_costs(number_of_sets);
+    std::vector<ElementPos> set_elements_offsets(number_of_sets + 1, 0);
+    std::vector<ElementId> set_elements(instance_.number_of_arcs());
+    for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
+        const Set set = instance_.set(set_order[set_id]);
+        set_costs[set_id] = set.cost;
+        ElementPos offset = set_elements_offsets[set_id];
+        set_elements_offsets[set_id + 1] = offset + set.elements.size();
+        for (ElementPos element_pos = 0;
+                element_pos < (ElementPos)set.elements.size();
+                ++element_pos) {
+            set_elements[offset + element_pos] = new_element_ids[set.elements[element_pos]];
+        }
+        std::sort(
+                set_elements.begin() + offset,
+                set_elements.begin() + set_elements_offsets[set_id + 1]);
+    }
+    std::vector<SetPos> element_sets_offsets(number_of_elements + 1, 0);
+    std::vector<SetId> element_sets(instance_.number_of_arcs());
+    for (ElementId element_id = 0;
+            element_id < number_of_elements;
+            ++element_id) {
+        const Element element = instance_.element(element_order[element_id]);
+        SetPos offset = element_sets_offsets[element_id];
+        element_sets_offsets[element_id + 1] = offset + element.sets.size();
+        for (SetPos set_pos = 0;
+                set_pos < (SetPos)element.sets.size();
+                ++set_pos) {
+            element_sets[offset + set_pos] = new_set_ids[element.sets[set_pos]];
+        }
+        std::sort(
+                element_sets.begin() + offset,
+                element_sets.begin() + element_sets_offsets[element_id + 1]);
+    }
+    instance_.set_costs_ = std::move(set_costs);
+    instance_.set_elements_offsets_ = std::move(set_elements_offsets);
+    instance_.set_elements_ = std::move(set_elements);
+    instance_.element_sets_offsets_ = std::move(element_sets_offsets);
+    instance_.element_sets_ = std::move(element_sets);
+
+    // The components are the same, so their ids are only permuted with the
+    // sets and the elements, and their lists are recomputed.
+    std::vector<ComponentId> set_components(number_of_sets);
+    for (SetId set_id = 0; set_id < number_of_sets; ++set_id)
+        set_components[set_id] = instance_.set_components_[set_order[set_id]];
+    std::vector<ComponentId> element_components(number_of_elements);
+    for (ElementId element_id = 0;
+            element_id < number_of_elements;
+            ++element_id) {
+        element_components[element_id] = instance_.element_components_[element_order[element_id]];
+    }
+    instance_.set_components_ = std::move(set_components);
+    instance_.element_components_ = std::move(element_components);
+    instance_.compute_component_lists();
+
+    // Keep the original ids. If the instance was already renumbered, the
+    // permutations are composed.
+    if (instance_.renumbered()) {
+        for (SetId set_id = 0; set_id < number_of_sets; ++set_id)
+            set_order[set_id] = instance_.original_set_ids_[set_order[set_id]];
+        for (ElementId element_id = 0;
+                element_id < number_of_elements;
+                ++element_id) {
+            element_order[element_id] = instance_.original_element_ids_[element_order[element_id]];
+        }
     }
+    instance_.renumbered_set_ids_.resize(number_of_sets);
+    for (SetId set_id = 0; set_id < number_of_sets; ++set_id)
+        instance_.renumbered_set_ids_[set_order[set_id]] = set_id;
+    instance_.original_set_ids_ = std::move(set_order);
+    instance_.original_element_ids_ = std::move(element_order);
 }
 
 Instance InstanceBuilder::build()
 {
+    // The adjacency arrays are already filled if the instance has been read
+    // from a file in 'binary' format. The elements of the sets are already
+    // filled if they have been given with 'set_elements'.
+    if (!instance_.set_elements_offsets_.empty()
+            && !arcs_set_ids_.empty()) {
+        throw std::logic_error(
+                "setcoveringsolver::InstanceBuilder::build: "
+                "arcs added with 'add_arc' or 'add_arcs' while the elements "
+                "of the sets are given with 'set_numbers_of_elements'; "
+                "number_of_arcs_added: " + std::to_string(arcs_set_ids_.size()) + ".");
+    }
+    if (instance_.set_elements_offsets_.empty())
+        compute_adjacency();
+    if (remove_duplicate_arcs_)
+        remove_duplicate_arcs();
+    if (instance_.element_sets_offsets_.empty())
+        compute_element_sets();
     compute_total_cost();
     compute_number_of_arcs();
     compute_components();
+    if (!renumbering_.empty())
+        renumber();
+    instance_.number_of_threads_ = number_of_threads_;
 
     for (ElementId element_id = 0;
             element_id < instance_.number_of_elements();
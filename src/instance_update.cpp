@@ -0,0 +1,578 @@
+#include "setcoveringsolver/instance_update.hpp"
+
+#include <algorithm>
+#include <limits>
+
+using namespace setcoveringsolver;
+
+InstanceUpdate::InstanceUpdate(const Instance& instance):
+    instance_(&instance)
+{
+}
+
+SetId InstanceUpdate::add_set(Cost cost)
+{
+    if ((int64_t)instance_->number_of_sets() + added_set_costs_.size()
+            >= std::numeric_limits<SetId>::max()) {
+        throw std::overflow_error(
+                "setcoveringsolver::InstanceUpdate::add_set: "
+                "too many sets for the index type.");
+    }
+    added_set_costs_.push_back(cost);
+    return instance_->number_of_sets() + added_set_costs_.size() - 1;
+}
+
+ElementId InstanceUpdate::add_element()
+{
+    if ((int64_t)instance_->number_of_elements() + number_of_added_elements_
+            >= std::numeric_limits<ElementId>::max()) {
+        throw std::overflow_error(
+                "setcoveringsolver::InstanceUpdate::add_element: "
+                "too many elements for the index type.");
+    }
+    number_of_added_elements_++;
+    return instance_->number_of_elements() + number_of_added_elements_ - 1;
+}
+
+void InstanceUpdate::check_set_index(SetId set_id) const
+{
+    SetId number_of_sets = instance_->number_of_sets() + added_set_costs_.size();
+    if (set_id < 0 || set_id >= number_of_sets) {
+        throw std::out_of_range(
+                "setcoveringsolver::InstanceUpdate: "
+                "invalid set index; "
+                "set_id: " + std::to_string(set_id) + "; "
+                "number_of_sets: " + std::to_string(number_of_sets) + ".");
+    }
+}
+
+void InstanceUpdate::check_element_index(ElementId element_id) const
+{
+    ElementId number_of_elements = instance_->number_of_elements() + number_of_added_elements_;
+    if (element_id < 0 || element_id >= number_of_elements) {
+        throw std::out_of_range(
+                "setcoveringsolver::InstanceUpdate: "
+                "invalid element index; "
+                "element_id: " + std::to_string(element_id) + "; "
+                "number_of_elements: " + std::to_string(number_of_elements) + ".");
+    }
+}
+
+void InstanceUpdate::add_arc(
+        SetId set_id,
+        ElementId element_id)
+{
+    check_set_index(set_id);
+    check_element_index(element_id);
+    arcs_set_ids_.push_back(set_id);
+    arcs_element_ids_.push_back(element_id);
+}
+
+void InstanceUpdate::remove_set(SetId set_id)
+{
+    check_set_index(set_id);
+    removed_set_ids_.push_back(set_id);
+}
+
+void InstanceUpdate::remove_element(ElementId element_id)
+{
+    check_element_index(element_id);
+    removed_element_ids_.push_back(element_id);
+}
+
+void InstanceUpdate::set_cost(
+        SetId set_id,
+        Cost cost)
+{
+    check_set_index(set_id);
+    if (set_id >= instance_->number_of_sets()) {
+        added_set_costs_[set_id - instance_->number_of_sets()] = cost;
+    } else {
+        set_costs_.push_back({set_id, cost});
+    }
+}
+
+namespace
+{
+
+/** Find the root of a piece in a union-find forest. */
+inline ComponentId union_find_root(
+        std::vector<ComponentId>& parents,
+        ComponentId piece_id)
+{
+    while (parents[piece_id] != piece_id) {
+        parents[piece_id] = parents[parents[piece_id]];
+        piece_id = parents[piece_id];
+    }
+    return piece_id;
+}
+
+/** Merge the trees of two pieces in a union-find forest. */
+inline void union_find_unite(
+        std::vector<ComponentId>& parents,
+        ComponentId piece_id_1,
+        ComponentId piece_id_2)
+{
+    piece_id_1 = union_find_root(parents, piece_id_1);
+    piece_id_2 = union_find_root(parents, piece_id_2);
+    if (piece_id_1 == piece_id_2)
+        return;
+    if (piece_id_1 < piece_id_2)
+        std::swap(piece_id_1, piece_id_2);
+    parents[piece_id_1] = piece_id_2;
+}
+
+}
+
+Instance InstanceUpdate::apply()
+{
+    const Instance& instance = *instance_;
+    SetId number_of_sets = instance.number_of_sets() + added_set_costs_.size();
+    ElementId number_of_elements = instance.number_of_elements() + number_of_added_elements_;
+
+    std::sort(removed_set_ids_.begin(), removed_set_ids_.end());
+    removed_set_ids_.erase(
+            std::unique(removed_set_ids_.begin(), removed_set_ids_.end()),
+            removed_set_ids_.end());
+    std::sort(removed_element_ids_.begin(), removed_element_ids_.end());
+    removed_element_ids_.erase(
+            std::unique(removed_element_ids_.begin(), removed_element_ids_.end()),
+            removed_element_ids_.end());
+
+    // Compute the ids of the sets and of the elements in the updated instance.
+    updated_set_ids_.assign(number_of_sets, 0);
+    for (SetId set_id: removed_set_ids_)
+        updated_set_ids_[set_id] = -1;
+    SetId number_of_updated_sets = 0;
+    for (SetId set_id = 0; set_id < number_of_sets; ++set_id)
+        if (updated_set_ids_[set_id] != -1)
+            updated_set_ids_[set_id] = number_of_updated_sets++;
+    updated_element_ids_.assign(number_of_elements, 0);
+    for (ElementId element_id: removed_element_ids_)
+        updated_element_ids_[element_id] = -1;
+    ElementId number_of_updated_elements = 0;
+    for (ElementId element_id = 0;
+            element_id < number_of_elements;
+            ++element_id) {
+        if (updated_element_ids_[element_id] != -1)
+            updated_element_ids_[element_id] = number_of_updated_elements++;
+    }
+
+    // Keep the added arcs between remaining sets and elements which are not
+    // already in the instance, sorted by set.
+    std::vector<std::pair<SetId, ElementId>> arcs;
+    for (ElementPos arc_id = 0;
+            arc_id < (ElementPos)arcs_set_ids_.size();
+            ++arc_id) {
+        if (updated_set_ids_[arcs_set_ids_[arc_id]] == -1
+                || updated_element_ids_[arcs_element_ids_[arc_id]] == -1) {
+            continue;
+        }
+        arcs.push_back({arcs_set_ids_[arc_id], arcs_element_ids_[arc_id]});
+    }
+    std::sort(arcs.begin(), arcs.end());
+    arcs.erase(std::unique(arcs.begin(), arcs.end()), arcs.end());
+    std::vector<Counter> element_marks(instance.number_of_elements(), -1);
+    ElementPos number_of_added_arcs = 0;
+    for (ElementPos arc_pos = 0; arc_pos < (ElementPos)arcs.size(); ++arc_pos) {
+        SetId set_id = arcs[arc_pos].first;
+        ElementId element_id = arcs[arc_pos].second;
+        if (set_id < instance.number_of_sets()
+                && (arc_pos == 0 || arcs[arc_pos - 1].first != set_id)) {
+            for (ElementId element_id_2: instance.set(set_id).elements)
+                element_marks[element_id_2] = set_id;
+        }
+        if (element_id < instance.number_of_elements()
+                && element_marks[element_id] == set_id) {
+            continue;
+        }
+        arcs[number_of_added_arcs++] = arcs[arc_pos];
+    }
+    arcs.resize(number_of_added_arcs);
+
+    // Update the number of arcs.
+    ElementPos number_of_removed_arcs = 0;
+    for (SetId set_id: removed_set_ids_)
+        if (set_id < instance.number_of_sets())
+            number_of_removed_arcs += instance.set(set_id).elements.size();
+    for (ElementId element_id: removed_element_ids_) {
+        if (element_id >= instance.number_of_elements())
+            continue;
+        for (SetId set_id: instance.element(element_id).sets)
+            if (updated_set_ids_[set_id] != -1)
+                number_of_removed_arcs++;
+    }
+    if ((int64_t)instance.number_of_arcs() - number_of_removed_arcs + number_of_added_arcs
+            > std::numeric_limits<ElementPos>::max()) {
+        throw std::overflow_error(
+                "setcoveringsolver::InstanceUpdate::apply: "
+                "too many arcs for the index type.");
+    }
+
+    Instance updated_instance;
+    updated_instance.number_of_arcs_ = instance.number_of_arcs()
+        - number_of_removed_arcs
+        + number_of_added_arcs;
+
+    // Fill the elements of the sets. The remaining elements of a set keep
+    // their order and are followed by the added ones.
+    updated_instance.set_costs_.resize(number_of_updated_sets);
+    updated_instance.set_components_.resize(number_of_updated_sets);
+    std::vector<ElementPos>& set_offsets = updated_instance.set_elements_offsets_;
+    std::vector<ElementId>& set_elements = updated_instance.set_elements_;
+    set_offsets.resize(number_of_updated_sets + 1);
+    set_offsets[0] = 0;
+    set_elements.reserve(updated_instance.number_of_arcs_);
+    ElementPos arc_pos = 0;
+    for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
+        SetId updated_set_id = updated_set_ids_[set_id];
+        if (updated_set_id == -1)
+            continue;
+        if (set_id < instance.number_of_sets()) {
+            updated_instance.set_costs_[updated_set_id] = instance.set(set_id).cost;
+            for (ElementId element_id: instance.set(set_id).elements) {
+                ElementId updated_element_id = updated_element_ids_[element_id];
+                if (updated_element_id != -1)
+                    set_elements.push_back(updated_element_id);
+            }
+        } else {
+            updated_instance.set_costs_[updated_set_id]
+                = added_set_costs_[set_id - instance.number_of_sets()];
+        }
+        for (;
+                arc_pos < (ElementPos)arcs.size() && arcs[arc_pos].first == set_id;
+                ++arc_pos) {
+            set_elements.push_back(updated_element_ids_[arcs[arc_pos].second]);
+        }
+        set_offsets[updated_set_id + 1] = set_elements.size();
+    }
+
+    // Fill the sets of the elements.
+    updated_instance.element_components_.resize(number_of_updated_elements);
+    std::vector<SetPos>& element_offsets = updated_instance.element_sets_offsets_;
+    element_offsets.assign(number_of_updated_elements + 1, 0);
+    for (ElementId element_id: set_elements)
+        element_offsets[element_id + 1]++;
+    for (ElementId element_id = 0;
+            element_id < number_of_updated_elements;
+            ++element_id) {
+        element_offsets[element_id + 1] += element_offsets[element_id];
+    }
+    updated_instance.element_sets_.resize(set_elements.size());
+    std::vector<SetPos> element_positions(element_offsets.begin(), element_offsets.end() - 1);
+    for (SetId set_id = 0; set_id < number_of_updated_sets; ++set_id)
+        for (ElementId element_id: updated_instance.set(set_id).elements)
+            updated_instance.element_sets_[element_positions[element_id]++] = set_id;
+
+    for (ElementId element_id = 0;
+            element_id < number_of_updated_elements;
+            ++element_id) {
+        if (updated_instance.element(element_id).sets.empty()) {
+            throw std::logic_error(
+                    "setcoveringsolver::InstanceUpdate::apply: "
+                    "uncoverable element; "
+                    "element_id: " + std::to_string(element_id) + ".");
+        }
+    }
+
+    // Update the total cost.
+    Cost total_cost = instance.total_cost();
+    for (SetId set_id: removed_set_ids_)
+        if (set_id < instance.number_of_sets())
+            total_cost -= instance.set(set_id).cost;
+    for (const auto& set_cost: set_costs_) {
+        SetId updated_set_id = updated_set_ids_[set_cost.first];
+        if (updated_set_id == -1)
+            continue;
+        total_cost += set_cost.second - updated_instance.set_costs_[updated_set_id];
+        updated_instance.set_costs_[updated_set_id] = set_cost.second;
+    }
+    for (SetId set_id = instance.number_of_sets(); set_id < number_of_sets; ++set_id)
+        if (updated_set_ids_[set_id] != -1)
+            total_cost += added_set_costs_[set_id - instance.number_of_sets()];
+    updated_instance.total_cost_ = total_cost;
+
+    compute_components(updated_instance, arcs);
+    compute_original_ids(updated_instance);
+
+    updated_instance.neighbors_memory_limit_ = instance.neighbors_memory_limit_;
+    updated_instance.number_of_threads_ = instance.number_of_threads_;
+    return updated_instance;
+}
+
+void InstanceUpdate::compute_components(
+        Instance& updated_instance,
+        const std::vector<std::pair<SetId, ElementId>>& arcs) const
+{
+    const Instance& instance = *instance_;
+
+    // Only the components containing a removed set or a removed element may
+    // have been split.
+    std::vector<uint8_t> split_components(instance.number_of_components(), 0);
+    for (SetId set_id: removed_set_ids_) {
+        if (set_id < instance.number_of_sets()
+                && instance.set(set_id).component != -1) {
+            split_components[instance.set(set_id).component] = 1;
+        }
+    }
+    for (ElementId element_id: removed_element_ids_)
+        if (element_id < instance.number_of_elements())
+            split_components[instance.element(element_id).component] = 1;
+
+    // Each set and each element belongs to a piece. The first pieces are the
+    // components of the instance which are still connected. The other pieces
+    // are found with a depth-first search. The pieces are then merged through
+    // the added arcs.
+    std::vector<ComponentId> element_pieces(updated_instance.number_of_elements(), -1);
+    std::vector<ComponentId> set_pieces(updated_instance.number_of_sets(), -1);
+    for (ElementId element_id = 0;
+            element_id < instance.number_of_elements();
+            ++element_id) {
+        ElementId updated_element_id = updated_element_ids_[element_id];
+        ComponentId component_id = instance.element(element_id).component;
+        if (updated_element_id != -1 && !split_components[component_id])
+            element_pieces[updated_element_id] = component_id;
+    }
+    for (SetId set_id = 0; set_id < instance.number_of_sets(); ++set_id) {
+        SetId updated_set_id = updated_set_ids_[set_id];
+        ComponentId component_id = instance.set(set_id).component;
+        if (updated_set_id != -1
+                && component_id != -1
+                && !split_components[component_id]) {
+            set_pieces[updated_set_id] = component_id;
+        }
+    }
+    std::vector<ComponentId> parents(instance.number_of_components());
+    for (ComponentId component_id = 0;
+            component_id < instance.number_of_components();
+            ++component_id) {
+        parents[component_id] = component_id;
+    }
+
+    std::vector<ElementId> stack;
+    for (ElementId element_id_0 = 0;
+            element_id_0 < updated_instance.number_of_elements();
+            ++element_id_0) {
+        if (element_pieces[element_id_0] != -1)
+            continue;
+        ComponentId piece_id = parents.size();
+        parents.push_back(piece_id);
+        element_pieces[element_id_0] = piece_id;
+        stack.push_back(element_id_0);
+        while (!stack.empty()) {
+            ElementId element_id = stack.back();
+            stack.pop_back();
+            for (SetId set_id: updated_instance.element(element_id).sets) {
+                if (set_pieces[set_id] != -1) {
+                    union_find_unite(parents, piece_id, set_pieces[set_id]);
+                    continue;
+                }
+                set_pieces[set_id] = piece_id;
+                for (ElementId element_id_next: updated_instance.set(set_id).elements) {
+                    if (element_pieces[element_id_next] != -1) {
+                        union_find_unite(parents, piece_id, element_pieces[element_id_next]);
+                        continue;
+                    }
+                    element_pieces[element_id_next] = piece_id;
+                    stack.push_back(element_id_next);
+                }
+            }
+        }
+    }
+    for (SetId set_id = 0; set_id < updated_instance.number_of_sets(); ++set_id) {
+        if (set_pieces[set_id] != -1)
+            continue;
+        IndexRange<ElementId> elements = updated_instance.set(set_id).elements;
+        if (elements.empty())
+            continue;
+        set_pieces[set_id] = element_pieces[elements[0]];
+        for (ElementId element_id: elements)
+            union_find_unite(parents, set_pieces[set_id], element_pieces[element_id]);
+    }
+    for (const auto& arc: arcs) {
+        union_find_unite(
+                parents,
+                set_pieces[updated_set_ids_[arc.first]],
+                element_pieces[updated_element_ids_[arc.second]]);
+    }
+
+    // Number the components by increasing smallest element, as the builder
+    // does.
+    std::vector<ComponentId> piece_components(parents.size(), -1);
+    ComponentId number_of_components = 0;
+    for (ElementId element_id = 0;
+            element_id < updated_instance.number_of_elements();
+            ++element_id) {
+        ComponentId root_id = union_find_root(parents, element_pieces[element_id]);
+        if (piece_components[root_id] == -1)
+            piece_components[root_id] = number_of_components++;
+        updated_instance.element_components_[element_id] = piece_components[root_id];
+    }
+    for (SetId set_id = 0; set_id < updated_instance.number_of_sets(); ++set_id) {
+        updated_instance.set_components_[set_id] = (set_pieces[set_id] == -1)?
+            -1:
+            piece_components[union_find_root(parents, set_pieces[set_id])];
+    }
+    updated_instance.number_of_components_ = number_of_components;
+    updated_instance.compute_component_lists();
+}
+
+void InstanceUpdate::compute_original_ids(Instance& updated_instance) const
+{
+    const Instance& instance = *instance_;
+    if (!instance.renumbered())
+        return;
+
+    // The remaining sets keep the order of their original ids, and the added
+    // sets follow.
+    std::vector<SetId> original_set_ranks(instance.number_of_sets(), -1);
+    for (SetId set_id = 0; set_id < instance.number_of_sets(); ++set_id)
+        if (updated_set_ids_[set_id] != -1)
+            original_set_ranks[instance.original_set_id(set_id)] = 0;
+    SetId original_set_rank = 0;
+    for (SetId original_set_id = 0;
+            original_set_id < instance.number_of_sets();
+            ++original_set_id) {
+        if (original_set_ranks[original_set_id] != -1)
+            original_set_ranks[original_set_id] = original_set_rank++;
+    }
+    updated_instance.original_set_ids_.resize(updated_instance.number_of_sets());
+    updated_instance.renumbered_set_ids_.resize(updated_instance.number_of_sets());
+    for (SetId set_id = 0; set_id < (SetId)updated_set_ids_.size(); ++set_id) {
+        SetId updated_set_id = updated_set_ids_[set_id];
+        if (updated_set_id == -1)
+            continue;
+        SetId original_set_id = (set_id < instance.number_of_sets())?
+            original_set_ranks[instance.original_set_id(set_id)]:
+            original_set_rank++;
+        updated_instance.original_set_ids_[updated_set_id] = original_set_id;
+        updated_instance.renumbered_set_ids_[original_set_id] = updated_set_id;
+    }
+
+    // Same for the elements.
+    std::vector<ElementId> original_element_ranks(instance.number_of_elements(), -1);
+    for (ElementId element_id = 0;
+            element_id < instance.number_of_elements();
+            ++element_id) {
+        if (updated_element_ids_[element_id] != -1)
+            original_element_ranks[instance.original_element_id(element_id)] = 0;
+    }
+    ElementId original_element_rank = 0;
+    for (ElementId original_element_id = 0;
+            original_element_id < instance.number_of_elements();
+            ++original_element_id) {
+        if (original_element_ranks[original_element_id] != -1)
+            original_element_ranks[original_element_id] = original_element_rank++;
+    }
+    updated_instance.original_element_ids_.resize(updated_instance.number_of_elements());
+    for (ElementId element_id = 0;
+            element_id < (ElementId)updated_element_ids_.size();
+            ++element_id) {
+        ElementId updated_element_id = updated_element_ids_[element_id];
+        if (updated_element_id == -1)
+            continue;
+        updated_instance.original_element_ids_[updated_element_id]
+            = (element_id < instance.number_of_elements())?
+            original_element_ranks[instance.original_element_id(element_id)]:
+            original_element_rank++;
+    }
+}
+
+Solution InstanceUpdate::update_solution(
+        const Instance& updated_instance,
+        const Solution& solution) const
+{
+    if (&solution.instance() != instance_) {
+        throw std::invalid_argument(
+                "setcoveringsolver::InstanceUpdate::update_solution: "
+                "the solution is not a solution of the instance.");
+    }
+    if ((SetId)updated_set_ids_.size() != instance_->number_of_sets() + (SetId)added_set_costs_.size()) {
+        throw std::logic_error(
+                "setcoveringsolver::InstanceUpdate::update_solution: "
+                "the update has not been applied.");
+    }
+
+    Solution updated_solution(updated_instance);
+    for (SetId set_id: solution.sets()) {
+        SetId updated_set_id = updated_set_ids_[set_id];
+        if (updated_set_id != -1
+                && !updated_instance.set(updated_set_id).elements.empty()) {
+            updated_solution.add(updated_set_id);
+        }
+    }
+
+    // Cover each uncovered element with the set of smallest cost per newly
+    // covered element.
+    for (ElementId element_id = 0;
+            element_id < updated_instance.number_of_elements();
+            ++element_id) {
+        if (updated_solution.covers(element_id) > 0)
+            continue;
+        SetId set_id_best = -1;
+        double value_best = std::numeric_limits<double>::infinity();
+        for (SetId set_id: updated_instance.element(element_id).sets) {
+            const Set& set = updated_instance.set(set_id);
+            ElementPos number_of_uncovered_elements = 0;
+            for (ElementId element_id_2: set.elements)
+                if (updated_solution.covers(element_id_2) == 0)
+                    number_of_uncovered_elements++;
+            double value = (double)set.cost / number_of_uncovered_elements;
+            if (value < value_best) {
+                set_id_best = set_id;
+                value_best = value;
+            }
+        }
+        updated_solution.add(set_id_best);
+    }
+
+    // Remove the redundant sets, most expensive first.
+    std::vector<SetId> set_ids(updated_solution.sets().begin(), updated_solution.sets().end());
+    std::sort(
+            set_ids.begin(),
+            set_ids.end(),
+            [&updated_instance](SetId set_id_1, SetId set_id_2)
+            {
+                return updated_instance.set(set_id_1).cost > updated_instance.set(set_id_2).cost;
+            });
+    for (SetId set_id: set_ids) {
+        bool redundant = true;
+        for (ElementId element_id: updated_instance.set(set_id).elements) {
+            if (updated_solution.covers(element_id) == 1) {
+                redundant = false;
+                break;
+            }
+        }
+        if (redundant)
+            updated_solution.remove(set_id);
+    }
+
+    return updated_solution;
+}
+
+std::vector<Penalty> InstanceUpdate::update_penalties(
+        const std::vector<Penalty>& penalties) const
+{
+    if ((ElementId)penalties.size() != instance_->number_of_elements()) {
+        throw std::invalid_argument(
+                "setcoveringsolver::InstanceUpdate::update_penalties: "
+                "wrong number of penalties; "
+                "penalties.size(): " + std::to_string(penalties.size()) + "; "
+                "number_of_elements: " + std::to_string(instance_->number_of_elements()) + ".");
+    }
+    if ((ElementId)updated_element_ids_.size() != instance_->number_of_elements() + number_of_added_elements_) {
+        throw std::logic_error(
+                "setcoveringsolver::InstanceUpdate::update_penalties: "
+                "the update has not been applied.");
+    }
+    ElementId number_of_updated_elements = updated_element_ids_.size() - removed_element_ids_.size();
+    std::vector<Penalty> updated_penalties(number_of_updated_elements, 0);
+    for (ElementId element_id = 0;
+            element_id < (ElementId)penalties.size();
+            ++element_id) {
+        ElementId updated_element_id = updated_element_ids_[element_id];
+        if (updated_element_id != -1)
+            updated_penalties[updated_element_id] = penalties[element_id];
+    }
+    return updated_penalties;
+}
@@ -1,4 +1,5 @@
 #include "setcoveringsolver/instance_builder.hpp"
+#include "setcoveringsolver/instance_update.hpp"
 
 #include "setcoveringsolver/solution.hpp"
 #include "setcoveringsolver/algorithms/greedy.hpp"
@@ -74,8 +75,28 @@ void read_args(
         parameters.reduction_parameters.dominated_elements_removal = vm["dominated-elements"].as<bool>();
     if (vm.count("linear-programming"))
         parameters.reduction_parameters.linear_programming = vm["linear-programming"].as<bool>();
+    if (vm.count("linear-programming-maximum-number-of-iterations"))
+        parameters.reduction_parameters.linear_programming_maximum_number_of_iterations = vm["linear-programming-maximum-number-of-iterations"].as<Counter>();
+    if (vm.count("crown"))
+        parameters.reduction_parameters.crown = vm["crown"].as<bool>();
+    if (vm.count("crown-time-limit"))
+        parameters.reduction_parameters.crown_time_limit = vm["crown-time-limit"].as<double>();
+    if (vm.count("small-components-maximum-number-of-sets"))
+        parameters.reduction_parameters.small_components_maximum_number_of_sets = vm["small-components-maximum-number-of-sets"].as<SetId>();
+    if (vm.count("adaptive-rule-scheduling"))
+        parameters.reduction_parameters.adaptive_rule_scheduling = vm["adaptive-rule-scheduling"].as<bool>();
+    if (vm.count("minimum-rule-yield"))
+        parameters.reduction_parameters.minimum_rule_yield = vm["minimum-rule-yield"].as<double>();
+    if (vm.count("minimum-rule-time"))
+        parameters.reduction_parameters.minimum_rule_time = vm["minimum-rule-time"].as<double>();
+    if (vm.count("reduction-threads"))
+        parameters.reduction_parameters.number_of_threads = vm["reduction-threads"].as<Counter>();
     if (vm.count("reduction-time-limit"))
         parameters.reduction_parameters.timer.set_time_limit(vm["reduction-time-limit"].as<double>());
+    if (vm.count("load-reduction"))
+        parameters.reduction_parameters.load_path = vm["load-reduction"].as<std::string>();
+    if (vm.count("save-reduction"))
+        parameters.reduction_parameters.save_path = vm["save-reduction"].as<std::string>();
     if (vm.count("enable-new-solution-callback"))
         parameters.enable_new_solution_callback = vm["enable-new-solution-callback"].as<bool>();
 }
@@ -184,6 +205,66 @@ Output run(
     }
 }
 
+void write_outputs(
+        const Output& output,
+        const po::variables_map& vm)
+{
+    if (vm.count("certificate")) {
+        std::string certificate_format = "";
+        if (vm.count("certificate-format"))
+            certificate_format = vm["certificate-format"].as<std::string>();
+        output.solution.write(
+                vm["certificate"].as<std::string>(),
+                certificate_format);
+    }
+    if (vm.count("output"))
+        output.write_json_output(vm["output"].as<std::string>());
+}
+
+/**
+ * Solve the instance, remove some of its sets, and solve the updated instance
+ * again, warm started from the solution and the penalties of the first run.
+ *
+ * The outputs are the ones of the second run. The reduction is disabled, since
+ * the warm start refers to the sets and the elements of the unreduced
+ * instance.
+ */
+void run_update(
+        const Instance& instance,
+        const po::variables_map& vm)
+{
+    std::string algorithm = vm["algorithm"].as<std::string>();
+    if (algorithm != "local-search-row-weighting") {
+        throw std::invalid_argument(
+                "Option --update-remove-sets is only available with algorithm "
+                "\"local-search-row-weighting\".");
+    }
+    if (vm.count("reduce") && vm["reduce"].as<bool>()) {
+        throw std::invalid_argument(
+                "Option --update-remove-sets is not available with the "
+                "reduction.");
+    }
+    std::mt19937_64 generator(vm["seed"].as<Seed>());
+    LocalSearchRowWeightingParameters parameters;
+    read_args(parameters, vm);
+    parameters.reduction_parameters.reduce = false;
+    if (vm.count("maximum-number-of-iterations")) {
+        parameters.maximum_number_of_iterations
+            = vm["maximum-number-of-iterations"].as<Counter>();
+    }
+    auto output = local_search_row_weighting(instance, generator, nullptr, parameters);
+
+    InstanceUpdate update(instance);
+    for (SetId set_id: vm["update-remove-sets"].as<std::vector<SetId>>())
+        update.remove_set(set_id);
+    Instance updated_instance = update.apply();
+    Solution initial_solution = update.update_solution(updated_instance, output.solution);
+    std::vector<Penalty> initial_penalties = update.update_penalties(output.penalties);
+    parameters.initial_penalties = &initial_penalties;
+    auto updated_output = local_search_row_weighting(updated_instance, generator, &initial_solution, parameters);
+    write_outputs(updated_output, vm);
+}
+
 int main(int argc, char *argv[])
 {
     // Parse program options
@@ -195,8 +276,12 @@ int main(int argc, char *argv[])
         ("format,f", po::value<std::string>()->default_value(""), "set input file format (default: standard)")
         ("certificate-format,", po::value<std::string>()->default_value(""), "set certificate file format (default: standard)")
         ("unicost,u", "set unicost")
+        ("parser-threads,", po::value<Counter>(), "set the number of threads used to read the input file")
+        ("write-instance,", po::value<std::string>(), "write the instance in binary format to a file")
+        ("renumbering,", po::value<std::string>(), "renumber sets and elements to improve memory locality (bfs, degree)")
         ("output,o", po::value<std::string>(), "set JSON output file")
         ("initial-solution,", po::value<std::string>(), "")
+        ("update-remove-sets,", po::value<std::vector<SetId>>()->multitoken(), "remove sets after solving, then solve the updated instance warm started")
         ("certificate,c", po::value<std::string>(), "set certificate file")
         ("goal,", po::value<Cost>(), "")
         ("seed,s", po::value<Seed>()->default_value(0), "set seed")
@@ -214,7 +299,17 @@ int main(int argc, char *argv[])
         ("dominated-sets,", po::value<bool>(), "enable dominated sets reduction")
         ("dominated-elements,", po::value<bool>(), "enable dominated elements reduction")
         ("linear-programming,", po::value<bool>(), "enable linear programming reduction")
+        ("linear-programming-maximum-number-of-iterations,", po::value<Counter>(), "set the maximum number of iterations of the subgradient algorithm of the linear programming reduction")
+        ("crown,", po::value<bool>(), "enable crown reduction")
+        ("crown-time-limit,", po::value<double>(), "set the time limit of each call of the crown reduction in seconds")
+        ("small-components-maximum-number-of-sets,", po::value<SetId>(), "set the maximum number of sets of the components solved exactly by the reduction")
+        ("adaptive-rule-scheduling,", po::value<bool>(), "skip the reduction rules whose yield is too low")
+        ("minimum-rule-yield,", po::value<double>(), "set the minimum yield of a reduction rule in removed sets and elements per second")
+        ("minimum-rule-time,", po::value<double>(), "set the minimum duration of a call of a reduction rule for it to be demoted")
         ("reduction-time-limit,", po::value<double>(), "set reduction time limit in seconds")
+        ("reduction-threads,", po::value<Counter>(), "set the number of threads used by the reduction")
+        ("save-reduction,", po::value<std::string>(), "write the reduction to a file")
+        ("load-reduction,", po::value<std::string>(), "load the reduction from a file instead of computing it")
 
         ("enable-new-solution-callback,", po::value<bool>(), "enable new solution callback")
 
@@ -238,27 +333,29 @@ int main(int argc, char *argv[])
 
     // Build instance.
     InstanceBuilder instance_builder;
+    if (vm.count("parser-threads"))
+        instance_builder.set_number_of_threads(vm["parser-threads"].as<Counter>());
+    if (vm.count("renumbering"))
+        instance_builder.set_renumbering(vm["renumbering"].as<std::string>());
     instance_builder.read(
             vm["input"].as<std::string>(),
             vm["format"].as<std::string>());
     if (vm.count("unicost"))
         instance_builder.set_unicost();
     const Instance instance = instance_builder.build();
+    if (vm.count("write-instance"))
+        instance.write(vm["write-instance"].as<std::string>(), "binary");
+
+    if (vm.count("update-remove-sets")) {
+        run_update(instance, vm);
+        return 0;
+    }
 
     // Run.
     Output output = run(instance, vm);
 
     // Write outputs.
-    if (vm.count("certificate")) {
-        std::string certificate_format = "";
-        if (vm.count("certificate-format"))
-            certificate_format = vm["certificate-format"].as<std::string>();
-        output.solution.write(
-                vm["certificate"].as<std::string>(),
-                certificate_format);
-    }
-    if (vm.count("output"))
-        output.write_json_output(vm["output"].as<std::string>());
+    write_outputs(output, vm);
 
     return 0;
 }
@@ -8,6 +8,17 @@
 #include "optimizationtools/containers/indexed_set.hpp"
 #include "optimizationtools/graph/bipartite_graph.hpp"
 
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+
 using namespace setcoveringsolver;
 
 bool Reduction::check(const ReductionInstance& reduction_instance)
@@ -20,7 +31,7 @@ bool Reduction::check(const ReductionInstance& reduction_instance)
         if (set.removed)
             continue;
         for (ElementId element_id: set.elements) {
-            const ReductionElement& element = reduction_instance.elements[element_id];
+            const ReductionElement& element = reduction_instance.element(element_id);
             if (element_id < 0
                     || element_id >= reduction_instance.number_of_elements()) {
                 throw std::logic_error(
@@ -49,7 +60,7 @@ bool Reduction::check(const ReductionInstance& reduction_instance)
         if (element.removed)
             continue;
         for (SetId set_id: element.sets) {
-            const ReductionSet& set = reduction_instance.sets[set_id];
+            const ReductionSet& set = reduction_instance.set(set_id);
             if (set_id < 0
                     || set_id >= reduction_instance.number_of_sets()) {
                 throw std::logic_error(
@@ -107,132 +118,281 @@ bool Reduction::check(const ReductionInstance& reduction_instance)
     return true;
 }
 
+void Reduction::AdjacencyLists::push_back(
+        Index list_id,
+        Index neighbor)
+{
+    if (this->sizes[list_id] == this->capacities[list_id]) {
+        // Move the list to the end of the array with a larger slice.
+        Counter start = this->arcs.size();
+        Index capacity = (std::max)((Index)4, 2 * this->capacities[list_id]);
+        this->arcs.resize(start + capacity);
+        std::copy(
+                this->arcs.begin() + this->starts[list_id],
+                this->arcs.begin() + this->starts[list_id] + this->sizes[list_id],
+                this->arcs.begin() + start);
+        this->starts[list_id] = start;
+        this->capacities[list_id] = capacity;
+    }
+    this->arcs[this->starts[list_id] + this->sizes[list_id]] = neighbor;
+    this->sizes[list_id]++;
+}
+
+bool Reduction::AdjacencyLists::remove(
+        Index list_id,
+        const optimizationtools::IndexedSet& neighbors)
+{
+    Index* first = this->arcs.data() + this->starts[list_id];
+    Index& size = this->sizes[list_id];
+    Index size_old = size;
+    for (Index pos = 0; pos < size;) {
+        if (neighbors.contains(first[pos])) {
+            size--;
+            first[pos] = first[size];
+        } else {
+            pos++;
+        }
+    }
+    return size != size_old;
+}
+
+void Reduction::AdjacencyLists::move(
+        Index list_id,
+        Index new_list_id)
+{
+    this->starts[new_list_id] = this->starts[list_id];
+    this->sizes[new_list_id] = this->sizes[list_id];
+    this->capacities[new_list_id] = this->capacities[list_id];
+}
+
+void Reduction::AdjacencyLists::pop_back()
+{
+    this->starts.pop_back();
+    this->sizes.pop_back();
+    this->capacities.pop_back();
+}
+
+void Reduction::AdjacencyLists::compact()
+{
+    // The slices are moved by increasing position, so that a slice never
+    // overwrites a slice which has not been moved yet.
+    std::vector<Index> list_ids(number_of_lists());
+    for (Index list_id = 0; list_id < number_of_lists(); ++list_id)
+        list_ids[list_id] = list_id;
+    std::sort(
+            list_ids.begin(),
+            list_ids.end(),
+            [this](Index list_id_1, Index list_id_2)
+            {
+                return this->starts[list_id_1] < this->starts[list_id_2];
+            });
+    Counter start = 0;
+    for (Index list_id: list_ids) {
+        std::copy(
+                this->arcs.begin() + this->starts[list_id],
+                this->arcs.begin() + this->starts[list_id] + this->sizes[list_id],
+                this->arcs.begin() + start);
+        this->starts[list_id] = start;
+        this->capacities[list_id] = this->sizes[list_id];
+        start += this->sizes[list_id];
+    }
+    this->arcs.resize(start);
+}
+
 Reduction::ReductionInstance Reduction::instance_to_reduction(
         const Instance& instance)
 {
     ReductionInstance reduction_instance;
-    reduction_instance.sets = std::vector<ReductionSet>(instance.number_of_sets());
+    reduction_instance.set_costs.resize(instance.number_of_sets());
+    reduction_instance.removed_sets.resize(instance.number_of_sets(), false);
+    AdjacencyLists& set_elements = reduction_instance.set_elements;
+    set_elements.starts.resize(instance.number_of_sets());
+    set_elements.sizes.resize(instance.number_of_sets());
+    set_elements.arcs.reserve(instance.number_of_arcs());
     for (SetId set_id = 0;
             set_id < instance.number_of_sets();
             ++set_id) {
-        reduction_instance.sets[set_id].cost = instance.set(set_id).cost;
-        reduction_instance.sets[set_id].elements = instance.set(set_id).elements;
+        const Set& set = instance.set(set_id);
+        reduction_instance.set_costs[set_id] = set.cost;
+        set_elements.starts[set_id] = set_elements.arcs.size();
+        set_elements.sizes[set_id] = set.elements.size();
+        set_elements.arcs.insert(
+                set_elements.arcs.end(),
+                set.elements.begin(),
+                set.elements.end());
     }
-    reduction_instance.elements = std::vector<ReductionElement>(instance.number_of_elements());
+    set_elements.capacities = set_elements.sizes;
+
+    reduction_instance.removed_elements.resize(instance.number_of_elements(), false);
+    AdjacencyLists& element_sets = reduction_instance.element_sets;
+    element_sets.starts.resize(instance.number_of_elements());
+    element_sets.sizes.resize(instance.number_of_elements());
+    element_sets.arcs.reserve(instance.number_of_arcs());
     for (ElementId element_id = 0;
             element_id < instance.number_of_elements();
             ++element_id) {
-        reduction_instance.elements[element_id].sets = instance.element(element_id).sets;
+        const Element& element = instance.element(element_id);
+        element_sets.starts[element_id] = element_sets.arcs.size();
+        element_sets.sizes[element_id] = element.sets.size();
+        element_sets.arcs.insert(
+                element_sets.arcs.end(),
+                element.sets.begin(),
+                element.sets.end());
     }
+    element_sets.capacities = element_sets.sizes;
+
+    reduction_instance.number_of_remaining_sets = instance.number_of_sets();
+    reduction_instance.number_of_remaining_elements = instance.number_of_elements();
+    reduction_instance.number_of_remaining_arcs = instance.number_of_arcs();
     //check(reduction_instance);
     return reduction_instance;
 }
 
 bool Reduction::needs_update(
-        ReductionInstance& reduction_instance)
+        const ReductionInstance& reduction_instance) const
 {
-    // Check number of sets.
-    SetId n = 0;
-    for (SetId set_id = 0;
-            set_id < reduction_instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = reduction_instance.set(set_id);
-        if (!set.removed)
-            n++;
-    }
-    if (n < 0.9 * reduction_instance.number_of_sets())
+    if (reduction_instance.number_of_remaining_sets
+            < 0.9 * reduction_instance.number_of_sets()) {
         return true;
-
-    // Check number of elements.
-    ElementId m = 0;
-    for (ElementId element_id = 0;
-            element_id < reduction_instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = reduction_instance.element(element_id);
-        if (!element.removed)
-            m++;
     }
-    if (m < 0.9 * reduction_instance.number_of_elements())
+    if (reduction_instance.number_of_remaining_elements
+            < 0.9 * reduction_instance.number_of_elements()) {
         return true;
-
+    }
     return false;
 }
 
-void Reduction::update(
-        ReductionInstance& reduction_instance,
-        std::vector<UnreductionOperations>& unreduction_operations)
+void Reduction::update(Tmp& tmp)
 {
+    tmp.number_of_updates++;
+    ReductionInstance& reduction_instance = tmp.instance;
+    std::vector<UnreductionOperations>& unreduction_operations = tmp.unreduction_operations;
     //std::cout << "update"
     //    << " m " << reduction_instance.number_of_elements()
     //    << " n " << reduction_instance.number_of_sets()
     //    << std::endl;
+
+    // Discard the removed sets. Each of them is replaced by the last set.
     std::vector<SetId> sets_original2reduced(reduction_instance.number_of_sets(), -1);
-    while (!reduction_instance.sets.empty()
-            && reduction_instance.sets.back().removed) {
-        reduction_instance.sets.pop_back();
+    auto pop_set = [&reduction_instance, &unreduction_operations]()
+    {
+        reduction_instance.set_costs.pop_back();
+        reduction_instance.removed_sets.pop_back();
+        reduction_instance.set_elements.pop_back();
         unreduction_operations.pop_back();
+    };
+    while (reduction_instance.number_of_sets() > 0
+            && reduction_instance.removed_sets.back()) {
+        pop_set();
     }
     for (SetId set_id = 0;
             set_id < reduction_instance.number_of_sets();
             ++set_id) {
-        ReductionSet& set = reduction_instance.set(set_id);
-        if (set.removed) {
-            reduction_instance.sets[set_id] = reduction_instance.sets.back();
-            unreduction_operations[set_id] = unreduction_operations.back();
-            sets_original2reduced[reduction_instance.number_of_sets() - 1] = set_id;
+        if (reduction_instance.removed_sets[set_id]) {
+            SetId set_id_2 = reduction_instance.number_of_sets() - 1;
+            reduction_instance.set_costs[set_id] = reduction_instance.set_costs[set_id_2];
+            reduction_instance.removed_sets[set_id] = false;
+            reduction_instance.set_elements.move(set_id_2, set_id);
+            unreduction_operations[set_id] = unreduction_operations[set_id_2];
+            sets_original2reduced[set_id_2] = set_id;
             sets_original2reduced[set_id] = -1;
-            reduction_instance.sets.pop_back();
-            unreduction_operations.pop_back();
-            while (!reduction_instance.sets.empty()
-                    && reduction_instance.sets.back().removed) {
-                reduction_instance.sets.pop_back();
-                unreduction_operations.pop_back();
+            pop_set();
+            while (reduction_instance.number_of_sets() > 0
+                    && reduction_instance.removed_sets.back()) {
+                pop_set();
             }
         } else {
             sets_original2reduced[set_id] = set_id;
         }
     }
 
+    // Discard the removed elements the same way.
     std::vector<ElementId> elements_original2reduced(reduction_instance.number_of_elements(), -1);
-    while (!reduction_instance.elements.empty()
-            && reduction_instance.elements.back().removed) {
-        reduction_instance.elements.pop_back();
+    auto pop_element = [&reduction_instance]()
+    {
+        reduction_instance.removed_elements.pop_back();
+        reduction_instance.element_sets.pop_back();
+    };
+    while (reduction_instance.number_of_elements() > 0
+            && reduction_instance.removed_elements.back()) {
+        pop_element();
     }
     for (ElementId element_id = 0;
             element_id < reduction_instance.number_of_elements();
             ++element_id) {
-        ReductionElement& element = reduction_instance.element(element_id);
-        if (element.removed) {
+        if (reduction_instance.removed_elements[element_id]) {
             ElementId element_id_2 = reduction_instance.number_of_elements() - 1;
-            reduction_instance.elements[element_id] = reduction_instance.elements.back();
+            reduction_instance.removed_elements[element_id] = false;
+            reduction_instance.element_sets.move(element_id_2, element_id);
             elements_original2reduced[element_id_2] = element_id;
             elements_original2reduced[element_id] = -1;
-            reduction_instance.elements.pop_back();
-            while (!reduction_instance.elements.empty()
-                    && reduction_instance.elements.back().removed) {
-                ElementId element_id_2 = reduction_instance.number_of_elements() - 1;
-                reduction_instance.elements.pop_back();
+            pop_element();
+            while (reduction_instance.number_of_elements() > 0
+                    && reduction_instance.removed_elements.back()) {
+                pop_element();
             }
         } else {
             elements_original2reduced[element_id] = element_id;
         }
     }
 
-    for (SetId set_id = 0;
-            set_id < reduction_instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = reduction_instance.set(set_id);
-        for (ElementId& element_id: set.elements)
-            element_id = elements_original2reduced[element_id];
+    // Compact the lists of the remaining sets and elements. Since these lists
+    // only contain remaining sets and elements, all the arcs left can be
+    // renumbered.
+    reduction_instance.set_elements.compact();
+    for (ElementId& element_id: reduction_instance.set_elements.arcs)
+        element_id = elements_original2reduced[element_id];
+    reduction_instance.element_sets.compact();
+    for (SetId& set_id: reduction_instance.element_sets.arcs)
+        set_id = sets_original2reduced[set_id];
+
+    // Renumber the logs of the modified sets and elements. The entries of
+    // removed sets and elements, and the entries already read by all the
+    // consumers, are discarded.
+    SetPos sets_log_start = tmp.modified_sets_log.size();
+    ElementPos elements_log_start = tmp.modified_elements_log.size();
+    for (const WorklistPosition& position: tmp.worklist_positions) {
+        if (!position.started)
+            continue;
+        sets_log_start = (std::min)(sets_log_start, position.sets_position);
+        elements_log_start = (std::min)(elements_log_start, position.elements_position);
     }
-
-    for (ElementId element_id = 0;
-            element_id < reduction_instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = reduction_instance.element(element_id);
-        for (SetId& set_id: element.sets)
-            set_id = sets_original2reduced[set_id];
+    std::vector<SetPos> sets_log_positions(tmp.modified_sets_log.size() - sets_log_start + 1, 0);
+    SetPos sets_log_size = 0;
+    for (SetPos pos = sets_log_start;
+            pos < (SetPos)tmp.modified_sets_log.size();
+            ++pos) {
+        sets_log_positions[pos - sets_log_start] = sets_log_size;
+        SetId set_id = sets_original2reduced[tmp.modified_sets_log[pos]];
+        if (set_id != -1) {
+            tmp.modified_sets_log[sets_log_size] = set_id;
+            sets_log_size++;
+        }
+    }
+    sets_log_positions.back() = sets_log_size;
+    tmp.modified_sets_log.resize(sets_log_size);
+    std::vector<ElementPos> elements_log_positions(tmp.modified_elements_log.size() - elements_log_start + 1, 0);
+    ElementPos elements_log_size = 0;
+    for (ElementPos pos = elements_log_start;
+            pos < (ElementPos)tmp.modified_elements_log.size();
+            ++pos) {
+        elements_log_positions[pos - elements_log_start] = elements_log_size;
+        ElementId element_id = elements_original2reduced[tmp.modified_elements_log[pos]];
+        if (element_id != -1) {
+            tmp.modified_elements_log[elements_log_size] = element_id;
+            elements_log_size++;
+        }
+    }
+    elements_log_positions.back() = elements_log_size;
+    tmp.modified_elements_log.resize(elements_log_size);
+    for (WorklistPosition& position: tmp.worklist_positions) {
+        if (!position.started)
+            continue;
+        position.sets_position = sets_log_positions[position.sets_position - sets_log_start];
+        position.elements_position = elements_log_positions[position.elements_position - elements_log_start];
     }
+    // The signatures are indexed by the former ids.
+    tmp.worklist_positions[(int)WorklistConsumer::Signatures].started = false;
 
     //std::cout << "      "
     //    << " m " << reduction_instance.number_of_elements()
@@ -242,23 +402,168 @@ void Reduction::update(
 }
 
 Instance Reduction::reduction_to_instance(
-        const ReductionInstance& reduction_instance)
+        const ReductionInstance& reduction_instance,
+        const ReductionParameters& parameters)
 {
     //std::cout << "reduction_to_instance" << std::endl;
     InstanceBuilder instance_builder;
+    instance_builder.set_number_of_threads(parameters.number_of_threads);
     instance_builder.add_sets(reduction_instance.number_of_sets());
     instance_builder.add_elements(reduction_instance.number_of_elements());
+    std::vector<ElementPos> numbers_of_elements(reduction_instance.number_of_sets());
+    for (SetId set_id = 0;
+            set_id < reduction_instance.number_of_sets();
+            ++set_id) {
+        numbers_of_elements[set_id] = reduction_instance.set(set_id).elements.size();
+    }
+    instance_builder.set_numbers_of_elements(numbers_of_elements);
     for (SetId set_id = 0;
             set_id < reduction_instance.number_of_sets();
             ++set_id) {
         const ReductionSet& set = reduction_instance.set(set_id);
         instance_builder.set_cost(set_id, set.cost);
-        for (ElementId element_id: set.elements)
-            instance_builder.add_arc(set_id, element_id);
+        std::copy(
+                set.elements.begin(),
+                set.elements.end(),
+                instance_builder.set_elements(set_id));
     }
     return instance_builder.build();
 }
 
+void Reduction::remove_sets(
+        Tmp& tmp,
+        const optimizationtools::IndexedSet& sets_to_remove)
+{
+    ReductionInstance& reduction_instance = tmp.instance;
+    Counter number_of_removed_arcs = 0;
+    for (SetId set_id: sets_to_remove) {
+        if (reduction_instance.removed_sets[set_id])
+            continue;
+        reduction_instance.removed_sets[set_id] = true;
+        number_of_removed_arcs += reduction_instance.set_elements.sizes[set_id];
+        reduction_instance.number_of_remaining_sets--;
+    }
+    reduction_instance.number_of_remaining_arcs -= number_of_removed_arcs;
+
+    if (number_of_removed_arcs > reduction_instance.number_of_elements() / 4) {
+        // Most of the elements are affected, scanning all of them is faster.
+        for (ElementId element_id = 0;
+                element_id < reduction_instance.number_of_elements();
+                ++element_id) {
+            if (reduction_instance.removed_elements[element_id])
+                continue;
+            if (reduction_instance.element_sets.remove(element_id, sets_to_remove))
+                tmp.modified_elements_log.push_back(element_id);
+        }
+        return;
+    }
+
+    // Otherwise, only the lists of the elements covered by a removed set are
+    // modified.
+    optimizationtools::IndexedSet& affected_elements = tmp.affected_;
+    affected_elements.clear();
+    for (SetId set_id: sets_to_remove) {
+        for (ElementId element_id: reduction_instance.set(set_id).elements) {
+            if (reduction_instance.removed_elements[element_id])
+                continue;
+            affected_elements.add(element_id);
+        }
+    }
+    for (ElementId element_id: affected_elements) {
+        reduction_instance.element_sets.remove(element_id, sets_to_remove);
+        tmp.modified_elements_log.push_back(element_id);
+    }
+}
+
+void Reduction::remove_elements(
+        Tmp& tmp,
+        const optimizationtools::IndexedSet& elements_to_remove)
+{
+    ReductionInstance& reduction_instance = tmp.instance;
+    Counter number_of_removed_arcs = 0;
+    for (ElementId element_id: elements_to_remove) {
+        if (reduction_instance.removed_elements[element_id])
+            continue;
+        reduction_instance.removed_elements[element_id] = true;
+        number_of_removed_arcs += reduction_instance.element_sets.sizes[element_id];
+        reduction_instance.number_of_remaining_elements--;
+    }
+    reduction_instance.number_of_remaining_arcs -= number_of_removed_arcs;
+
+    if (number_of_removed_arcs > reduction_instance.number_of_sets() / 4) {
+        // Most of the sets are affected, scanning all of them is faster.
+        for (SetId set_id = 0;
+                set_id < reduction_instance.number_of_sets();
+                ++set_id) {
+            if (reduction_instance.removed_sets[set_id])
+                continue;
+            if (reduction_instance.set_elements.remove(set_id, elements_to_remove))
+                tmp.modified_sets_log.push_back(set_id);
+        }
+        return;
+    }
+
+    // Otherwise, only the lists of the sets covering a removed element are
+    // modified.
+    optimizationtools::IndexedSet& affected_sets = tmp.affected_;
+    affected_sets.clear();
+    for (ElementId element_id: elements_to_remove) {
+        for (SetId set_id: reduction_instance.element(element_id).sets) {
+            if (reduction_instance.removed_sets[set_id])
+                continue;
+            affected_sets.add(set_id);
+        }
+    }
+    for (SetId set_id: affected_sets) {
+        reduction_instance.set_elements.remove(set_id, elements_to_remove);
+        tmp.modified_sets_log.push_back(set_id);
+    }
+}
+
+bool Reduction::collect_modified(
+        Tmp& tmp,
+        WorklistConsumer consumer)
+{
+    WorklistPosition& position = tmp.worklist_positions[(int)consumer];
+    tmp.modified_sets.clear();
+    tmp.modified_elements.clear();
+    bool started = position.started;
+    if (started) {
+        for (SetPos pos = position.sets_position;
+                pos < (SetPos)tmp.modified_sets_log.size();
+                ++pos) {
+            SetId set_id = tmp.modified_sets_log[pos];
+            if (!tmp.instance.set(set_id).removed)
+                tmp.modified_sets.add(set_id);
+        }
+        for (ElementPos pos = position.elements_position;
+                pos < (ElementPos)tmp.modified_elements_log.size();
+                ++pos) {
+            ElementId element_id = tmp.modified_elements_log[pos];
+            if (!tmp.instance.element(element_id).removed)
+                tmp.modified_elements.add(element_id);
+        }
+    }
+    position.started = true;
+    position.sets_position = tmp.modified_sets_log.size();
+    position.elements_position = tmp.modified_elements_log.size();
+    return started;
+}
+
+void Reduction::add_elements_of_modified_sets(Tmp& tmp)
+{
+    for (SetId set_id: tmp.modified_sets)
+        for (ElementId element_id: tmp.instance.set(set_id).elements)
+            tmp.modified_elements.add(element_id);
+}
+
+void Reduction::add_sets_of_modified_elements(Tmp& tmp)
+{
+    for (ElementId element_id: tmp.modified_elements)
+        for (SetId set_id: tmp.instance.element(element_id).sets)
+            tmp.modified_sets.add(set_id);
+}
+
 bool Reduction::reduce_mandatory_sets(Tmp& tmp)
 {
     //std::cout << "remove_mandatory_sets..." << std::endl;
@@ -278,21 +583,30 @@ bool Reduction::reduce_mandatory_sets(Tmp& tmp)
     optimizationtools::IndexedSet& touched_elements = tmp.indexed_set_7_;
     touched_elements.resize_and_clear(tmp.instance.number_of_elements());
 
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        const ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        touched_sets.add(set_id);
-    }
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        const ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        touched_elements.add(element_id);
+    // A set or an element can only become mandatory or be removed if its
+    // list has been modified since the previous call.
+    if (collect_modified(tmp, WorklistConsumer::MandatorySets)) {
+        for (SetId set_id: tmp.modified_sets)
+            touched_sets.add(set_id);
+        for (ElementId element_id: tmp.modified_elements)
+            touched_elements.add(element_id);
+    } else {
+        for (SetId set_id = 0;
+                set_id < tmp.instance.number_of_sets();
+                ++set_id) {
+            const ReductionSet& set = tmp.instance.set(set_id);
+            if (set.removed)
+                continue;
+            touched_sets.add(set_id);
+        }
+        for (ElementId element_id = 0;
+                element_id < tmp.instance.number_of_elements();
+                ++element_id) {
+            const ReductionElement& element = tmp.instance.element(element_id);
+            if (element.removed)
+                continue;
+            touched_elements.add(element_id);
+        }
     }
     for (int i = 0; /*i < 4096*/; ++i) {
 
@@ -383,155 +697,340 @@ bool Reduction::reduce_mandatory_sets(Tmp& tmp)
     // Update mandatory_sets.
     for (SetId set_id: sets_to_remove) {
         if (fixed_sets.contains(set_id)) {
-            for (SetId orig_set_id: unreduction_operations_[set_id].in)
-                mandatory_sets_.push_back(orig_set_id);
-        } else {
-            for (SetId orig_set_id: unreduction_operations_[set_id].out)
-                mandatory_sets_.push_back(orig_set_id);
-        }
-    }
-    // Update sets.
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        if (sets_to_remove.contains(set_id)) {
-            set.removed = true;
-        } else {
-            for (ElementPos pos = 0;
-                    pos < (ElementPos)set.elements.size();
-                    ) {
-                ElementId element_id = set.elements[pos];
-                if (elements_to_remove.contains(element_id)) {
-                    set.elements[pos] = set.elements.back();
-                    set.elements.pop_back();
-                } else {
-                    pos++;
-                }
-            }
-        }
-    }
-    // Update elements.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        if (elements_to_remove.contains(element_id)) {
-            element.removed = true;
+            for (SetId orig_set_id: tmp.unreduction_operations[set_id].in)
+                tmp.mandatory_sets.push_back(orig_set_id);
         } else {
-            for (ElementPos pos = 0;
-                    pos < (ElementPos)element.sets.size();
-                    ) {
-                ElementId set_id = element.sets[pos];
-                if (sets_to_remove.contains(set_id)) {
-                    element.sets[pos] = element.sets.back();
-                    element.sets.pop_back();
-                } else {
-                    pos++;
-                }
-            }
+            for (SetId orig_set_id: tmp.unreduction_operations[set_id].out)
+                tmp.mandatory_sets.push_back(orig_set_id);
         }
     }
+    remove_elements(tmp, elements_to_remove);
+    remove_sets(tmp, sets_to_remove);
 
     //check(tmp.instance);
     if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
+        update(tmp);
     return true;
 }
 
-bool Reduction::reduce_identical_elements(Tmp& tmp)
+namespace
 {
-    //std::cout << "reduce_identical_elements..." << std::endl;
 
-    // Compute hashes.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        const ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        int64_t hash = 0;
-        for (SetId set_id: element.sets)
-            hash ^= tmp.random_[set_id];
-        tmp.hashes_[element_id] = hash;
+/** Minimum number of items handled by each thread of the parallel loops. */
+const Counter parallel_for_minimum_number_of_items = 1 << 16;
+
+/**
+ * Compute the number of threads used by 'parallel_for' for 'number_of_items'
+ * items.
+ */
+Counter parallel_for_number_of_threads(
+        Counter number_of_items,
+        Counter number_of_threads)
+{
+    return (std::max)((Counter)1, (std::min)(
+                number_of_threads,
+                number_of_items / parallel_for_minimum_number_of_items));
+}
+
+/**
+ * Call 'function(thread_id, begin, end)' on 'number_of_threads' consecutive
+ * slices of [0, number_of_items), in parallel.
+ */
+template <typename Function>
+void parallel_for(
+        Counter number_of_items,
+        Counter number_of_threads,
+        const Function& function)
+{
+    if (number_of_threads <= 1) {
+        function(0, 0, number_of_items);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([&function, number_of_items, number_of_threads, thread_id]()
+        {
+            function(
+                    thread_id,
+                    thread_id * number_of_items / number_of_threads,
+                    (thread_id + 1) * number_of_items / number_of_threads);
+        }));
     }
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id)
+        threads[thread_id].join();
+}
 
-    std::vector<std::vector<ElementId>> elements_by_number_of_sets_covering;
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        const ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        while (elements_by_number_of_sets_covering.size()
-                <= element.sets.size()) {
-            elements_by_number_of_sets_covering.push_back({});
+/** Number of bits of the digits of the radix sort. */
+const int radix_sort_number_of_bits = 11;
+
+/**
+ * Sort items with a parallel LSD radix sort.
+ *
+ * The items are sorted by 'key_function(item, number_of_keys - 1)', then by
+ * 'key_function(item, number_of_keys - 2)', etc. The sort is stable. Only
+ * the significant digits of each key are considered, and the passes in which
+ * all the items have the same digit are skipped.
+ */
+template <typename Item, typename KeyFunction>
+void radix_sort(
+        std::vector<Item>& items,
+        std::vector<Item>& buffer,
+        int number_of_keys,
+        const KeyFunction& key_function,
+        Counter number_of_threads)
+{
+    const Counter number_of_buckets = (Counter)1 << radix_sort_number_of_bits;
+    Counter number_of_items = items.size();
+    number_of_threads = parallel_for_number_of_threads(number_of_items, number_of_threads);
+    buffer.resize(number_of_items);
+    std::vector<uint64_t> threads_masks(number_of_threads);
+    std::vector<Counter> histograms(number_of_threads * number_of_buckets);
+    for (int key_id = 0; key_id < number_of_keys; ++key_id) {
+
+        // Find the significant bits of the key.
+        parallel_for(
+                number_of_items,
+                number_of_threads,
+                [&items, &key_function, &threads_masks, key_id](
+                    Counter thread_id,
+                    Counter begin,
+                    Counter end)
+                {
+                    uint64_t mask = 0;
+                    for (Counter pos = begin; pos < end; ++pos)
+                        mask |= key_function(items[pos], key_id);
+                    threads_masks[thread_id] = mask;
+                });
+        uint64_t mask = 0;
+        for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id)
+            mask |= threads_masks[thread_id];
+
+        for (int shift = 0;
+                shift < 64 && (mask >> shift) != 0;
+                shift += radix_sort_number_of_bits) {
+
+            // Count the items of each bucket in each slice.
+            parallel_for(
+                    number_of_items,
+                    number_of_threads,
+                    [&items, &key_function, &histograms, number_of_buckets, key_id, shift](
+                        Counter thread_id,
+                        Counter begin,
+                        Counter end)
+                    {
+                        Counter* histogram = &histograms[thread_id * number_of_buckets];
+                        std::fill(histogram, histogram + number_of_buckets, 0);
+                        for (Counter pos = begin; pos < end; ++pos) {
+                            uint64_t key = key_function(items[pos], key_id);
+                            histogram[(key >> shift) & (number_of_buckets - 1)]++;
+                        }
+                    });
+
+            // Compute the first position of each bucket in each slice.
+            Counter offset = 0;
+            bool skip = false;
+            for (Counter bucket = 0; bucket < number_of_buckets; ++bucket) {
+                Counter bucket_size = 0;
+                for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+                    Counter& count = histograms[thread_id * number_of_buckets + bucket];
+                    Counter c = count;
+                    count = offset + bucket_size;
+                    bucket_size += c;
+                }
+                if (bucket_size == number_of_items)
+                    skip = true;
+                offset += bucket_size;
+            }
+            if (skip)
+                continue;
+
+            // Move the items.
+            parallel_for(
+                    number_of_items,
+                    number_of_threads,
+                    [&items, &buffer, &key_function, &histograms, number_of_buckets, key_id, shift](
+                        Counter thread_id,
+                        Counter begin,
+                        Counter end)
+                    {
+                        Counter* histogram = &histograms[thread_id * number_of_buckets];
+                        for (Counter pos = begin; pos < end; ++pos) {
+                            uint64_t key = key_function(items[pos], key_id);
+                            buffer[histogram[(key >> shift) & (number_of_buckets - 1)]++] = items[pos];
+                        }
+                    });
+            items.swap(buffer);
         }
-        elements_by_number_of_sets_covering[element.sets.size()].push_back(element_id);
     }
+}
+
+/** Set or element with the hash of its list, grouped by the radix sort. */
+struct HashedItem
+{
+    /** Hash of the list. */
+    uint64_t hash;
+
+    /** Size of the list. */
+    uint64_t size;
+
+    /** Id of the set or of the element. */
+    Counter id;
+};
+
+/**
+ * Compute the hashes of the lists of the sets or of the elements in parallel
+ * and sort them by size and hash.
+ *
+ * The removed lists are discarded. The items with the same size and hash
+ * remain in increasing order of id.
+ */
+template <typename AdjacencyLists>
+void sort_by_size_and_hash(
+        const AdjacencyLists& lists,
+        const std::vector<bool>& removed,
+        const std::vector<uint64_t>& random,
+        std::vector<HashedItem>& items,
+        std::vector<HashedItem>& buffer,
+        Counter number_of_threads)
+{
+    Counter number_of_lists = lists.number_of_lists();
+    items.resize(number_of_lists);
+    parallel_for(
+            number_of_lists,
+            parallel_for_number_of_threads(number_of_lists, number_of_threads),
+            [&lists, &removed, &random, &items](
+                Counter,
+                Counter begin,
+                Counter end)
+            {
+                for (Counter list_id = begin; list_id < end; ++list_id) {
+                    HashedItem& item = items[list_id];
+                    item.id = list_id;
+                    item.hash = 0;
+                    for (Counter neighbor_id: lists.list(list_id))
+                        item.hash ^= random[neighbor_id];
+                    // The removed lists are moved to the end.
+                    item.size = (removed[list_id])?
+                        std::numeric_limits<uint64_t>::max():
+                        lists.list(list_id).size();
+                }
+            });
+    radix_sort(
+            items,
+            buffer,
+            2,
+            [](const HashedItem& item, int key_id) -> uint64_t
+            {
+                return (key_id == 0)? item.hash: item.size;
+            },
+            number_of_threads);
+    while (!items.empty()
+            && items.back().size == std::numeric_limits<uint64_t>::max()) {
+        items.pop_back();
+    }
+}
+
+}
+
+bool Reduction::reduce_identical_elements(
+        Tmp& tmp,
+        const ReductionParameters& parameters)
+{
+    //std::cout << "reduce_identical_elements..." << std::endl;
 
     optimizationtools::IndexedSet& elements_to_remove = tmp.indexed_set_2_;
     elements_to_remove.resize_and_clear(tmp.instance.number_of_elements());
     optimizationtools::IndexedSet& covering_sets = tmp.indexed_set_;
     covering_sets.resize_and_clear(tmp.instance.number_of_sets());
-    for (SetPos n = 0;
-            n < (SetPos)elements_by_number_of_sets_covering.size();
-            ++n) {
-
-        // Compute sorted elements.
-        std::vector<ElementId>& elements_sorted = elements_by_number_of_sets_covering[n];
-        if (elements_sorted.empty())
-            continue;
-        sort(elements_sorted.begin(), elements_sorted.end(),
-                [this, &tmp](ElementId element_id_1, ElementId element_id_2) -> bool
-                {
-                    if (tmp.hashes_[element_id_1] != tmp.hashes_[element_id_2])
-                        return tmp.hashes_[element_id_1] < tmp.hashes_[element_id_2];
-                    const ReductionElement& element_1 = tmp.instance.element(element_id_1);
-                    const ReductionElement& element_2 = tmp.instance.element(element_id_2);
-                    return element_1.sets.size() < element_2.sets.size();
-                });
 
-        for (ElementPos element_pos = 0;
-                element_pos < (ElementPos)elements_sorted.size();
-                ++element_pos) {
-            ElementId element_id = elements_sorted[element_pos];
+    if (collect_modified(tmp, WorklistConsumer::IdenticalElements)) {
+        // Two elements can only have become identical if one of them has
+        // been modified since the previous call. The elements identical to a
+        // modified element are all covered by each of its sets, so only the
+        // elements of its smallest set are checked.
+        for (ElementId element_id: tmp.modified_elements) {
             const ReductionElement& element = tmp.instance.element(element_id);
+            if (element.sets.empty())
+                continue;
+            SetId smallest_set_id = element.sets[0];
+            for (SetId set_id: element.sets) {
+                if (tmp.instance.set(set_id).elements.size()
+                        < tmp.instance.set(smallest_set_id).elements.size()) {
+                    smallest_set_id = set_id;
+                }
+            }
 
-            bool identical = false;
             covering_sets.clear();
-            for (ElementPos element_pos_prev = element_pos - 1;; --element_pos_prev) {
-                if (element_pos_prev < 0)
-                    break;
-                ElementId element_id_prev = elements_sorted[element_pos_prev];
-                const ReductionElement& element_prev = tmp.instance.element(element_id_prev);
-                if (tmp.hashes_[element_id] != tmp.hashes_[element_id_prev])
-                    break;
-                if (element.sets.size() != element_prev.sets.size())
-                    break;
-                if (covering_sets.empty()) {
-                    for (ElementId element_id: element.sets)
-                        covering_sets.add(element_id);
+            for (SetId set_id: element.sets)
+                covering_sets.add(set_id);
+            for (ElementId element_id_2: tmp.instance.set(smallest_set_id).elements) {
+                if (element_id_2 == element_id
+                        || elements_to_remove.contains(element_id_2)) {
+                    continue;
                 }
-                bool identical_cur = true;
-                for (ElementId element_id: element_prev.sets) {
-                    if (!covering_sets.contains(element_id)) {
-                        identical_cur = false;
+                const ReductionElement& element_2 = tmp.instance.element(element_id_2);
+                if (element_2.sets.size() != element.sets.size())
+                    continue;
+                bool identical = true;
+                for (SetId set_id: element_2.sets) {
+                    if (!covering_sets.contains(set_id)) {
+                        identical = false;
                         break;
                     }
                 }
-                if (identical_cur) {
-                    identical = true;
+                if (identical) {
+                    elements_to_remove.add(element_id);
                     break;
                 }
             }
+        }
+    } else {
+        // Group the elements by number of sets and hash. Only the elements of
+        // a same group may be identical.
+        std::vector<HashedItem> items;
+        std::vector<HashedItem> buffer;
+        sort_by_size_and_hash(
+                tmp.instance.element_sets,
+                tmp.instance.removed_elements,
+                tmp.random_,
+                items,
+                buffer,
+                parameters.number_of_threads);
+
+        for (Counter group_start = 0, group_end = 0;
+                group_start < (Counter)items.size();
+                group_start = group_end) {
+            while (group_end < (Counter)items.size()
+                    && items[group_end].hash == items[group_start].hash
+                    && items[group_end].size == items[group_start].size) {
+                group_end++;
+            }
+            if (group_end - group_start == 1)
+                continue;
 
-            if (identical)
-                elements_to_remove.add(element_id);
+            // An element is removed if it is identical to a previous element
+            // of its group.
+            for (Counter pos = group_start + 1; pos < group_end; ++pos) {
+                ElementId element_id = items[pos].id;
+                const ReductionElement& element = tmp.instance.element(element_id);
+                covering_sets.clear();
+                for (SetId set_id: element.sets)
+                    covering_sets.add(set_id);
+                for (Counter pos_prev = group_start; pos_prev < pos; ++pos_prev) {
+                    const ReductionElement& element_prev = tmp.instance.element(items[pos_prev].id);
+                    bool identical = true;
+                    for (SetId set_id: element_prev.sets) {
+                        if (!covering_sets.contains(set_id)) {
+                            identical = false;
+                            break;
+                        }
+                    }
+                    if (identical) {
+                        elements_to_remove.add(element_id);
+                        break;
+                    }
+                }
+            }
         }
     }
 
@@ -540,138 +1039,126 @@ bool Reduction::reduce_identical_elements(Tmp& tmp)
 
     //std::cout << elements_to_remove.size() << std::endl;
 
-    // Update sets.
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        for (ElementPos pos = 0;
-                pos < (ElementPos)set.elements.size();
-                ) {
-            ElementId element_id = set.elements[pos];
-            if (elements_to_remove.contains(element_id)) {
-                set.elements[pos] = set.elements.back();
-                set.elements.pop_back();
-            } else {
-                pos++;
-            }
-        }
-    }
-    // Update elements.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        if (elements_to_remove.contains(element_id))
-            element.removed = true;
-    }
+    remove_elements(tmp, elements_to_remove);
 
     //check(tmp.instance);
     if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
+        update(tmp);
     return true;
 }
 
-bool Reduction::reduce_identical_sets(Tmp& tmp)
-{
+bool Reduction::reduce_identical_sets(
+        Tmp& tmp,
+        const ReductionParameters& parameters)
+{
     //std::cout << "reduce_identical_sets..." << std::endl;
 
-    // Compute hashes.
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        const ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        int64_t hash = 0;
-        for (SetId element_id: set.elements)
-            hash ^= tmp.random_[element_id];
-        tmp.hashes_[set_id] = hash;
-    }
-
-    std::vector<std::vector<SetId>> sets_by_number_of_elements_covered;
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        const ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        while (sets_by_number_of_elements_covered.size()
-                <= set.elements.size()) {
-            sets_by_number_of_elements_covered.push_back({});
-        }
-        sets_by_number_of_elements_covered[set.elements.size()].push_back(set_id);
-    }
-
     optimizationtools::IndexedSet& sets_to_remove = tmp.indexed_set_2_;
     sets_to_remove.resize_and_clear(tmp.instance.number_of_sets());
     optimizationtools::IndexedSet& covered_elements = tmp.indexed_set_;
     covered_elements.resize_and_clear(tmp.instance.number_of_elements());
-    for (ElementPos m = 0;
-            m < (ElementPos)sets_by_number_of_elements_covered.size();
-            ++m) {
-
-        // Compute sorted sets.
-        std::vector<SetId>& sets_sorted = sets_by_number_of_elements_covered[m];
-        if (sets_sorted.empty())
-            continue;
-        sort(sets_sorted.begin(), sets_sorted.end(),
-                [this, &tmp](SetId set_id_1, SetId set_id_2) -> bool
-                {
-                    if (tmp.hashes_[set_id_1] != tmp.hashes_[set_id_2])
-                        return tmp.hashes_[set_id_1] < tmp.hashes_[set_id_2];
-                    const ReductionSet& set_1 = tmp.instance.set(set_id_1);
-                    const ReductionSet& set_2 = tmp.instance.set(set_id_2);
-                    return tmp.instance.set(set_id_1).cost > tmp.instance.set(set_id_2).cost;
-                });
 
-        for (SetPos set_pos = 0;
-                set_pos < (SetPos)sets_sorted.size();
-                ++set_pos) {
-            SetId set_id = sets_sorted[set_pos];
+    if (collect_modified(tmp, WorklistConsumer::IdenticalSets)) {
+        // Two sets can only have become identical if one of them has been
+        // modified since the previous call. The sets identical to a modified
+        // set all cover each of its elements, so only the sets of its element
+        // covered by the fewest sets are checked.
+        for (SetId set_id: tmp.modified_sets) {
             const ReductionSet& set = tmp.instance.set(set_id);
-
             if (set.elements.size() == 0) {
                 sets_to_remove.add(set_id);
                 continue;
             }
+            ElementId rarest_element_id = set.elements[0];
+            for (ElementId element_id: set.elements) {
+                if (tmp.instance.element(element_id).sets.size()
+                        < tmp.instance.element(rarest_element_id).sets.size()) {
+                    rarest_element_id = element_id;
+                }
+            }
 
-            bool identical = false;
             covered_elements.clear();
-            for (SetPos set_pos_prev = set_pos - 1;; --set_pos_prev) {
-                if (set_pos_prev < 0)
-                    break;
-                SetId set_id_prev = sets_sorted[set_pos_prev];
-                const ReductionSet& set_prev = tmp.instance.set(set_id_prev);
-                if (tmp.hashes_[set_id] != tmp.hashes_[set_id_prev])
-                    break;
-                if (set.elements.size() != set_prev.elements.size())
-                    break;
-                if (set.cost != set_prev.cost)
-                    break;
-                if (covered_elements.empty()) {
-                    for (ElementId element_id: set.elements)
-                        covered_elements.add(element_id);
+            for (ElementId element_id: set.elements)
+                covered_elements.add(element_id);
+            for (SetId set_id_2: tmp.instance.element(rarest_element_id).sets) {
+                if (set_id_2 == set_id
+                        || sets_to_remove.contains(set_id_2)) {
+                    continue;
                 }
-                bool identical_cur = true;
-                for (ElementId element_id: set_prev.elements) {
+                const ReductionSet& set_2 = tmp.instance.set(set_id_2);
+                if (set_2.elements.size() != set.elements.size())
+                    continue;
+                if (set_2.cost != set.cost)
+                    continue;
+                bool identical = true;
+                for (ElementId element_id: set_2.elements) {
                     if (!covered_elements.contains(element_id)) {
-                        identical_cur = false;
+                        identical = false;
                         break;
                     }
                 }
-                if (identical_cur) {
-                    identical = true;
+                if (identical) {
+                    sets_to_remove.add(set_id);
                     break;
                 }
             }
+        }
+    } else {
+        // Group the sets by number of elements and hash. Only the sets of a
+        // same group may be identical.
+        std::vector<HashedItem> items;
+        std::vector<HashedItem> buffer;
+        sort_by_size_and_hash(
+                tmp.instance.set_elements,
+                tmp.instance.removed_sets,
+                tmp.random_,
+                items,
+                buffer,
+                parameters.number_of_threads);
+
+        for (Counter group_start = 0, group_end = 0;
+                group_start < (Counter)items.size();
+                group_start = group_end) {
+            while (group_end < (Counter)items.size()
+                    && items[group_end].hash == items[group_start].hash
+                    && items[group_end].size == items[group_start].size) {
+                group_end++;
+            }
 
-            if (identical)
-                sets_to_remove.add(set_id);
+            // Empty sets are always removed.
+            if (items[group_start].size == 0) {
+                for (Counter pos = group_start; pos < group_end; ++pos)
+                    sets_to_remove.add(items[pos].id);
+                continue;
+            }
+            if (group_end - group_start == 1)
+                continue;
+
+            // A set is removed if it is identical to a previous set of its
+            // group with the same cost.
+            for (Counter pos = group_start + 1; pos < group_end; ++pos) {
+                SetId set_id = items[pos].id;
+                const ReductionSet& set = tmp.instance.set(set_id);
+                covered_elements.clear();
+                for (ElementId element_id: set.elements)
+                    covered_elements.add(element_id);
+                for (Counter pos_prev = group_start; pos_prev < pos; ++pos_prev) {
+                    const ReductionSet& set_prev = tmp.instance.set(items[pos_prev].id);
+                    if (set_prev.cost != set.cost)
+                        continue;
+                    bool identical = true;
+                    for (ElementId element_id: set_prev.elements) {
+                        if (!covered_elements.contains(element_id)) {
+                            identical = false;
+                            break;
+                        }
+                    }
+                    if (identical) {
+                        sets_to_remove.add(set_id);
+                        break;
+                    }
+                }
+            }
         }
     }
 
@@ -682,41 +1169,13 @@ bool Reduction::reduce_identical_sets(Tmp& tmp)
 
     // Update mandatory_sets.
     for (SetId set_id: sets_to_remove)
-        for (SetId orig_set_id: unreduction_operations_[set_id].out)
-            mandatory_sets_.push_back(orig_set_id);
-    // Update sets.
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        if (sets_to_remove.contains(set_id))
-            set.removed = true;
-    }
-    // Update elements.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        for (ElementPos pos = 0;
-                pos < (ElementPos)element.sets.size();
-                ) {
-            ElementId set_id = element.sets[pos];
-            if (sets_to_remove.contains(set_id)) {
-                element.sets[pos] = element.sets.back();
-                element.sets.pop_back();
-            } else {
-                pos++;
-            }
-        }
-    }
+        for (SetId orig_set_id: tmp.unreduction_operations[set_id].out)
+            tmp.mandatory_sets.push_back(orig_set_id);
+    remove_sets(tmp, sets_to_remove);
 
     //check(tmp.instance);
     if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
+        update(tmp);
     return true;
 }
 
@@ -735,10 +1194,20 @@ bool Reduction::reduce_set_folding(Tmp& tmp)
     optimizationtools::IndexedSet& covered_elements_2 = tmp.indexed_set_4_;
     covered_elements_2.resize_and_clear(tmp.instance.number_of_elements());
 
+    std::vector<SetId>& candidates = tmp.set_;
+    if (collect_modified(tmp, WorklistConsumer::SetFolding)) {
+        // A set can only have become foldable if its elements, the sets of
+        // its elements or the elements of its neighbors have been modified.
+        add_elements_of_modified_sets(tmp);
+        add_sets_of_modified_elements(tmp);
+        candidates.assign(tmp.modified_sets.begin(), tmp.modified_sets.end());
+    } else {
+        candidates.resize(tmp.instance.number_of_sets());
+        std::iota(candidates.begin(), candidates.end(), 0);
+    }
+
     std::vector<std::tuple<SetId, SetId, SetId>> folded_sets_list;
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
+    for (SetId set_id: candidates) {
         const ReductionSet& set = tmp.instance.set(set_id);
         if (set.removed)
             continue;
@@ -839,9 +1308,9 @@ bool Reduction::reduce_set_folding(Tmp& tmp)
         SetId set_id = std::get<0>(tuple);
         SetId neighbor_id_1 = std::get<1>(tuple);
         SetId neighbor_id_2 = std::get<2>(tuple);
-        ReductionSet& set = tmp.instance.set(set_id);
-        ReductionSet& neighbor_1 = tmp.instance.set(neighbor_id_1);
-        ReductionSet& neighbor_2 = tmp.instance.set(neighbor_id_2);
+        const ReductionSet& set = tmp.instance.set(set_id);
+        const ReductionSet& neighbor_1 = tmp.instance.set(neighbor_id_1);
+        const ReductionSet& neighbor_2 = tmp.instance.set(neighbor_id_2);
 
         for (ElementId element_id: set.elements)
             elements_to_remove.add(element_id);
@@ -851,191 +1320,162 @@ bool Reduction::reduce_set_folding(Tmp& tmp)
             covered_elements.add(element_id);
         for (ElementId element_id: neighbor_2.elements)
             covered_elements.add(element_id);
-        set.elements.clear();
+        tmp.instance.set_elements.clear(set_id);
         for (ElementId element_id: covered_elements) {
-            set.elements.push_back(element_id);
-            ReductionElement& element = tmp.instance.element(element_id);
-            element.sets.push_back(set_id);
+            tmp.instance.set_elements.push_back(set_id, element_id);
+            tmp.instance.element_sets.push_back(element_id, set_id);
+            tmp.instance.number_of_remaining_arcs++;
+            tmp.modified_elements_log.push_back(element_id);
         }
+        tmp.modified_sets_log.push_back(set_id);
 
-        unreduction_operations_[set_id].in.swap(
-                unreduction_operations_[set_id].out);
+        tmp.unreduction_operations[set_id].in.swap(
+                tmp.unreduction_operations[set_id].out);
 
-        for (SetId orig_set_id: unreduction_operations_[neighbor_id_1].in)
-            unreduction_operations_[set_id].in.push_back(orig_set_id);
-        for (SetId orig_set_id: unreduction_operations_[neighbor_id_1].out)
-            unreduction_operations_[set_id].out.push_back(orig_set_id);
+        for (SetId orig_set_id: tmp.unreduction_operations[neighbor_id_1].in)
+            tmp.unreduction_operations[set_id].in.push_back(orig_set_id);
+        for (SetId orig_set_id: tmp.unreduction_operations[neighbor_id_1].out)
+            tmp.unreduction_operations[set_id].out.push_back(orig_set_id);
 
-        for (SetId orig_set_id: unreduction_operations_[neighbor_id_2].in)
-            unreduction_operations_[set_id].in.push_back(orig_set_id);
-        for (SetId orig_set_id: unreduction_operations_[neighbor_id_2].out)
-            unreduction_operations_[set_id].out.push_back(orig_set_id);
-    }
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        if (sets_to_remove.contains(set_id)) {
-            set.removed = true;
-        } else {
-            for (ElementPos pos = 0;
-                    pos < (ElementPos)set.elements.size();
-                    ) {
-                ElementId element_id = set.elements[pos];
-                if (elements_to_remove.contains(element_id)) {
-                    set.elements[pos] = set.elements.back();
-                    set.elements.pop_back();
-                } else {
-                    pos++;
-                }
-            }
-        }
-    }
-    // Update elements.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        if (elements_to_remove.contains(element_id)) {
-            element.removed = true;
-        } else {
-            for (ElementPos pos = 0;
-                    pos < (ElementPos)element.sets.size();
-                    ) {
-                ElementId set_id = element.sets[pos];
-                if (sets_to_remove.contains(set_id)) {
-                    element.sets[pos] = element.sets.back();
-                    element.sets.pop_back();
-                } else {
-                    pos++;
-                }
-            }
-        }
+        for (SetId orig_set_id: tmp.unreduction_operations[neighbor_id_2].in)
+            tmp.unreduction_operations[set_id].in.push_back(orig_set_id);
+        for (SetId orig_set_id: tmp.unreduction_operations[neighbor_id_2].out)
+            tmp.unreduction_operations[set_id].out.push_back(orig_set_id);
     }
+    remove_elements(tmp, elements_to_remove);
+    remove_sets(tmp, sets_to_remove);
 
     //check(tmp.instance);
     if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
+        update(tmp);
     return true;
 }
 
 struct ReductionTwinCandidate
 {
     SetId set_id;
-    std::vector<SetId> neighbor_ids;
+    std::array<SetId, 3> neighbor_ids;
 };
 
 struct ReductionTwin
 {
     SetId set_id_1;
     SetId set_id_2;
-    std::vector<SetId> neighbor_ids;
+    std::array<SetId, 3> neighbor_ids;
 };
 
-bool Reduction::reduce_twin(Tmp& tmp)
+bool Reduction::reduce_twin(
+        Tmp& tmp,
+        const ReductionParameters& parameters)
 {
     //std::cout << "reduce_twin..." << std::endl;
 
-    // Find all sets with exactly 3 neighbors.
-    std::vector<ReductionTwinCandidate> twin_candidates;
-    optimizationtools::IndexedSet& set_neighbors = tmp.indexed_set_;
-    set_neighbors.resize_and_clear(tmp.instance.number_of_sets());
     optimizationtools::IndexedSet& covered_elements = tmp.indexed_set_3_;
     covered_elements.resize_and_clear(tmp.instance.number_of_elements());
-    optimizationtools::IndexedSet& neighbors_elements = tmp.indexed_set_2_;
-    neighbors_elements.resize_and_clear(tmp.instance.number_of_elements());
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        const ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        set_neighbors.clear();
-        for (ElementId element_id: set.elements) {
-            for (SetId set_id_2: tmp.instance.element(element_id).sets) {
-                if (set_id_2 == set_id)
-                    continue;
-                set_neighbors.add(set_id_2);
-                if (set_neighbors.size() > 3)
-                    break;
-            }
-            if (set_neighbors.size() > 3)
-                break;
-        }
-        if (set_neighbors.size() != 3)
-            continue;
+    tmp.indexed_set_.resize_and_clear(tmp.instance.number_of_sets());
+    tmp.indexed_set_2_.resize_and_clear(tmp.instance.number_of_elements());
+
+    // Find all sets with exactly 3 neighbors, in parallel.
+    // Each thread handles a slice of the sets, and the candidates of the
+    // slices are concatenated in order, so that they are sorted by set id
+    // whatever the number of threads.
+    Counter number_of_threads = parallel_for_number_of_threads(
+            tmp.instance.number_of_sets(),
+            parameters.number_of_threads);
+    std::vector<std::vector<ReductionTwinCandidate>> threads_twin_candidates(number_of_threads);
+    parallel_for(
+            tmp.instance.number_of_sets(),
+            number_of_threads,
+            [&tmp, &threads_twin_candidates](
+                Counter thread_id,
+                Counter begin,
+                Counter end)
+            {
+                const ReductionInstance& reduction_instance = tmp.instance;
+                // The first thread uses the buffers of tmp, the other ones
+                // allocate their own.
+                optimizationtools::IndexedSet thread_set_neighbors(
+                        (thread_id == 0)? 0: reduction_instance.number_of_sets());
+                optimizationtools::IndexedSet thread_covered_elements(
+                        (thread_id == 0)? 0: reduction_instance.number_of_elements());
+                optimizationtools::IndexedSet thread_neighbors_elements(
+                        (thread_id == 0)? 0: reduction_instance.number_of_elements());
+                optimizationtools::IndexedSet& set_neighbors = (thread_id == 0)?
+                    tmp.indexed_set_: thread_set_neighbors;
+                optimizationtools::IndexedSet& covered_elements = (thread_id == 0)?
+                    tmp.indexed_set_3_: thread_covered_elements;
+                optimizationtools::IndexedSet& neighbors_elements = (thread_id == 0)?
+                    tmp.indexed_set_2_: thread_neighbors_elements;
+                std::vector<ReductionTwinCandidate>& twin_candidates = threads_twin_candidates[thread_id];
+                for (SetId set_id = begin; set_id < end; ++set_id) {
+                    const ReductionSet& set = reduction_instance.set(set_id);
+                    if (set.removed)
+                        continue;
+                    set_neighbors.clear();
+                    for (ElementId element_id: set.elements) {
+                        for (SetId set_id_2: reduction_instance.element(element_id).sets) {
+                            if (set_id_2 == set_id)
+                                continue;
+                            set_neighbors.add(set_id_2);
+                            if (set_neighbors.size() > 3)
+                                break;
+                        }
+                        if (set_neighbors.size() > 3)
+                            break;
+                    }
+                    if (set_neighbors.size() != 3)
+                        continue;
 
-        // Check that all 3 neighbors are necessary to cover elements of set_1
-        // if set_1 is not taken.
-        SetId neighbors_id_1 = *(set_neighbors.begin() + 0);
-        SetId neighbors_id_2 = *(set_neighbors.begin() + 1);
-        SetId neighbors_id_3 = *(set_neighbors.begin() + 2);
-        const ReductionSet& neighbor_1 = tmp.instance.set(neighbors_id_1);
-        const ReductionSet& neighbor_2 = tmp.instance.set(neighbors_id_2);
-        const ReductionSet& neighbor_3 = tmp.instance.set(neighbors_id_3);
-        covered_elements.clear();
-        for (ElementId element_id: set.elements)
-            covered_elements.add(element_id);
-        {
-            neighbors_elements.clear();
-            for (ElementId element_id: neighbor_1.elements)
-                if (covered_elements.contains(element_id))
-                    neighbors_elements.add(element_id);
-            for (ElementId element_id: neighbor_2.elements)
-                if (covered_elements.contains(element_id))
-                    neighbors_elements.add(element_id);
-            if (neighbors_elements.size() == covered_elements.size())
-                continue;
-        }
-        {
-            neighbors_elements.clear();
-            for (ElementId element_id: neighbor_1.elements)
-                if (covered_elements.contains(element_id))
-                    neighbors_elements.add(element_id);
-            for (ElementId element_id: neighbor_3.elements)
-                if (covered_elements.contains(element_id))
-                    neighbors_elements.add(element_id);
-            if (neighbors_elements.size() == covered_elements.size())
-                continue;
-        }
-        {
-            neighbors_elements.clear();
-            for (ElementId element_id: neighbor_2.elements)
-                if (covered_elements.contains(element_id))
-                    neighbors_elements.add(element_id);
-            for (ElementId element_id: neighbor_3.elements)
-                if (covered_elements.contains(element_id))
-                    neighbors_elements.add(element_id);
-            if (neighbors_elements.size() == covered_elements.size())
-                continue;
-        }
+                    // Check that all 3 neighbors are necessary to cover
+                    // elements of set_1 if set_1 is not taken.
+                    ReductionTwinCandidate twin_candidate;
+                    twin_candidate.set_id = set_id;
+                    for (int pos = 0; pos < 3; ++pos)
+                        twin_candidate.neighbor_ids[pos] = *(set_neighbors.begin() + pos);
+                    covered_elements.clear();
+                    for (ElementId element_id: set.elements)
+                        covered_elements.add(element_id);
+                    bool necessary = true;
+                    for (int pos = 0; pos < 3 && necessary; ++pos) {
+                        neighbors_elements.clear();
+                        for (int pos_2 = 0; pos_2 < 3; ++pos_2) {
+                            if (pos_2 == pos)
+                                continue;
+                            const ReductionSet& neighbor = reduction_instance.set(twin_candidate.neighbor_ids[pos_2]);
+                            for (ElementId element_id: neighbor.elements)
+                                if (covered_elements.contains(element_id))
+                                    neighbors_elements.add(element_id);
+                        }
+                        if (neighbors_elements.size() == covered_elements.size())
+                            necessary = false;
+                    }
+                    if (!necessary)
+                        continue;
 
-        ReductionTwinCandidate twin_candidate;
-        twin_candidate.set_id = set_id;
-        twin_candidate.neighbor_ids.push_back(*(set_neighbors.begin() + 0));
-        twin_candidate.neighbor_ids.push_back(*(set_neighbors.begin() + 1));
-        twin_candidate.neighbor_ids.push_back(*(set_neighbors.begin() + 2));
-        std::sort(twin_candidate.neighbor_ids.begin(), twin_candidate.neighbor_ids.end());
-        twin_candidates.push_back(twin_candidate);
+                    std::sort(twin_candidate.neighbor_ids.begin(), twin_candidate.neighbor_ids.end());
+                    twin_candidates.push_back(twin_candidate);
+                }
+            });
+    std::vector<ReductionTwinCandidate> twin_candidates;
+    for (const std::vector<ReductionTwinCandidate>& thread_twin_candidates: threads_twin_candidates) {
+        twin_candidates.insert(
+                twin_candidates.end(),
+                thread_twin_candidates.begin(),
+                thread_twin_candidates.end());
     }
     //std::cout << "twin_candidates.size() " << twin_candidates.size() << std::endl;
 
     // Sort by neighbors triplets.
-    sort(twin_candidates.begin(), twin_candidates.end(),
-            [this](
-                const ReductionTwinCandidate& twin_candidate_1,
-                const ReductionTwinCandidate& twin_candidate_2) -> bool
+    std::vector<ReductionTwinCandidate> buffer;
+    radix_sort(
+            twin_candidates,
+            buffer,
+            3,
+            [](const ReductionTwinCandidate& twin_candidate, int key_id) -> uint64_t
             {
-                if (twin_candidate_1.neighbor_ids[0] != twin_candidate_2.neighbor_ids[0])
-                    return (twin_candidate_1.neighbor_ids[0] < twin_candidate_2.neighbor_ids[0]);
-                if (twin_candidate_1.neighbor_ids[1] != twin_candidate_2.neighbor_ids[1])
-                    return (twin_candidate_1.neighbor_ids[1] < twin_candidate_2.neighbor_ids[1]);
-                return (twin_candidate_1.neighbor_ids[2] < twin_candidate_2.neighbor_ids[2]);
-            });
+                return twin_candidate.neighbor_ids[2 - key_id];
+            },
+            parameters.number_of_threads);
 
     // Fold each pair.
     optimizationtools::IndexedSet& folded_sets = tmp.indexed_set_2_;
@@ -1097,11 +1537,11 @@ bool Reduction::reduce_twin(Tmp& tmp)
     optimizationtools::IndexedSet& elements_to_remove = tmp.indexed_set_;
     elements_to_remove.resize_and_clear(tmp.instance.number_of_elements());
     for (const ReductionTwin& twin: folded_sets_list) {
-        ReductionSet& set_1 = tmp.instance.set(twin.set_id_1);
-        ReductionSet& set_2 = tmp.instance.set(twin.set_id_2);
-        ReductionSet& neighbor_1 = tmp.instance.set(twin.neighbor_ids[0]);
-        ReductionSet& neighbor_2 = tmp.instance.set(twin.neighbor_ids[1]);
-        ReductionSet& neighbor_3 = tmp.instance.set(twin.neighbor_ids[2]);
+        const ReductionSet& set_1 = tmp.instance.set(twin.set_id_1);
+        const ReductionSet& set_2 = tmp.instance.set(twin.set_id_2);
+        const ReductionSet& neighbor_1 = tmp.instance.set(twin.neighbor_ids[0]);
+        const ReductionSet& neighbor_2 = tmp.instance.set(twin.neighbor_ids[1]);
+        const ReductionSet& neighbor_3 = tmp.instance.set(twin.neighbor_ids[2]);
 
         for (ElementId element_id: set_1.elements)
             elements_to_remove.add(element_id);
@@ -1115,83 +1555,42 @@ bool Reduction::reduce_twin(Tmp& tmp)
             covered_elements.add(element_id);
         for (ElementId element_id: neighbor_3.elements)
             covered_elements.add(element_id);
-        set_1.elements.clear();
+        tmp.instance.set_elements.clear(twin.set_id_1);
         for (ElementId element_id: covered_elements) {
-            set_1.elements.push_back(element_id);
-            ReductionElement& element = tmp.instance.element(element_id);
-            element.sets.push_back(twin.set_id_1);
-        }
-
-        unreduction_operations_[twin.set_id_1].in.swap(
-                unreduction_operations_[twin.set_id_1].out);
-
-        for (SetId orig_set_id: unreduction_operations_[twin.set_id_2].out)
-            unreduction_operations_[twin.set_id_1].in.push_back(orig_set_id);
-        for (SetId orig_set_id: unreduction_operations_[twin.set_id_2].in)
-            unreduction_operations_[twin.set_id_1].out.push_back(orig_set_id);
-
-        for (SetId orig_set_id: unreduction_operations_[twin.neighbor_ids[0]].in)
-            unreduction_operations_[twin.set_id_1].in.push_back(orig_set_id);
-        for (SetId orig_set_id: unreduction_operations_[twin.neighbor_ids[0]].out)
-            unreduction_operations_[twin.set_id_1].out.push_back(orig_set_id);
-        for (SetId orig_set_id: unreduction_operations_[twin.neighbor_ids[1]].in)
-            unreduction_operations_[twin.set_id_1].in.push_back(orig_set_id);
-        for (SetId orig_set_id: unreduction_operations_[twin.neighbor_ids[1]].out)
-            unreduction_operations_[twin.set_id_1].out.push_back(orig_set_id);
-        for (SetId orig_set_id: unreduction_operations_[twin.neighbor_ids[2]].in)
-            unreduction_operations_[twin.set_id_1].in.push_back(orig_set_id);
-        for (SetId orig_set_id: unreduction_operations_[twin.neighbor_ids[2]].out)
-            unreduction_operations_[twin.set_id_1].out.push_back(orig_set_id);
-    }
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        if (sets_to_remove.contains(set_id)) {
-            set.removed = true;
-        } else {
-            for (ElementPos pos = 0;
-                    pos < (ElementPos)set.elements.size();
-                    ) {
-                ElementId element_id = set.elements[pos];
-                if (elements_to_remove.contains(element_id)) {
-                    set.elements[pos] = set.elements.back();
-                    set.elements.pop_back();
-                } else {
-                    pos++;
-                }
-            }
-        }
-    }
-    // Update elements.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        if (elements_to_remove.contains(element_id)) {
-            element.removed = true;
-        } else {
-            for (ElementPos pos = 0;
-                    pos < (ElementPos)element.sets.size();
-                    ) {
-                ElementId set_id = element.sets[pos];
-                if (sets_to_remove.contains(set_id)) {
-                    element.sets[pos] = element.sets.back();
-                    element.sets.pop_back();
-                } else {
-                    pos++;
-                }
-            }
+            tmp.instance.set_elements.push_back(twin.set_id_1, element_id);
+            tmp.instance.element_sets.push_back(element_id, twin.set_id_1);
+            tmp.instance.number_of_remaining_arcs++;
+            tmp.modified_elements_log.push_back(element_id);
         }
+        tmp.modified_sets_log.push_back(twin.set_id_1);
+
+        tmp.unreduction_operations[twin.set_id_1].in.swap(
+                tmp.unreduction_operations[twin.set_id_1].out);
+
+        for (SetId orig_set_id: tmp.unreduction_operations[twin.set_id_2].out)
+            tmp.unreduction_operations[twin.set_id_1].in.push_back(orig_set_id);
+        for (SetId orig_set_id: tmp.unreduction_operations[twin.set_id_2].in)
+            tmp.unreduction_operations[twin.set_id_1].out.push_back(orig_set_id);
+
+        for (SetId orig_set_id: tmp.unreduction_operations[twin.neighbor_ids[0]].in)
+            tmp.unreduction_operations[twin.set_id_1].in.push_back(orig_set_id);
+        for (SetId orig_set_id: tmp.unreduction_operations[twin.neighbor_ids[0]].out)
+            tmp.unreduction_operations[twin.set_id_1].out.push_back(orig_set_id);
+        for (SetId orig_set_id: tmp.unreduction_operations[twin.neighbor_ids[1]].in)
+            tmp.unreduction_operations[twin.set_id_1].in.push_back(orig_set_id);
+        for (SetId orig_set_id: tmp.unreduction_operations[twin.neighbor_ids[1]].out)
+            tmp.unreduction_operations[twin.set_id_1].out.push_back(orig_set_id);
+        for (SetId orig_set_id: tmp.unreduction_operations[twin.neighbor_ids[2]].in)
+            tmp.unreduction_operations[twin.set_id_1].in.push_back(orig_set_id);
+        for (SetId orig_set_id: tmp.unreduction_operations[twin.neighbor_ids[2]].out)
+            tmp.unreduction_operations[twin.set_id_1].out.push_back(orig_set_id);
     }
+    remove_elements(tmp, elements_to_remove);
+    remove_sets(tmp, sets_to_remove);
 
     //check(tmp.instance);
     if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
+        update(tmp);
     return true;
 }
 
@@ -1210,17 +1609,35 @@ bool Reduction::reduce_vertex_cover_domination(
     optimizationtools::IndexedSet& neighbors = tmp.indexed_set_4_;
     neighbors.resize_and_clear(tmp.instance.number_of_sets());
 
-    // Retrieve all sets that cover at least one degree 2 element.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        if (element.sets.size() != 2)
-            continue;
-        for (SetId set_id: element.sets)
+    if (collect_modified(tmp, WorklistConsumer::VertexCoverDomination)) {
+        // Whether a set dominates one of its 2-neighbors only depends on the
+        // lists of the set, of its 2-neighbors and of their elements. So a
+        // set can only have become fixed if one of these lists has been
+        // modified.
+        add_sets_of_modified_elements(tmp);
+        for (SetId set_id: tmp.modified_sets) {
             sets_to_test.add(set_id);
+            for (ElementId element_id: tmp.instance.set(set_id).elements) {
+                const ReductionElement& element = tmp.instance.element(element_id);
+                if (element.sets.size() != 2)
+                    continue;
+                for (SetId set_id_2: element.sets)
+                    sets_to_test.add(set_id_2);
+            }
+        }
+    } else {
+        // Retrieve all sets that cover at least one degree 2 element.
+        for (ElementId element_id = 0;
+                element_id < tmp.instance.number_of_elements();
+                ++element_id) {
+            const ReductionElement& element = tmp.instance.element(element_id);
+            if (element.removed)
+                continue;
+            if (element.sets.size() != 2)
+                continue;
+            for (SetId set_id: element.sets)
+                sets_to_test.add(set_id);
+        }
     }
 
     for (SetId set_id: sets_to_test) {
@@ -1230,12 +1647,12 @@ bool Reduction::reduce_vertex_cover_domination(
 
         // Check if set 'set_id' dominates one of its neighbors.
         //std::cout << "set_id " << set_id << std::endl;
-        ReductionSet& set = tmp.instance.set(set_id);
+        const ReductionSet& set = tmp.instance.set(set_id);
 
         // Get the 2-neighbors of set 'set_id'.
         neighbors.clear();
         for (ElementId element_id: set.elements) {
-            const ReductionElement& element = tmp.instance.elements[element_id];
+            const ReductionElement& element = tmp.instance.element(element_id);
             if (element.sets.size() != 2)
                 continue;
             SetId other_set_id = (set_id == element.sets[0])?
@@ -1248,19 +1665,22 @@ bool Reduction::reduce_vertex_cover_domination(
         // of set 'set_id' as well.
         bool can_be_fixed = false;
         for (SetId set_2_id: neighbors) {
-            ReductionSet& set_2 = tmp.instance.set(set_2_id);
+            const ReductionSet& set_2 = tmp.instance.set(set_2_id);
 
             // Handle case where two sets have exactly the same neighbors. In
             // this case, we fix only one.
             if (fixed_sets.contains(set_2_id))
                 continue;
 
-            if (set_2.cost > set.cost)
+            // In a solution without set 'set_id', set 'set_2_id' can be
+            // replaced by set 'set_id', which must then not be more
+            // expensive.
+            if (set.cost > set_2.cost)
                 continue;
 
             bool dominates = true;
             for (ElementId element_id: set_2.elements) {
-                const ReductionElement& element = tmp.instance.elements[element_id];
+                const ReductionElement& element = tmp.instance.element(element_id);
                 bool ok = false;
                 for (SetId set_3_id: element.sets) {
                     if (set_3_id == set_2_id)
@@ -1292,64 +1712,141 @@ bool Reduction::reduce_vertex_cover_domination(
 
     // Update mandatory_sets.
     for (SetId set_id: fixed_sets)
-        for (SetId orig_set_id: unreduction_operations_[set_id].in)
-            mandatory_sets_.push_back(orig_set_id);
-    // Update sets.
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        if (fixed_sets.contains(set_id)) {
-            set.removed = true;
-        } else {
-            for (ElementPos pos = 0;
-                    pos < (ElementPos)set.elements.size();
-                    ) {
-                ElementId element_id = set.elements[pos];
-                if (elements_to_remove.contains(element_id)) {
-                    set.elements[pos] = set.elements.back();
-                    set.elements.pop_back();
-                } else {
-                    pos++;
+        for (SetId orig_set_id: tmp.unreduction_operations[set_id].in)
+            tmp.mandatory_sets.push_back(orig_set_id);
+    remove_elements(tmp, elements_to_remove);
+    remove_sets(tmp, fixed_sets);
+
+    //check(tmp.instance);
+    if (needs_update(tmp.instance))
+        update(tmp);
+    return true;
+}
+
+namespace
+{
+
+/**
+ * Compute a maximum matching of a bipartite graph with the Hopcroft-Karp
+ * algorithm.
+ *
+ * The arcs of the left vertex 'u' are the arcs of positions 'first_arcs[u]'
+ * to 'first_arcs[u + 1]' in 'arc_heads'; only the arcs with 'arc_matchable'
+ * set may belong to the matching. On return, 'left_matches[u]' is the arc
+ * matching 'u' and 'right_matches[v]' the left vertex matched to 'v', or -1.
+ *
+ * Return 'false' if the time limit has been reached before the matching is
+ * maximum.
+ */
+bool hopcroft_karp(
+        const std::vector<Counter>& first_arcs,
+        const std::vector<SetPos>& arc_heads,
+        const std::vector<uint8_t>& arc_matchable,
+        SetPos number_of_right_vertices,
+        std::vector<Counter>& left_matches,
+        std::vector<SetPos>& right_matches,
+        const std::function<bool()>& needs_to_end)
+{
+    SetPos number_of_left_vertices = (SetPos)first_arcs.size() - 1;
+    const SetPos infinity = std::numeric_limits<SetPos>::max();
+    left_matches.assign(number_of_left_vertices, -1);
+    right_matches.assign(number_of_right_vertices, -1);
+    std::vector<SetPos> distances(number_of_left_vertices);
+    std::vector<SetPos> queue;
+    std::vector<Counter> current_arcs(number_of_left_vertices);
+    std::vector<SetPos> stack;
+
+    for (;;) {
+        if (needs_to_end())
+            return false;
+
+        // Build the layers of the shortest augmenting paths.
+        queue.clear();
+        for (SetPos u = 0; u < number_of_left_vertices; ++u) {
+            if (left_matches[u] == -1) {
+                distances[u] = 0;
+                queue.push_back(u);
+            } else {
+                distances[u] = infinity;
+            }
+        }
+        bool found = false;
+        for (SetPos queue_pos = 0; queue_pos < (SetPos)queue.size(); ++queue_pos) {
+            SetPos u = queue[queue_pos];
+            for (Counter arc_pos = first_arcs[u];
+                    arc_pos < first_arcs[u + 1];
+                    ++arc_pos) {
+                if (!arc_matchable[arc_pos])
+                    continue;
+                SetPos w = right_matches[arc_heads[arc_pos]];
+                if (w == -1) {
+                    found = true;
+                } else if (distances[w] == infinity) {
+                    distances[w] = distances[u] + 1;
+                    queue.push_back(w);
                 }
             }
         }
-    }
-    // Update elements.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        if (elements_to_remove.contains(element_id)) {
-            element.removed = true;
-        } else {
-            for (ElementPos pos = 0;
-                    pos < (ElementPos)element.sets.size();
-                    ) {
-                ElementId set_id = element.sets[pos];
-                if (fixed_sets.contains(set_id)) {
-                    element.sets[pos] = element.sets.back();
-                    element.sets.pop_back();
+        if (!found)
+            return true;
+
+        // Augment the matching along vertex-disjoint shortest augmenting
+        // paths, with an iterative depth-first search.
+        for (SetPos u = 0; u < number_of_left_vertices; ++u)
+            current_arcs[u] = first_arcs[u];
+        for (SetPos u = 0; u < number_of_left_vertices; ++u) {
+            if (left_matches[u] != -1 || distances[u] != 0)
+                continue;
+            stack.clear();
+            stack.push_back(u);
+            while (!stack.empty()) {
+                SetPos x = stack.back();
+                if (current_arcs[x] == first_arcs[x + 1]) {
+                    // Dead end.
+                    distances[x] = infinity;
+                    stack.pop_back();
+                    if (!stack.empty())
+                        current_arcs[stack.back()]++;
+                    continue;
+                }
+                Counter arc_pos = current_arcs[x];
+                if (!arc_matchable[arc_pos]) {
+                    current_arcs[x]++;
+                    continue;
+                }
+                SetPos w = right_matches[arc_heads[arc_pos]];
+                if (w == -1) {
+                    // Augmenting path found.
+                    for (SetPos y: stack) {
+                        left_matches[y] = current_arcs[y];
+                        right_matches[arc_heads[current_arcs[y]]] = y;
+                        distances[y] = infinity;
+                    }
+                    break;
+                }
+                if (distances[w] != infinity
+                        && distances[w] == distances[x] + 1) {
+                    stack.push_back(w);
                 } else {
-                    pos++;
+                    current_arcs[x]++;
                 }
             }
         }
     }
+}
 
-    //check(tmp.instance);
-    if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
-    return true;
 }
 
-bool Reduction::reduce_crown(Tmp& tmp)
+bool Reduction::reduce_crown(
+        Tmp& tmp,
+        const ReductionParameters& parameters)
 {
-    std::cout << "reduce_crown..." << std::endl;
+    double end = parameters.timer.elapsed_time() + parameters.crown_time_limit;
+    std::function<bool()> needs_to_end = [&parameters, end]()
+    {
+        return parameters.timer.needs_to_end()
+            || parameters.timer.elapsed_time() >= end;
+    };
 
     optimizationtools::IndexedSet& sets_to_remove = tmp.indexed_set_5_;
     sets_to_remove.resize_and_clear(tmp.instance.number_of_sets());
@@ -1359,66 +1856,70 @@ bool Reduction::reduce_crown(Tmp& tmp)
     elements_to_remove.resize_and_clear(tmp.instance.number_of_elements());
 
     std::vector<ElementId>& shuffled_elements = tmp.set_;
-    shuffled_elements.resize(tmp.instance.number_of_elements());
-    std::iota(shuffled_elements.begin(), shuffled_elements.end(), 0);
+    shuffled_elements.clear();
+    for (ElementId element_id = 0;
+            element_id < tmp.instance.number_of_elements();
+            ++element_id) {
+        if (!tmp.instance.element(element_id).removed)
+            shuffled_elements.push_back(element_id);
+    }
 
-    for (Counter it = 0; it < 16; ++it) {
-        std::cout << "it " << it << std::endl;
+    // Positions of the sets in the auxiliary bipartite graph.
+    std::vector<SetPos> sets_positions(tmp.instance.number_of_sets(), -1);
+    std::vector<SetId> outsiders;
+    std::vector<SetId> outsider_neighbors;
+    std::vector<Counter> first_arcs;
+    std::vector<SetPos> arc_heads;
+    std::vector<uint8_t> arc_matchable;
+    std::vector<Counter> left_matches;
+    std::vector<SetPos> right_matches;
+    std::vector<uint8_t> in_crown;
+    std::vector<uint8_t> in_head;
+    std::vector<SetPos> queue;
+
+    // Look for crowns until 16 consecutive attempts fail.
+    bool found = false;
+    Counter number_of_failures = 0;
+    while (number_of_failures < 16) {
+        if (needs_to_end())
+            break;
+        number_of_failures++;
 
         std::shuffle(shuffled_elements.begin(), shuffled_elements.end(), tmp.generator_);
 
-        // Find a matching in the hypergraph.
-        std::cout << "find matching 1..." << std::endl;
+        // Step 1: find a maximal matching M1 of the hypergraph, first with the
+        // elements covered by more than two sets, then with the elements
+        // covered by two sets. The unmatched sets which only contain elements
+        // covered by two sets form an independent set O.
         optimizationtools::IndexedSet& matching_1_sets = tmp.indexed_set_;
         matching_1_sets.resize_and_clear(tmp.instance.number_of_sets());
-        ElementId matching_1_number_of_elements = 0;
-        // First loop through elements with degree > 2.
-        for (ElementId element_id: shuffled_elements) {
-            const ReductionElement& element = tmp.instance.element(element_id);
-            if (element.removed)
-                continue;
-            if (element.sets.size() <= 2)
-                continue;
-            bool valid = true;
-            for (SetId set_id: element.sets) {
-                if (matching_1_sets.contains(set_id)) {
-                    valid = false;
-                    break;
-                }
-            }
-            if (!valid)
-                continue;
-            for (SetId set_id: element.sets)
-                matching_1_sets.add(set_id);
-            matching_1_number_of_elements++;
-        }
-        // Then loop through element with degree == 2.
-        for (ElementId element_id: shuffled_elements) {
-            const ReductionElement& element = tmp.instance.element(element_id);
-            if (element.removed)
-                continue;
-            if (element.sets.size() != 2)
-                continue;
-            bool valid = true;
-            for (SetId set_id: element.sets) {
-                if (matching_1_sets.contains(set_id)) {
-                    valid = false;
-                    break;
+        for (int degree_2 = 0; degree_2 <= 1; ++degree_2) {
+            for (ElementId element_id: shuffled_elements) {
+                const ReductionElement& element = tmp.instance.element(element_id);
+                if (element.removed || element.sets.size() < 2)
+                    continue;
+                if ((element.sets.size() == 2) != (degree_2 == 1))
+                    continue;
+                bool valid = true;
+                for (SetId set_id: element.sets) {
+                    if (matching_1_sets.contains(set_id)) {
+                        valid = false;
+                        break;
+                    }
                 }
+                if (!valid)
+                    continue;
+                for (SetId set_id: element.sets)
+                    matching_1_sets.add(set_id);
             }
-            if (!valid)
-                continue;
-            for (SetId set_id: element.sets)
-                matching_1_sets.add(set_id);
-            matching_1_number_of_elements++;
         }
-        std::cout << "matching_1_number_of_elements " << matching_1_number_of_elements << std::endl;
-        std::cout << "matching_1_sets.size() " << matching_1_sets.size() << std::endl;
 
-        // Find the unmatched sets that only cover elements covered by two sets.
-        std::cout << "find outsiders" << std::endl;
-        optimizationtools::IndexedSet& outsiders = tmp.indexed_set_2_;
-        outsiders.resize_and_clear(tmp.instance.number_of_sets());
+        for (SetId set_id: outsiders)
+            sets_positions[set_id] = -1;
+        for (SetId set_id: outsider_neighbors)
+            sets_positions[set_id] = -1;
+        outsiders.clear();
+        outsider_neighbors.clear();
         for (auto it = matching_1_sets.out_begin();
                 it != matching_1_sets.out_end();
                 ++it) {
@@ -1436,260 +1937,137 @@ bool Reduction::reduce_crown(Tmp& tmp)
             }
             if (!ok)
                 continue;
-            outsiders.add(set_id);
-        }
-        std::cout << "outsiders.size() " << outsiders.size() << std::endl;
-        //for (SetId set_id: outsiders) {
-        //    std::cout << "set_id " << set_id
-        //        << " elts " << tmp.instance.set(set_id).elements.size()
-        //        << std::endl;
-        //}
+            sets_positions[set_id] = outsiders.size();
+            outsiders.push_back(set_id);
+        }
         if (outsiders.empty())
             continue;
 
-        // Find the neighbors of the unmatched elements.
-        std::cout << "find outsider neighbors..." << std::endl;
-        optimizationtools::IndexedSet& outsider_neighbors = tmp.indexed_set_3_;
-        outsider_neighbors.resize_and_clear(tmp.instance.number_of_sets());
+        // Build the bipartite graph between O and its neighborhood N(O). An
+        // arc may only belong to the auxiliary matching if the neighbor costs
+        // at most as much as the outsider, so that fixing the head of the
+        // crown is never more expensive than the matched sets.
+        first_arcs.clear();
+        arc_heads.clear();
+        arc_matchable.clear();
         for (SetId set_id: outsiders) {
             const ReductionSet& set = tmp.instance.set(set_id);
+            first_arcs.push_back(arc_heads.size());
             for (ElementId element_id: set.elements) {
                 const ReductionElement& element = tmp.instance.element(element_id);
                 SetId other_set_id = (set_id == element.sets[0])?
                     element.sets[1]:
                     element.sets[0];
-                if (outsiders.contains(other_set_id)) {
-                    throw std::logic_error(
-                            "setcoveringsolver::Reduction::reduce_crown.");
+                if (sets_positions[other_set_id] == -1) {
+                    sets_positions[other_set_id] = outsider_neighbors.size();
+                    outsider_neighbors.push_back(other_set_id);
                 }
-                outsider_neighbors.add(other_set_id);
+                arc_heads.push_back(sets_positions[other_set_id]);
+                arc_matchable.push_back(
+                        tmp.instance.set(other_set_id).cost <= set.cost);
             }
         }
-        std::cout << "outsider_neighbors.size() " << outsider_neighbors.size() << std::endl;
-        //for (SetId set_id: outsider_neighbors) {
-        //    std::cout << "set_id " << set_id
-        //        << " elts " << tmp.instance.set(set_id).elements.size()
-        //        << std::endl;
-        //}
-
-        // Step 2: Find a maximum auxiliary matching M2 of the edges between O and N (O).
-
-        std::cout << "find second matching" << std::endl;
-        optimizationtools::IndexedMap<SetPos>& sets_to_bgmm = tmp.indexed_map_;
-        sets_to_bgmm.clear();
-        optimizationtools::AdjacencyListGraphBuilder graph_builder;
-        std::vector<ElementId> bgmm_edges_to_elements;
-        for (SetId set_id: outsiders)
-            graph_builder.add_vertex();
-        for (SetId set_id: outsider_neighbors)
-            graph_builder.add_vertex();
-        for (SetId set_id: outsiders) {
-            const ReductionSet& set = tmp.instance.set(set_id);
-            for (ElementId element_id: set.elements) {
-                const ReductionElement& element = tmp.instance.element(element_id);
-                SetId other_set_id = (set_id == element.sets[0])?
-                    element.sets[1]:
-                    element.sets[0];
-                graph_builder.add_edge(sets_to_bgmm[set_id], sets_to_bgmm[other_set_id]);
-            }
-        }
-        optimizationtools::AdjacencyListGraph graph = graph_builder.build();
-        std::vector<uint8_t> bgmm_output = optimizationtools::bipartite_graph_maximum_matching(graph);
-        optimizationtools::IndexedSet& matching_2 = tmp.indexed_set_4_;
-        matching_2.resize_and_clear(tmp.instance.number_of_elements());
-        for (optimizationtools::EdgeId edge_id = 0;
-                edge_id < graph.number_of_edges();
-                ++edge_id) {
-            if (bgmm_output[edge_id] == 0)
-                continue;
-            ElementId element_id = bgmm_edges_to_elements[edge_id];
-            matching_2.add(element_id);
+        first_arcs.push_back(arc_heads.size());
+
+        // Step 2: find a maximum auxiliary matching M2 between O and N(O).
+        if (!hopcroft_karp(
+                    first_arcs,
+                    arc_heads,
+                    arc_matchable,
+                    outsider_neighbors.size(),
+                    left_matches,
+                    right_matches,
+                    needs_to_end)) {
+            break;
         }
-        std::cout << "matching_2.size() " << matching_2.size() << std::endl;
-
-        // Step 3: If every vertex in N (O) is matched by M2, then H = N (O) and I = O form a  crown, and we are done.
-        if (matching_2.size() == outsider_neighbors.size()) {
-            std::cout << "every vertex is matched" << std::endl;
-            for (SetId set_id: outsiders)
-                sets_to_remove.add(set_id);
-            for (SetId set_id: outsider_neighbors) {
-                const ReductionSet& set = tmp.instance.set(set_id);
-                sets_to_remove.add(set_id);
-                fixed_sets.add(set_id);
-                for (ElementId element_id: set.elements)
-                    elements_to_remove.add(element_id);
-            }
-
-        } else {
 
-            // Step 4: Let I0 be the set of vertices in O that are unmatched by M2.
-            std::cout << "build i0..." << std::endl;
-            optimizationtools::IndexedSet& i = tmp.indexed_set_;
-            i.resize_and_clear(tmp.instance.number_of_elements());
-
-            for (SetId set_id: outsiders) {
-                const ReductionSet& set = tmp.instance.set(set_id);
-                bool inside_matching = false;
-                for (ElementId element_id: set.elements) {
-                    if (matching_2.contains(element_id)) {
-                        inside_matching = true;
-                        break;
-                    }
-                }
-                if (!inside_matching) {
-                    if (i.contains(set_id)) {
-                        throw std::logic_error("");
-                    }
-                    i.add(set_id);
-                }
+        // Step 3: if every vertex of N(O) is matched by M2, then H = N(O) and
+        // I = O form a crown.
+        // Otherwise, steps 4 and 5: starting from the vertices I0 of O
+        // unmatched by M2, alternately add H_n = N(I_n) and the vertices of O
+        // matched to H_n until I_n stops growing. I = I_N and H = H_N then
+        // form a flared crown.
+        in_crown.assign(outsiders.size(), 0);
+        in_head.assign(outsider_neighbors.size(), 0);
+        queue.clear();
+        bool all_neighbors_matched = true;
+        for (SetPos set_pos = 0; set_pos < (SetPos)outsider_neighbors.size(); ++set_pos)
+            if (right_matches[set_pos] == -1)
+                all_neighbors_matched = false;
+        for (SetPos set_pos = 0; set_pos < (SetPos)outsiders.size(); ++set_pos) {
+            if (all_neighbors_matched || left_matches[set_pos] == -1) {
+                in_crown[set_pos] = 1;
+                queue.push_back(set_pos);
             }
-            std::cout << "i0.size() " << i.size() << std::endl;
-            if (i.empty())
-                continue;
-
-            optimizationtools::IndexedSet& h = tmp.indexed_set_2_;
-            h.resize_and_clear(tmp.instance.number_of_elements());
-
-            // Step 5: Repeat steps 5a and 5b until n = N so that IN−1 = IN .
-            for (;;) {
-                // 5a. Let Hn = N (In). 
-                std::cout << "build h..." << std::endl;
-                h.clear();
-                for (SetId set_id: i) {
-                    const ReductionSet& set = tmp.instance.set(set_id);
-                    for (ElementId element_id: set.elements) {
-                        const ReductionElement& element = tmp.instance.element(element_id);
-                        SetId other_set_id = (set_id == element.sets[0])?
-                            element.sets[1]:
-                            element.sets[0];
-                        if (i.contains(other_set_id)) {
-                            throw std::logic_error(
-                                    "setcoveringsolver::Reduction::reduce_crown.");
-                        }
-                        h.add(other_set_id);
-                    }
+        }
+        if (queue.empty())
+            continue;
+        bool valid = true;
+        for (SetPos queue_pos = 0; queue_pos < (SetPos)queue.size(); ++queue_pos) {
+            SetPos set_pos = queue[queue_pos];
+            for (Counter arc_pos = first_arcs[set_pos];
+                    arc_pos < first_arcs[set_pos + 1];
+                    ++arc_pos) {
+                SetPos head_pos = arc_heads[arc_pos];
+                if (in_head[head_pos])
+                    continue;
+                in_head[head_pos] = 1;
+                SetPos matched_set_pos = right_matches[head_pos];
+                if (matched_set_pos == -1) {
+                    // Can only happen if some arcs are not matchable.
+                    valid = false;
+                    break;
                 }
-                std::cout << "h.size() " << h.size() << std::endl;
-                // 5b. Let In+1 = In ∪ NM2(Hn).
-                std::cout << "build i..." << std::endl;
-                bool added = false;
-                for (SetId set_id: h) {
-                    const ReductionSet& set = tmp.instance.set(set_id);
-                    for (ElementId element_id: set.elements) {
-                        if (matching_2.contains(element_id)) {
-                            const ReductionElement& element = tmp.instance.element(element_id);
-                            SetId other_set_id = (set_id == element.sets[0])?
-                                element.sets[1]:
-                                element.sets[0];
-                            if (!i.contains(other_set_id)) {
-                                i.add(other_set_id);
-                                added = true;
-                            }
-                        }
-                    }
+                if (!in_crown[matched_set_pos]) {
+                    in_crown[matched_set_pos] = 1;
+                    queue.push_back(matched_set_pos);
                 }
-                std::cout << "i.size() " << i.size() << std::endl;
-                if (!added)
-                    break;
-            }
-
-            // Step 6: I = IN and H = HN form a flared crown.
-            std::cout << "crown found..." << std::endl;
-            for (SetId set_id: i)
-                sets_to_remove.add(set_id);
-            for (SetId set_id: h) {
-                const ReductionSet& set = tmp.instance.set(set_id);
-                sets_to_remove.add(set_id);
-                fixed_sets.add(set_id);
-                for (ElementId element_id: set.elements)
-                    elements_to_remove.add(element_id);
             }
+            if (!valid)
+                break;
+        }
+        if (!valid)
+            continue;
 
-            std::cout << "i" << std::endl;
-            for (SetId set_id: i) {
-                std::cout << "set_id " << set_id
-                    << " elts " << tmp.instance.set(set_id).elements.size()
-                    << std::endl;
-            }
+        // Step 6: remove the crown I and fix its head H.
+        sets_to_remove.clear();
+        fixed_sets.clear();
+        elements_to_remove.clear();
+        for (SetPos set_pos = 0; set_pos < (SetPos)outsiders.size(); ++set_pos)
+            if (in_crown[set_pos])
+                sets_to_remove.add(outsiders[set_pos]);
+        for (SetPos set_pos = 0; set_pos < (SetPos)outsider_neighbors.size(); ++set_pos) {
+            if (!in_head[set_pos])
+                continue;
+            SetId set_id = outsider_neighbors[set_pos];
+            sets_to_remove.add(set_id);
+            fixed_sets.add(set_id);
+            for (ElementId element_id: tmp.instance.set(set_id).elements)
+                elements_to_remove.add(element_id);
+        }
 
-            std::cout << "h" << std::endl;
-            for (SetId set_id: h) {
-                std::cout << "set_id " << set_id
-                    << " elts " << tmp.instance.set(set_id).elements.size()
-                    << std::endl;
+        // Update mandatory_sets.
+        for (SetId set_id: sets_to_remove) {
+            if (fixed_sets.contains(set_id)) {
+                for (SetId orig_set_id: tmp.unreduction_operations[set_id].in)
+                    tmp.mandatory_sets.push_back(orig_set_id);
+            } else {
+                for (SetId orig_set_id: tmp.unreduction_operations[set_id].out)
+                    tmp.mandatory_sets.push_back(orig_set_id);
             }
-
         }
-
-        if (!sets_to_remove.empty())
-            break;
+        remove_elements(tmp, elements_to_remove);
+        remove_sets(tmp, sets_to_remove);
+        found = true;
+        number_of_failures = 0;
     }
 
-    if (sets_to_remove.size() == 0)
+    if (!found)
         return false;
 
-    std::cout << sets_to_remove.size() << " " << fixed_sets.size() << " " << elements_to_remove.size() << std::endl;
-
-    // Update mandatory_sets.
-    for (SetId set_id: sets_to_remove) {
-        if (fixed_sets.contains(set_id)) {
-            for (SetId orig_set_id: unreduction_operations_[set_id].in)
-                mandatory_sets_.push_back(orig_set_id);
-        } else {
-            for (SetId orig_set_id: unreduction_operations_[set_id].out)
-                mandatory_sets_.push_back(orig_set_id);
-        }
-    }
-    // Update sets.
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        if (sets_to_remove.contains(set_id)) {
-            set.removed = true;
-        } else {
-            for (ElementPos pos = 0;
-                    pos < (ElementPos)set.elements.size();
-                    ) {
-                ElementId element_id = set.elements[pos];
-                if (elements_to_remove.contains(element_id)) {
-                    set.elements[pos] = set.elements.back();
-                    set.elements.pop_back();
-                } else {
-                    pos++;
-                }
-            }
-        }
-    }
-    // Update elements.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        if (elements_to_remove.contains(element_id)) {
-            element.removed = true;
-        } else {
-            for (SetPos pos = 0;
-                    pos < (SetPos)element.sets.size();
-                    ) {
-                SetId set_id = element.sets[pos];
-                if (sets_to_remove.contains(set_id)) {
-                    element.sets[pos] = element.sets.back();
-                    element.sets.pop_back();
-                } else {
-                    pos++;
-                }
-            }
-        }
-    }
-
     //check(tmp.instance);
     if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
+        update(tmp);
     return true;
 }
 
@@ -1703,11 +2081,11 @@ bool Reduction::reduce_linear_programming(
     for (ElementId element_id = 0;
             element_id < tmp.instance.number_of_elements();
             ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
+        const ReductionElement& element = tmp.instance.element(element_id);
         if (element.removed)
             continue;
         if (element.sets.size() != 2)
-            return false;
+            return reduce_reduced_cost_fixing(tmp, parameters);
     }
 
     optimizationtools::IndexedSet& sets_to_remove = tmp.indexed_set_5_;
@@ -1763,63 +2141,448 @@ bool Reduction::reduce_linear_programming(
     // Update mandatory_sets.
     for (SetId set_id: sets_to_remove) {
         if (fixed_sets.contains(set_id)) {
-            for (SetId orig_set_id: unreduction_operations_[set_id].in)
-                mandatory_sets_.push_back(orig_set_id);
+            for (SetId orig_set_id: tmp.unreduction_operations[set_id].in)
+                tmp.mandatory_sets.push_back(orig_set_id);
         } else {
-            for (SetId orig_set_id: unreduction_operations_[set_id].out)
-                mandatory_sets_.push_back(orig_set_id);
+            for (SetId orig_set_id: tmp.unreduction_operations[set_id].out)
+                tmp.mandatory_sets.push_back(orig_set_id);
         }
     }
-    // Update sets.
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        if (sets_to_remove.contains(set_id)) {
-            set.removed = true;
-        } else {
-            for (ElementPos pos = 0;
-                    pos < (ElementPos)set.elements.size();
-                    ) {
-                ElementId element_id = set.elements[pos];
-                if (elements_to_remove.contains(element_id)) {
-                    set.elements[pos] = set.elements.back();
-                    set.elements.pop_back();
-                } else {
-                    pos++;
+    remove_elements(tmp, elements_to_remove);
+    remove_sets(tmp, sets_to_remove);
+
+    //check(tmp.instance);
+    if (needs_update(tmp.instance))
+        update(tmp);
+    return true;
+}
+
+namespace
+{
+
+/**
+ * Number of iterations without improvement of the lower bound after which the
+ * step size of the subgradient algorithm is halved.
+ */
+const Counter linear_programming_number_of_iterations_before_step_size_update = 20;
+
+/** Step size factor below which the subgradient algorithm stops. */
+const double linear_programming_minimum_step_size_factor = 5e-3;
+
+/** Number of iterations between two computations of an upper bound. */
+const Counter linear_programming_number_of_iterations_between_upper_bounds = 10;
+
+/** Tolerance on the Lagrangian bounds. */
+const double linear_programming_tolerance = 1e-6;
+
+/**
+ * Ratio between the gap and the largest absolute reduced cost above which the
+ * subgradient algorithm stops, since no set is likely to be fixed.
+ */
+const double linear_programming_maximum_gap_ratio = 4;
+
+/**
+ * Complete a solution with a greedy algorithm.
+ *
+ * The set minimizing its cost divided by its number of uncovered elements is
+ * added to the solution until all the elements are covered. If 'fast' is
+ * true, the elements are considered one after the other instead, and the set
+ * with the smallest cost per element is added for each uncovered element.
+ * Then, the redundant sets are removed by decreasing cost.
+ *
+ * Return the cost of the solution, or the maximum cost if some elements
+ * cannot be covered.
+ */
+template <typename AdjacencyLists>
+Cost greedy_complete(
+        const AdjacencyLists& set_elements,
+        const AdjacencyLists& element_sets,
+        const std::vector<bool>& removed_sets,
+        const std::vector<bool>& removed_elements,
+        const std::vector<Cost>& set_costs,
+        bool fast,
+        std::vector<SetId>& solution)
+{
+    SetId number_of_sets = set_elements.number_of_lists();
+    ElementId number_of_elements = element_sets.number_of_lists();
+    std::vector<SetPos> elements_number_of_covering_sets(number_of_elements, 0);
+    // The lists may contain duplicates, a set is only counted once for each
+    // of its elements.
+    std::vector<SetId> elements_last_set(number_of_elements, -1);
+    std::vector<bool> selected_sets(number_of_sets, false);
+    ElementId number_of_uncovered_elements = 0;
+    for (ElementId element_id = 0;
+            element_id < number_of_elements;
+            ++element_id) {
+        if (!removed_elements[element_id])
+            number_of_uncovered_elements++;
+    }
+    auto add_set = [&set_elements, &elements_number_of_covering_sets, &elements_last_set, &selected_sets, &number_of_uncovered_elements](
+            SetId set_id)
+    {
+        selected_sets[set_id] = true;
+        for (ElementId element_id: set_elements.list(set_id)) {
+            if (elements_last_set[element_id] == set_id)
+                continue;
+            elements_last_set[element_id] = set_id;
+            if (elements_number_of_covering_sets[element_id] == 0)
+                number_of_uncovered_elements--;
+            elements_number_of_covering_sets[element_id]++;
+        }
+    };
+    auto number_of_uncovered_elements_of_set = [&set_elements, &elements_number_of_covering_sets](
+            SetId set_id)
+    {
+        ElementPos number_of_uncovered_elements = 0;
+        for (ElementId element_id: set_elements.list(set_id))
+            if (elements_number_of_covering_sets[element_id] == 0)
+                number_of_uncovered_elements++;
+        return number_of_uncovered_elements;
+    };
+    for (SetId set_id: solution)
+        add_set(set_id);
+
+    if (fast) {
+        for (ElementId element_id = 0;
+                element_id < number_of_elements
+                && number_of_uncovered_elements > 0;
+                ++element_id) {
+            if (removed_elements[element_id]
+                    || elements_number_of_covering_sets[element_id] > 0) {
+                continue;
+            }
+            SetId best_set_id = -1;
+            for (SetId set_id: element_sets.list(element_id)) {
+                if (best_set_id == -1
+                        || (double)set_costs[set_id] / set_elements.list(set_id).size()
+                        < (double)set_costs[best_set_id] / set_elements.list(best_set_id).size()) {
+                    best_set_id = set_id;
                 }
             }
+            if (best_set_id == -1)
+                return std::numeric_limits<Cost>::max();
+            add_set(best_set_id);
+            solution.push_back(best_set_id);
         }
     }
-    // Update elements.
+
+    // Add sets. The score of a set can only increase when other sets are
+    // added, so it is updated only when the set reaches the top of the queue.
+    using QueueItem = std::pair<double, SetId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
+        if (removed_sets[set_id] || selected_sets[set_id])
+            continue;
+        ElementPos number_of_uncovered_elements = number_of_uncovered_elements_of_set(set_id);
+        if (number_of_uncovered_elements == 0)
+            continue;
+        queue.push({(double)set_costs[set_id] / number_of_uncovered_elements, set_id});
+    }
+    while (number_of_uncovered_elements > 0) {
+        if (queue.empty())
+            return std::numeric_limits<Cost>::max();
+        SetId set_id = queue.top().second;
+        queue.pop();
+        ElementPos number_of_uncovered_elements = number_of_uncovered_elements_of_set(set_id);
+        if (number_of_uncovered_elements == 0)
+            continue;
+        QueueItem item = {(double)set_costs[set_id] / number_of_uncovered_elements, set_id};
+        if (!queue.empty() && queue.top() < item) {
+            queue.push(item);
+            continue;
+        }
+        add_set(set_id);
+        solution.push_back(set_id);
+    }
+
+    // Remove redundant sets.
+    std::sort(
+            solution.begin(),
+            solution.end(),
+            [&set_costs](SetId set_id_1, SetId set_id_2) -> bool
+            {
+                if (set_costs[set_id_1] != set_costs[set_id_2])
+                    return set_costs[set_id_1] > set_costs[set_id_2];
+                return set_id_1 < set_id_2;
+            });
+    Cost cost = 0;
+    SetPos number_of_kept_sets = 0;
+    for (SetId set_id: solution) {
+        bool redundant = (set_costs[set_id] > 0);
+        for (ElementId element_id: set_elements.list(set_id)) {
+            if (elements_number_of_covering_sets[element_id] < 2) {
+                redundant = false;
+                break;
+            }
+        }
+        if (redundant) {
+            for (ElementId element_id: set_elements.list(set_id)) {
+                if (elements_last_set[element_id] == -1 - set_id)
+                    continue;
+                elements_last_set[element_id] = -1 - set_id;
+                elements_number_of_covering_sets[element_id]--;
+            }
+            continue;
+        }
+        solution[number_of_kept_sets] = set_id;
+        number_of_kept_sets++;
+        cost += set_costs[set_id];
+    }
+    solution.resize(number_of_kept_sets);
+    return cost;
+}
+
+}
+
+bool Reduction::reduce_reduced_cost_fixing(
+        Tmp& tmp,
+        const ReductionParameters& parameters)
+{
+    //std::cout << "reduce_reduced_cost_fixing..." << std::endl;
+
+    SetId number_of_sets = tmp.instance.number_of_sets();
+    ElementId number_of_elements = tmp.instance.number_of_elements();
+    if (tmp.instance.number_of_remaining_elements == 0)
+        return false;
+
+    // Initial multipliers.
+    std::vector<double> multipliers(number_of_elements, 0.0);
     for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
+            element_id < number_of_elements;
             ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
+        const ReductionElement& element = tmp.instance.element(element_id);
         if (element.removed)
             continue;
-        if (elements_to_remove.contains(element_id)) {
-            element.removed = true;
+        double multiplier = std::numeric_limits<double>::infinity();
+        for (SetId set_id: element.sets) {
+            const ReductionSet& set = tmp.instance.set(set_id);
+            multiplier = (std::min)(multiplier, (double)set.cost / set.elements.size());
+        }
+        multipliers[element_id] = (std::max)(0.0, multiplier);
+    }
+
+    // The reduced costs and the subgradient are computed in parallel; the
+    // sums are computed sequentially so that the result does not depend on
+    // the number of threads.
+    std::vector<double> reduced_costs(number_of_sets, 0.0);
+    auto compute_reduced_costs = [&tmp, &multipliers, &reduced_costs, number_of_sets, number_of_elements, &parameters]()
+    {
+        parallel_for(
+                number_of_sets,
+                parallel_for_number_of_threads(number_of_sets, parameters.number_of_threads),
+                [&tmp, &multipliers, &reduced_costs](
+                    Counter,
+                    Counter begin,
+                    Counter end)
+                {
+                    for (SetId set_id = begin; set_id < end; ++set_id) {
+                        const ReductionSet& set = tmp.instance.set(set_id);
+                        if (set.removed)
+                            continue;
+                        double reduced_cost = set.cost;
+                        for (ElementId element_id: set.elements)
+                            reduced_cost -= multipliers[element_id];
+                        reduced_costs[set_id] = reduced_cost;
+                    }
+                });
+        double lower_bound = 0;
+        for (ElementId element_id = 0;
+                element_id < number_of_elements;
+                ++element_id) {
+            if (!tmp.instance.removed_elements[element_id])
+                lower_bound += multipliers[element_id];
+        }
+        for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
+            if (!tmp.instance.removed_sets[set_id] && reduced_costs[set_id] < 0)
+                lower_bound += reduced_costs[set_id];
+        }
+        return lower_bound;
+    };
+
+    // Subgradient algorithm.
+    std::vector<double> subgradient(number_of_elements, 0.0);
+    std::vector<double> best_multipliers = multipliers;
+    double best_lower_bound = -std::numeric_limits<double>::infinity();
+    Cost upper_bound = std::numeric_limits<Cost>::max();
+    std::vector<SetId> best_solution;
+    std::vector<SetId> solution;
+    double step_size_factor = 2.0;
+    Counter number_of_iterations_without_improvement = 0;
+    for (Counter iteration = 0;
+            iteration < parameters.linear_programming_maximum_number_of_iterations;
+            ++iteration) {
+        if (parameters.timer.needs_to_end())
+            break;
+
+        double lower_bound = compute_reduced_costs();
+        if (lower_bound > best_lower_bound) {
+            best_lower_bound = lower_bound;
+            best_multipliers = multipliers;
+            number_of_iterations_without_improvement = 0;
         } else {
-            for (SetPos pos = 0;
-                    pos < (SetPos)element.sets.size();
-                    ) {
-                SetId set_id = element.sets[pos];
-                if (sets_to_remove.contains(set_id)) {
-                    element.sets[pos] = element.sets.back();
-                    element.sets.pop_back();
-                } else {
-                    pos++;
-                }
+            number_of_iterations_without_improvement++;
+            if (number_of_iterations_without_improvement
+                    >= linear_programming_number_of_iterations_before_step_size_update) {
+                step_size_factor /= 2;
+                number_of_iterations_without_improvement = 0;
+                if (step_size_factor < linear_programming_minimum_step_size_factor)
+                    break;
+            }
+        }
+
+        // Update the upper bound from the solution of the Lagrangian
+        // relaxation. The first one is only used to check if some sets may
+        // be fixed, it is computed with the fast greedy.
+        if (iteration % linear_programming_number_of_iterations_between_upper_bounds == 0) {
+            solution.clear();
+            for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
+                if (!tmp.instance.removed_sets[set_id] && reduced_costs[set_id] < 0)
+                    solution.push_back(set_id);
+            }
+            Cost cost = greedy_complete(
+                    tmp.instance.set_elements,
+                    tmp.instance.element_sets,
+                    tmp.instance.removed_sets,
+                    tmp.instance.removed_elements,
+                    tmp.instance.set_costs,
+                    (iteration == 0),
+                    solution);
+            if (upper_bound > cost) {
+                upper_bound = cost;
+                best_solution = solution;
+            }
+        }
+        if (upper_bound == std::numeric_limits<Cost>::max())
+            return false;
+        if (std::ceil(best_lower_bound - linear_programming_tolerance) >= upper_bound)
+            break;
+
+        // A set can only be fixed if its absolute reduced cost is at least
+        // the gap.
+        double largest_reduced_cost = 0;
+        for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
+            if (!tmp.instance.removed_sets[set_id]) {
+                largest_reduced_cost = (std::max)(
+                        largest_reduced_cost,
+                        std::abs(reduced_costs[set_id]));
             }
         }
+        if ((double)upper_bound - best_lower_bound
+                > linear_programming_maximum_gap_ratio * largest_reduced_cost) {
+            break;
+        }
+
+        // Compute the subgradient.
+        parallel_for(
+                number_of_elements,
+                parallel_for_number_of_threads(number_of_elements, parameters.number_of_threads),
+                [&tmp, &multipliers, &reduced_costs, &subgradient](
+                    Counter,
+                    Counter begin,
+                    Counter end)
+                {
+                    for (ElementId element_id = begin; element_id < end; ++element_id) {
+                        const ReductionElement& element = tmp.instance.element(element_id);
+                        if (element.removed)
+                            continue;
+                        double value = 1;
+                        for (SetId set_id: element.sets)
+                            if (reduced_costs[set_id] < 0)
+                                value--;
+                        if (value < 0 && multipliers[element_id] <= 0)
+                            value = 0;
+                        subgradient[element_id] = value;
+                    }
+                });
+        double subgradient_squared_norm = 0;
+        for (ElementId element_id = 0;
+                element_id < number_of_elements;
+                ++element_id) {
+            if (!tmp.instance.removed_elements[element_id])
+                subgradient_squared_norm += subgradient[element_id] * subgradient[element_id];
+        }
+        // The solution of the Lagrangian relaxation is feasible and satisfies
+        // the complementary slackness conditions, it is optimal.
+        if (subgradient_squared_norm == 0)
+            break;
+
+        // Update the multipliers.
+        double step_size = step_size_factor
+            * ((double)upper_bound - lower_bound)
+            / subgradient_squared_norm;
+        for (ElementId element_id = 0;
+                element_id < number_of_elements;
+                ++element_id) {
+            if (tmp.instance.removed_elements[element_id])
+                continue;
+            multipliers[element_id] = (std::max)(
+                    0.0,
+                    multipliers[element_id] + step_size * subgradient[element_id]);
+        }
+    }
+    if (upper_bound == std::numeric_limits<Cost>::max())
+        return false;
+
+    optimizationtools::IndexedSet& sets_to_remove = tmp.indexed_set_5_;
+    sets_to_remove.resize_and_clear(tmp.instance.number_of_sets());
+    optimizationtools::IndexedSet& fixed_sets = tmp.indexed_set_6_;
+    fixed_sets.resize_and_clear(tmp.instance.number_of_sets());
+    optimizationtools::IndexedSet& elements_to_remove = tmp.indexed_set_7_;
+    elements_to_remove.resize_and_clear(tmp.instance.number_of_elements());
+    optimizationtools::IndexedSet& solution_sets = tmp.indexed_set_;
+    solution_sets.resize_and_clear(tmp.instance.number_of_sets());
+    for (SetId set_id: best_solution)
+        solution_sets.add(set_id);
+
+    // Fix the sets with the best multipliers.
+    // A set which is not in the best solution is removed if the solutions
+    // containing it cost at least the upper bound. A set of the best solution
+    // is fixed if the solutions not containing it cost at least the upper
+    // bound. Since the best solution satisfies all these conditions, there
+    // exists an optimal solution satisfying all of them.
+    multipliers = best_multipliers;
+    double lower_bound = compute_reduced_costs();
+    for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
+        const ReductionSet& set = tmp.instance.set(set_id);
+        if (set.removed)
+            continue;
+        if (solution_sets.contains(set_id)) {
+            double bound = lower_bound - (std::min)(0.0, reduced_costs[set_id]);
+            if (std::ceil(bound - linear_programming_tolerance) < upper_bound)
+                continue;
+            sets_to_remove.add(set_id);
+            fixed_sets.add(set_id);
+            for (ElementId element_id: set.elements)
+                elements_to_remove.add(element_id);
+        } else {
+            double bound = lower_bound + (std::max)(0.0, reduced_costs[set_id]);
+            if (std::ceil(bound - linear_programming_tolerance) < upper_bound)
+                continue;
+            sets_to_remove.add(set_id);
+        }
     }
 
+    //std::cout << "lb " << lower_bound << " ub " << upper_bound << " " << sets_to_remove.size() << " " << fixed_sets.size() << std::endl;
+
+    if (sets_to_remove.size() == 0)
+        return false;
+
+    // Update mandatory_sets.
+    for (SetId set_id: sets_to_remove) {
+        if (fixed_sets.contains(set_id)) {
+            for (SetId orig_set_id: tmp.unreduction_operations[set_id].in)
+                tmp.mandatory_sets.push_back(orig_set_id);
+        } else {
+            for (SetId orig_set_id: tmp.unreduction_operations[set_id].out)
+                tmp.mandatory_sets.push_back(orig_set_id);
+        }
+    }
+    remove_elements(tmp, elements_to_remove);
+    remove_sets(tmp, sets_to_remove);
+
     //check(tmp.instance);
     if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
+        update(tmp);
     return true;
 }
 
@@ -1872,7 +2635,7 @@ bool Reduction::reduce_unconfined_sets(Tmp& tmp)
         SetId set_v_id = set_id;
 
         for (;;) {
-            const ReductionSet& set_v = tmp.instance.sets[set_v_id];
+            const ReductionSet& set_v = tmp.instance.set(set_v_id);
 
             // Update S.
             s.add(set_v_id);
@@ -1891,12 +2654,12 @@ bool Reduction::reduce_unconfined_sets(Tmp& tmp)
             s_ns_mandatory_covered_elements.clear();
             ns_candidates.clear();
             for (SetId set_v0_id: s) {
-                const ReductionSet& set_v0 = tmp.instance.sets[set_v0_id];
+                const ReductionSet& set_v0 = tmp.instance.set(set_v0_id);
 
                 for (ElementId element_id: set_v0.elements) {
                     if (elements_to_remove.contains(element_id))
                         continue;
-                    const ReductionElement& element = tmp.instance.elements[element_id];
+                    const ReductionElement& element = tmp.instance.element(element_id);
 
                     s_ns_mandatory_covered_elements.set(
                             element_id,
@@ -1932,7 +2695,7 @@ bool Reduction::reduce_unconfined_sets(Tmp& tmp)
                     ns_mandatory.add(set_u_id);
 
                     // Update s_ns_mandatory_covered_elements.
-                    const ReductionSet& set_u = tmp.instance.sets[set_u_id];
+                    const ReductionSet& set_u = tmp.instance.set(set_u_id);
                     for (ElementId element_id_3: set_u.elements) {
                         if (elements_to_remove.contains(element_id_3))
                             continue;
@@ -1976,7 +2739,7 @@ bool Reduction::reduce_unconfined_sets(Tmp& tmp)
                         // We hope to show that u may be replace by v2 in an
                         // optimal solution. Therefore, we need
                         // cost(u) >= cost(v2).
-                        const ReductionSet& set_v2 = tmp.instance.sets[set_v2_id];
+                        const ReductionSet& set_v2 = tmp.instance.set(set_v2_id);
                         if (set_u.cost < set_v2.cost)
                             continue;
                         ElementPos m = 0;
@@ -2012,7 +2775,7 @@ bool Reduction::reduce_unconfined_sets(Tmp& tmp)
                     throw std::logic_error(
                         "setcoveringsolver::Reduction::reduce_unconfined_sets.");
                 }
-                const ReductionSet& set_u = tmp.instance.sets[set_u_id];
+                const ReductionSet& set_u = tmp.instance.set(set_u_id);
                 ElementPos m = 0;
                 ElementId element_id_cur = -1;
                 for (ElementId element_id: set_u.elements) {
@@ -2039,8 +2802,8 @@ bool Reduction::reduce_unconfined_sets(Tmp& tmp)
 
                     //for (SetId set_v_id: s) {
                     //    std::cout << "  " << set_v_id << ":";
-                    //    for (SetId e: tmp.instance.sets[set_v_id].elements)
-                    //        std::cout << " " << e << "," << tmp.instance.elements[e].sets.size();
+                    //    for (SetId e: tmp.instance.set(set_v_id).elements)
+                    //        std::cout << " " << e << "," << tmp.instance.element(e).sets.size();
                     //    std::cout << std::endl;
                     //}
 
@@ -2051,7 +2814,7 @@ bool Reduction::reduce_unconfined_sets(Tmp& tmp)
 
                     //for (SetId set_u_id: ns_mandatory) {
                     //    std::cout << "  " << set_u_id << ":";
-                    //    for (SetId e: tmp.instance.sets[set_u_id].elements)
+                    //    for (SetId e: tmp.instance.set(set_u_id).elements)
                     //        std::cout << " " << e;
                     //    std::cout << std::endl;
                     //}
@@ -2077,7 +2840,7 @@ bool Reduction::reduce_unconfined_sets(Tmp& tmp)
                 // covered by a single other set, it can be added to S.
                 if (m == 1) {
                     const ReductionElement& element_cur
-                        = tmp.instance.elements[element_id_cur];
+                        = tmp.instance.element(element_id_cur);
                     SetPos n = 0;
                     SetId other_set_id = -1;
                     for (SetId set_id_cur: element_cur.sets) {
@@ -2125,59 +2888,84 @@ bool Reduction::reduce_unconfined_sets(Tmp& tmp)
 
     // Update mandatory_sets.
     for (SetId set_id: fixed_sets)
-        for (SetId orig_set_id: unreduction_operations_[set_id].in)
-            mandatory_sets_.push_back(orig_set_id);
-    // Update sets.
+        for (SetId orig_set_id: tmp.unreduction_operations[set_id].in)
+            tmp.mandatory_sets.push_back(orig_set_id);
+    remove_elements(tmp, elements_to_remove);
+    remove_sets(tmp, fixed_sets);
+
+    //check(tmp.instance);
+    if (needs_update(tmp.instance))
+        update(tmp);
+    return true;
+}
+
+void Reduction::compute_signatures(Tmp& tmp)
+{
+    const ReductionInstance& reduction_instance = tmp.instance;
+    if (collect_modified(tmp, WorklistConsumer::Signatures)) {
+        for (SetId set_id: tmp.modified_sets) {
+            tmp.set_signatures[set_id] = 0;
+            for (ElementId element_id: reduction_instance.set(set_id).elements)
+                tmp.set_signatures[set_id] |= (uint64_t)1 << (tmp.random_[element_id] % 64);
+        }
+        for (ElementId element_id: tmp.modified_elements) {
+            tmp.element_signatures[element_id] = 0;
+            for (SetId set_id: reduction_instance.element(element_id).sets)
+                tmp.element_signatures[element_id] |= (uint64_t)1 << (tmp.random_[set_id] % 64);
+        }
+        return;
+    }
+
+    tmp.set_signatures.assign(reduction_instance.number_of_sets(), 0);
     for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
+            set_id < reduction_instance.number_of_sets();
             ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
+        const ReductionSet& set = reduction_instance.set(set_id);
         if (set.removed)
             continue;
-        if (fixed_sets.contains(set_id)) {
-            set.removed = true;
-        } else {
-            for (ElementPos pos = 0;
-                    pos < (ElementPos)set.elements.size();
-                    ) {
-                ElementId element_id = set.elements[pos];
-                if (elements_to_remove.contains(element_id)) {
-                    set.elements[pos] = set.elements.back();
-                    set.elements.pop_back();
-                } else {
-                    pos++;
-                }
-            }
-        }
+        for (ElementId element_id: set.elements)
+            tmp.set_signatures[set_id] |= (uint64_t)1 << (tmp.random_[element_id] % 64);
     }
-    // Update elements.
+    tmp.element_signatures.assign(reduction_instance.number_of_elements(), 0);
     for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
+            element_id < reduction_instance.number_of_elements();
             ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
+        const ReductionElement& element = reduction_instance.element(element_id);
         if (element.removed)
             continue;
-        if (elements_to_remove.contains(element_id)) {
-            element.removed = true;
-        } else {
-            for (ElementPos pos = 0;
-                    pos < (ElementPos)element.sets.size();
-                    ) {
-                ElementId set_id = element.sets[pos];
-                if (fixed_sets.contains(set_id)) {
-                    element.sets[pos] = element.sets.back();
-                    element.sets.pop_back();
-                } else {
-                    pos++;
-                }
-            }
+        for (SetId set_id: element.sets)
+            tmp.element_signatures[element_id] |= (uint64_t)1 << (tmp.random_[set_id] % 64);
+    }
+}
+
+namespace
+{
+
+/**
+ * Return 'true' iff 'values' contains all the elements of 'marked'.
+ *
+ * The values are expected to be distinct.
+ */
+template <typename Id>
+bool contains_marked(
+        const IndexRange<Id>& values,
+        const optimizationtools::IndexedSet& marked)
+{
+    Index number_of_marked_values = marked.size();
+    Index number_of_found_values = 0;
+    for (Index pos = 0; pos < (Index)values.size(); ++pos) {
+        if (marked.contains(values[pos])) {
+            number_of_found_values++;
+            if (number_of_found_values == number_of_marked_values)
+                return true;
+        } else if (number_of_found_values + (Index)values.size() - pos - 1
+                < number_of_marked_values) {
+            return false;
         }
     }
+    return number_of_found_values == number_of_marked_values;
+}
 
-    //check(tmp.instance);
-    if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
-    return true;
 }
 
 bool Reduction::reduce_dominated_sets_2(
@@ -2189,37 +2977,68 @@ bool Reduction::reduce_dominated_sets_2(
     optimizationtools::IndexedSet& covered_elements = tmp.indexed_set_;
     covered_elements.resize_and_clear(tmp.instance.number_of_elements());
     optimizationtools::IndexedSet& set_neighbors = tmp.indexed_set_3_;
-    set_neighbors.resize_and_clear(tmp.instance.number_of_sets());
-    optimizationtools::IndexedSet& sets_to_remove = tmp.indexed_set_2_;
-    sets_to_remove.resize_and_clear(tmp.instance.number_of_sets());
-
-    // For each element, get the list of 2-covering sets covering it.
-    std::vector<std::vector<SetId>> sets(tmp.instance.number_of_elements());
-    SetPos nb_sets = 0;
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        const ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
+    set_neighbors.resize_and_clear(tmp.instance.number_of_sets());
+    optimizationtools::IndexedSet& sets_to_remove = tmp.indexed_set_2_;
+    sets_to_remove.resize_and_clear(tmp.instance.number_of_sets());
 
-        for (SetId set_id: element.sets) {
-            const ReductionSet& set = tmp.instance.set(set_id);
-            if (set.elements.size() == 2) {
-                sets[element_id].push_back(set_id);
-                nb_sets++;
+    compute_signatures(tmp);
+    bool incremental = collect_modified(tmp, WorklistConsumer::DominatedSets2);
+
+    // For each element, get the number of 2-covering sets covering it. After
+    // the first call, they are only counted for the elements of the
+    // candidates.
+    std::vector<SetPos> numbers_of_sets_2;
+    if (!incremental) {
+        numbers_of_sets_2.resize(tmp.instance.number_of_elements(), 0);
+        SetPos nb_sets = 0;
+        SetPos nb_dominating_sets = 0;
+        for (ElementId element_id = 0;
+                element_id < tmp.instance.number_of_elements();
+                ++element_id) {
+            const ReductionElement& element = tmp.instance.element(element_id);
+            if (element.removed)
+                continue;
+
+            for (SetId set_id: element.sets) {
+                const ReductionSet& set = tmp.instance.set(set_id);
+                if (set.elements.size() == 2) {
+                    numbers_of_sets_2[element_id]++;
+                    nb_sets++;
+                } else if (set.elements.size() > 2) {
+                    nb_dominating_sets++;
+                }
             }
         }
+        if (nb_sets == 0 || nb_dominating_sets == 0)
+            return false;
     }
-    if (nb_sets == 0)
-        return false;
-
+    auto number_of_sets_2 = [&tmp, &numbers_of_sets_2, incremental](ElementId element_id) -> SetPos
+    {
+        if (!incremental)
+            return numbers_of_sets_2[element_id];
+        SetPos number_of_sets_2 = 0;
+        for (SetId set_id: tmp.instance.element(element_id).sets)
+            if (tmp.instance.set(set_id).elements.size() == 2)
+                number_of_sets_2++;
+        return number_of_sets_2;
+    };
+
+    // The dominating sets cover more than 2 elements, so they are never
+    // removed by this rule and all the sets can be checked.
     std::vector<SetId>& shuffled_sets = tmp.set_;
-    shuffled_sets.resize(tmp.instance.number_of_sets());
-    std::iota(shuffled_sets.begin(), shuffled_sets.end(), 0);
+    if (incremental) {
+        // A set can only have become dominated if its elements have been
+        // modified, or if one of its elements has been modified (a set gains
+        // elements only when it is folded).
+        add_sets_of_modified_elements(tmp);
+        shuffled_sets.assign(tmp.modified_sets.begin(), tmp.modified_sets.end());
+    } else {
+        shuffled_sets.resize(tmp.instance.number_of_sets());
+        std::iota(shuffled_sets.begin(), shuffled_sets.end(), 0);
+    }
     std::shuffle(shuffled_sets.begin(), shuffled_sets.end(), tmp.generator_);
     for (auto it = shuffled_sets.begin();
-            it != shuffled_sets.begin() + (std::min)(tmp.instance.number_of_sets(), tmp.instance.number_of_elements());
+            it != shuffled_sets.end();
             ++it) {
         // Check timer.
         if (parameters.timer.needs_to_end())
@@ -2240,11 +3059,18 @@ bool Reduction::reduce_dominated_sets_2(
         const ReductionElement& element_1 = tmp.instance.element(element_id_1);
         const ReductionElement& element_2 = tmp.instance.element(element_id_2);
 
+        SetPos number_of_sets_2_1 = number_of_sets_2(element_id_1);
+        SetPos number_of_sets_2_2 = number_of_sets_2(element_id_2);
         ElementId element_id = element_id_1;
-        if (element_1.sets.size() - sets[element_id_1].size()
-                > element_2.sets.size() - sets[element_id_2].size()) {
+        SetPos element_number_of_sets_2 = number_of_sets_2_1;
+        if ((SetPos)element_1.sets.size() - number_of_sets_2_1
+                > (SetPos)element_2.sets.size() - number_of_sets_2_2) {
             element_id = element_id_2;
+            element_number_of_sets_2 = number_of_sets_2_2;
         }
+        // Only the sets covering more than 2 elements can dominate the set.
+        if ((SetPos)tmp.instance.element(element_id).sets.size() == element_number_of_sets_2)
+            continue;
 
         for (SetId set_id_2 : tmp.instance.element(element_id).sets) {
             if (set_id_2 == set_id)
@@ -2256,6 +3082,8 @@ bool Reduction::reduce_dominated_sets_2(
                 continue;
             if (set_2.elements.size() <= 2)
                 continue;
+            if ((tmp.set_signatures[set_id] & ~tmp.set_signatures[set_id_2]) != 0)
+                continue;
 
             bool found_1 = false;
             bool found_2 = false;
@@ -2285,41 +3113,13 @@ bool Reduction::reduce_dominated_sets_2(
 
     // Update mandatory_sets.
     for (SetId set_id: sets_to_remove)
-        for (SetId orig_set_id: unreduction_operations_[set_id].out)
-            mandatory_sets_.push_back(orig_set_id);
-    // Update sets.
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        if (sets_to_remove.contains(set_id))
-            set.removed = true;
-    }
-    // Update elements.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        for (ElementPos pos = 0;
-                pos < (ElementPos)element.sets.size();
-                ) {
-            ElementId set_id = element.sets[pos];
-            if (sets_to_remove.contains(set_id)) {
-                element.sets[pos] = element.sets.back();
-                element.sets.pop_back();
-            } else {
-                pos++;
-            }
-        }
-    }
+        for (SetId orig_set_id: tmp.unreduction_operations[set_id].out)
+            tmp.mandatory_sets.push_back(orig_set_id);
+    remove_sets(tmp, sets_to_remove);
 
     //check(tmp.instance);
     if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
+        update(tmp);
     return true;
 }
 
@@ -2336,32 +3136,62 @@ bool Reduction::reduce_dominated_elements_2(
     optimizationtools::IndexedSet& elements_to_remove = tmp.indexed_set_2_;
     elements_to_remove.resize_and_clear(tmp.instance.number_of_elements());
 
-    // For each set, get the list of 2-covered elements it covers.
-    std::vector<std::vector<ElementId>> elements(tmp.instance.number_of_sets());
-    SetPos nb_elements = 0;
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        const ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        for (ElementId element_id: set.elements) {
-            const ReductionElement& element = tmp.instance.element(element_id);
-            if (element.sets.size() == 2) {
-                elements[set_id].push_back(element_id);
-                nb_elements++;
+    compute_signatures(tmp);
+    bool incremental = collect_modified(tmp, WorklistConsumer::DominatedElements2);
+
+    // For each set, get the number of 2-covered elements it covers. After the
+    // first call, they are only counted for the sets of the candidates.
+    std::vector<ElementPos> numbers_of_elements_2;
+    if (!incremental) {
+        numbers_of_elements_2.resize(tmp.instance.number_of_sets(), 0);
+        SetPos nb_elements = 0;
+        SetPos nb_dominated_elements = 0;
+        for (SetId set_id = 0;
+                set_id < tmp.instance.number_of_sets();
+                ++set_id) {
+            const ReductionSet& set = tmp.instance.set(set_id);
+            if (set.removed)
+                continue;
+            for (ElementId element_id: set.elements) {
+                const ReductionElement& element = tmp.instance.element(element_id);
+                if (element.sets.size() == 2) {
+                    numbers_of_elements_2[set_id]++;
+                    nb_elements++;
+                } else if (element.sets.size() > 2) {
+                    nb_dominated_elements++;
+                }
             }
         }
+        if (nb_elements == 0 || nb_dominated_elements == 0)
+            return false;
     }
-    if (nb_elements == 0)
-        return false;
-
+    auto number_of_elements_2 = [&tmp, &numbers_of_elements_2, incremental](SetId set_id) -> ElementPos
+    {
+        if (!incremental)
+            return numbers_of_elements_2[set_id];
+        ElementPos number_of_elements_2 = 0;
+        for (ElementId element_id: tmp.instance.set(set_id).elements)
+            if (tmp.instance.element(element_id).sets.size() == 2)
+                number_of_elements_2++;
+        return number_of_elements_2;
+    };
+
+    // The dominating elements are covered by 2 sets, so they are never
+    // removed by this rule and all the elements can be checked.
     std::vector<ElementId>& shuffled_elements = tmp.set_;
-    shuffled_elements.resize(tmp.instance.number_of_elements());
-    std::iota(shuffled_elements.begin(), shuffled_elements.end(), 0);
+    if (incremental) {
+        // An element can only have started to dominate another element if
+        // its sets have been modified, or if one of its sets has been
+        // modified (an element gains sets only when a set is folded).
+        add_elements_of_modified_sets(tmp);
+        shuffled_elements.assign(tmp.modified_elements.begin(), tmp.modified_elements.end());
+    } else {
+        shuffled_elements.resize(tmp.instance.number_of_elements());
+        std::iota(shuffled_elements.begin(), shuffled_elements.end(), 0);
+    }
     std::shuffle(shuffled_elements.begin(), shuffled_elements.end(), tmp.generator_);
     for (auto it = shuffled_elements.begin();
-            it != shuffled_elements.begin() + (std::min)(tmp.instance.number_of_sets(), tmp.instance.number_of_elements());
+            it != shuffled_elements.end();
             ++it) {
         // Check timer.
         if (parameters.timer.needs_to_end())
@@ -2380,11 +3210,18 @@ bool Reduction::reduce_dominated_elements_2(
         const ReductionSet& set_1 = tmp.instance.set(set_id_1);
         const ReductionSet& set_2 = tmp.instance.set(set_id_2);
 
+        ElementPos number_of_elements_2_1 = number_of_elements_2(set_id_1);
+        ElementPos number_of_elements_2_2 = number_of_elements_2(set_id_2);
         SetId set_id = set_id_1;
-        if (set_1.elements.size() - elements[set_id_1].size()
-                > set_2.elements.size() - elements[set_id_2].size()) {
+        ElementPos set_number_of_elements_2 = number_of_elements_2_1;
+        if ((ElementPos)set_1.elements.size() - number_of_elements_2_1
+                > (ElementPos)set_2.elements.size() - number_of_elements_2_2) {
             set_id = set_id_2;
+            set_number_of_elements_2 = number_of_elements_2_2;
         }
+        // Only the elements covered by more than 2 sets can be dominated.
+        if ((ElementPos)tmp.instance.set(set_id).elements.size() == set_number_of_elements_2)
+            continue;
 
         for (ElementId element_id_2: tmp.instance.set(set_id).elements) {
             if (element_id_2 == element_id)
@@ -2396,6 +3233,8 @@ bool Reduction::reduce_dominated_elements_2(
 
             if (element_2.sets.size() <= 2)
                 continue;
+            if ((tmp.element_signatures[element_id] & ~tmp.element_signatures[element_id_2]) != 0)
+                continue;
 
             bool found_1 = false;
             bool found_2 = false;
@@ -2421,39 +3260,11 @@ bool Reduction::reduce_dominated_elements_2(
 
     //std::cout << elements_to_remove.size() << std::endl;
 
-    // Update sets.
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        for (ElementPos pos = 0;
-                pos < (ElementPos)set.elements.size();
-                ) {
-            ElementId element_id = set.elements[pos];
-            if (elements_to_remove.contains(element_id)) {
-                set.elements[pos] = set.elements.back();
-                set.elements.pop_back();
-            } else {
-                pos++;
-            }
-        }
-    }
-    // Update elements.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        if (elements_to_remove.contains(element_id))
-            element.removed = true;
-    }
+    remove_elements(tmp, elements_to_remove);
 
     //check(tmp.instance);
     if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
+        update(tmp);
     return true;
 }
 
@@ -2463,118 +3274,116 @@ bool Reduction::reduce_dominated_elements(
 {
     //std::cout << "reduce_dominated_elements..." << std::endl;
 
-    optimizationtools::IndexedSet& covered_sets = tmp.indexed_set_;
-    covered_sets.resize_and_clear(tmp.instance.number_of_sets());
     optimizationtools::IndexedSet& elements_to_remove = tmp.indexed_set_2_;
     elements_to_remove.resize_and_clear(tmp.instance.number_of_elements());
 
+    compute_signatures(tmp);
     std::vector<ElementId>& shuffled_elements = tmp.set_;
-    shuffled_elements.resize(tmp.instance.number_of_elements());
-    std::iota(shuffled_elements.begin(), shuffled_elements.end(), 0);
+    if (collect_modified(tmp, WorklistConsumer::DominatedElements)) {
+        // An element can only have started to dominate another element if
+        // its sets have been modified, or if one of its sets has been
+        // modified (an element gains sets only when a set is folded).
+        add_elements_of_modified_sets(tmp);
+        shuffled_elements.assign(tmp.modified_elements.begin(), tmp.modified_elements.end());
+    } else {
+        shuffled_elements.resize(tmp.instance.number_of_elements());
+        std::iota(shuffled_elements.begin(), shuffled_elements.end(), 0);
+    }
     std::shuffle(shuffled_elements.begin(), shuffled_elements.end(), tmp.generator_);
-    for (auto it = shuffled_elements.begin();
-            it != shuffled_elements.begin() + (std::min)(tmp.instance.number_of_sets(), tmp.instance.number_of_elements());
-            ++it) {
-        // Check timer.
-        if (parameters.timer.needs_to_end())
-            break;
-
-        if (elements_to_remove.size() > 0.01 * tmp.instance.number_of_elements())
-            break;
 
-        ElementId element_id_1 = *it;
-        if (elements_to_remove.contains(element_id_1)) {
-            continue;
-        }
+    // The candidates are checked in parallel against the current instance.
+    // Domination is a strict partial order (an element dominates the elements
+    // covered by a strict superset of its sets), so an element which doesn't
+    // dominate any other element is never removed and all the dominated
+    // elements can be removed at once, whichever dominating element has been
+    // found. Therefore, the result doesn't depend on the number of threads.
+    ElementId number_of_candidates = shuffled_elements.size();
+    Counter number_of_threads = (std::max)((Counter)1, parameters.number_of_threads);
+    std::vector<std::vector<ElementId>> threads_elements_to_remove(number_of_threads);
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([&tmp, &parameters, &shuffled_elements, &threads_elements_to_remove, number_of_candidates, number_of_threads, thread_id]()
+        {
+            const ReductionInstance& reduction_instance = tmp.instance;
+            optimizationtools::IndexedSet covered_sets(reduction_instance.number_of_sets());
+            optimizationtools::IndexedSet dominated_elements(reduction_instance.number_of_elements());
+            for (ElementId candidate_pos = thread_id * number_of_candidates / number_of_threads;
+                    candidate_pos < (thread_id + 1) * number_of_candidates / number_of_threads;
+                    ++candidate_pos) {
+                // Check timer.
+                if (parameters.timer.needs_to_end())
+                    break;
 
-        const ReductionElement& element_1 = tmp.instance.element(element_id_1);
-        if (element_1.removed)
-            continue;
-        if (element_1.sets.size() <= 2)
-            continue;
+                ElementId element_id_1 = shuffled_elements[candidate_pos];
+                const ReductionElement& element_1 = reduction_instance.element(element_id_1);
+                if (element_1.removed)
+                    continue;
+                if (element_1.sets.size() <= 2)
+                    continue;
 
-        SetId set_id_1 = -1;
-        ElementPos size_min = tmp.instance.number_of_elements() + 1;
-        for (SetPos pos = 0;
-                pos < (SetPos)element_1.sets.size();
-                ++pos) {
-            SetId set_id = element_1.sets[pos];
-            ElementPos size = tmp.instance.set(set_id).elements.size();
-            if (size < size_min) {
-                size_min = size;
-                set_id_1 = set_id;
-                if (size_min == 2)
-                    break;
-                if (pos > 16 && size_min < 8)
-                    break;
-            }
-        }
-        const ReductionSet& set_1 = tmp.instance.set(set_id_1);
+                SetId set_id_1 = -1;
+                ElementPos size_min = std::numeric_limits<ElementPos>::max();
+                for (SetPos pos = 0;
+                        pos < (SetPos)element_1.sets.size();
+                        ++pos) {
+                    SetId set_id = element_1.sets[pos];
+                    ElementPos size = reduction_instance.set(set_id).elements.size();
+                    if (size < size_min) {
+                        size_min = size;
+                        set_id_1 = set_id;
+                        if (size_min == 2)
+                            break;
+                        if (pos > 16 && size_min < 8)
+                            break;
+                    }
+                }
 
-        for (ElementId element_id_2: tmp.instance.set(set_id_1).elements) {
-            if (element_id_2 == element_id_1)
-                continue;
-            if (elements_to_remove.contains(element_id_2)) {
-                continue;
-            }
-            const ReductionElement& element_2 = tmp.instance.element(element_id_2);
-            if (element_2.sets.size() <= element_1.sets.size())
-                continue;
-            covered_sets.clear();
-            for (SetId set_id: element_2.sets)
-                covered_sets.add(set_id);
-            // Check if element_id_1 dominates element_id_2
-            bool dominates = true;
-            for (SetId set_id: element_1.sets) {
-                if (!covered_sets.contains(set_id)) {
-                    dominates = false;
-                    break;
+                // The sets of element_1 are marked once, when the first
+                // candidate passes the signature test.
+                uint64_t signature_1 = tmp.element_signatures[element_id_1];
+                covered_sets.clear();
+                for (ElementId element_id_2: reduction_instance.set(set_id_1).elements) {
+                    if (element_id_2 == element_id_1)
+                        continue;
+                    if (dominated_elements.contains(element_id_2))
+                        continue;
+                    const ReductionElement& element_2 = reduction_instance.element(element_id_2);
+                    if (element_2.sets.size() <= element_1.sets.size())
+                        continue;
+                    if ((signature_1 & ~tmp.element_signatures[element_id_2]) != 0)
+                        continue;
+                    if (covered_sets.size() == 0)
+                        for (SetId set_id: element_1.sets)
+                            covered_sets.add(set_id);
+                    // Check if element_id_1 dominates element_id_2
+                    if (contains_marked(element_2.sets, covered_sets))
+                        dominated_elements.add(element_id_2);
                 }
             }
-            if (dominates) {
-                elements_to_remove.add(element_id_2);
-            }
-        }
+            threads_elements_to_remove[thread_id].assign(
+                    dominated_elements.begin(),
+                    dominated_elements.end());
+        }));
     }
+    for (std::thread& thread: threads)
+        thread.join();
+
+    // Merge the elements found by each thread, in the order of the threads.
+    for (const std::vector<ElementId>& element_ids: threads_elements_to_remove)
+        for (ElementId element_id: element_ids)
+            if (!elements_to_remove.contains(element_id))
+                elements_to_remove.add(element_id);
 
     if (elements_to_remove.size() == 0)
         return false;
 
     //std::cout << elements_to_remove.size() << std::endl;
 
-    // Update sets.
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        for (ElementPos pos = 0;
-                pos < (ElementPos)set.elements.size();
-                ) {
-            ElementId element_id = set.elements[pos];
-            if (elements_to_remove.contains(element_id)) {
-                set.elements[pos] = set.elements.back();
-                set.elements.pop_back();
-            } else {
-                pos++;
-            }
-        }
-    }
-    // Update elements.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        if (elements_to_remove.contains(element_id))
-            element.removed = true;
-    }
+    remove_elements(tmp, elements_to_remove);
 
     //check(tmp.instance);
     if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
+        update(tmp);
     return true;
 }
 
@@ -2584,86 +3393,112 @@ bool Reduction::reduce_dominated_sets(
 {
     //std::cout << "reduce_dominated_sets..." << std::endl;
 
-    optimizationtools::IndexedSet& covered_elements = tmp.indexed_set_;
-    covered_elements.resize_and_clear(tmp.instance.number_of_elements());
     optimizationtools::IndexedSet& sets_to_remove = tmp.indexed_set_2_;
     sets_to_remove.resize_and_clear(tmp.instance.number_of_sets());
 
+    compute_signatures(tmp);
     std::vector<SetId>& shuffled_sets = tmp.set_;
-    shuffled_sets.resize(tmp.instance.number_of_sets());
-    std::iota(shuffled_sets.begin(), shuffled_sets.end(), 0);
+    if (collect_modified(tmp, WorklistConsumer::DominatedSets)) {
+        // A set can only have become dominated if its elements have been
+        // modified, or if one of its elements has been modified (a set gains
+        // elements only when it is folded).
+        add_sets_of_modified_elements(tmp);
+        shuffled_sets.assign(tmp.modified_sets.begin(), tmp.modified_sets.end());
+    } else {
+        shuffled_sets.resize(tmp.instance.number_of_sets());
+        std::iota(shuffled_sets.begin(), shuffled_sets.end(), 0);
+    }
     std::shuffle(shuffled_sets.begin(), shuffled_sets.end(), tmp.generator_);
-    for (auto it = shuffled_sets.begin();
-            it != shuffled_sets.begin() + (std::min)(tmp.instance.number_of_sets(), tmp.instance.number_of_elements());
-            ++it) {
-        // Check timer.
-        if (parameters.timer.needs_to_end())
-            break;
 
-        if (sets_to_remove.size() > 0.01 * tmp.instance.number_of_sets())
-            break;
+    // The candidates are checked in parallel against the current instance.
+    // Domination is a strict partial order (a set is dominated by a superset
+    // with more elements or with a smaller cost), so a set which isn't
+    // dominated is never removed and all the dominated sets can be removed at
+    // once, whichever dominating set has been found. Therefore, the result
+    // doesn't depend on the number of threads.
+    SetId number_of_candidates = shuffled_sets.size();
+    Counter number_of_threads = (std::max)((Counter)1, parameters.number_of_threads);
+    std::vector<std::vector<SetId>> threads_sets_to_remove(number_of_threads);
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([&tmp, &parameters, &shuffled_sets, &threads_sets_to_remove, number_of_candidates, number_of_threads, thread_id]()
+        {
+            const ReductionInstance& reduction_instance = tmp.instance;
+            optimizationtools::IndexedSet covered_elements(reduction_instance.number_of_elements());
+            for (SetId candidate_pos = thread_id * number_of_candidates / number_of_threads;
+                    candidate_pos < (thread_id + 1) * number_of_candidates / number_of_threads;
+                    ++candidate_pos) {
+                // Check timer.
+                if (parameters.timer.needs_to_end())
+                    break;
 
-        SetId set_id_1 = *it;
-        const ReductionSet& set_1 = tmp.instance.set(set_id_1);
-        if (set_1.removed)
-            continue;
-        if (set_1.elements.size() <= 2)
-            continue;
+                SetId set_id_1 = shuffled_sets[candidate_pos];
+                const ReductionSet& set_1 = reduction_instance.set(set_id_1);
+                if (set_1.removed)
+                    continue;
+                if (set_1.elements.size() <= 2)
+                    continue;
 
-        ElementId element_id_1 = -1;
-        SetPos size_min = tmp.instance.number_of_sets() + 1;
-        for (ElementPos pos = 0;
-                pos < (ElementPos)set_1.elements.size();
-                ++pos) {
-            ElementId element_id = set_1.elements[pos];
-            SetPos size = tmp.instance.element(element_id).sets.size();
-            if (size < size_min) {
-                size_min = size;
-                element_id_1 = element_id;
-                if (size_min == 2)
-                    break;
-                if (pos > 16 && size_min < 8)
-                    break;
-            }
-        }
-        // set_1 will be dominated only by another set that contains at least element_id_1
-        // no need to loop through others elements
-        const ReductionElement& element_1 = tmp.instance.element(element_id_1);
-        for (SetId set_id_2: element_1.sets) {
-            if (set_id_2 == set_id_1)
-                continue;
-            if (sets_to_remove.contains(set_id_2))
-                continue;
-            const ReductionSet& set_2 = tmp.instance.set(set_id_2);
-            if (set_2.elements.size() <= 2)
-                continue;
-            if (set_2.elements.size() < set_1.elements.size())
-                continue;
-            if (set_2.cost > set_1.cost)
-                continue;
-            if (set_2.elements.size() == set_1.elements.size()
-                    && set_2.cost >= set_1.cost)
-                continue;
-            if (set_2.elements.size() <= set_1.elements.size()
-                    && set_1.cost == set_2.cost)
-                continue;
-            covered_elements.clear();
-            for (ElementId element_id: set_2.elements)
-                covered_elements.add(element_id);
-            // Check if set_id_2 dominates set_id_1
-            bool dominates = true;
-            for (ElementId element_id: set_1.elements) {
-                if (!covered_elements.contains(element_id)) {
-                    dominates = false;
-                    break;
+                ElementId element_id_1 = -1;
+                SetPos size_min = std::numeric_limits<SetPos>::max();
+                for (ElementPos pos = 0;
+                        pos < (ElementPos)set_1.elements.size();
+                        ++pos) {
+                    ElementId element_id = set_1.elements[pos];
+                    SetPos size = reduction_instance.element(element_id).sets.size();
+                    if (size < size_min) {
+                        size_min = size;
+                        element_id_1 = element_id;
+                        if (size_min == 2)
+                            break;
+                        if (pos > 16 && size_min < 8)
+                            break;
+                    }
+                }
+                // set_1 will be dominated only by another set that contains at least element_id_1
+                // no need to loop through others elements
+                // The elements of set_1 are marked once, when the first
+                // candidate passes the signature test.
+                const ReductionElement& element_1 = reduction_instance.element(element_id_1);
+                uint64_t signature_1 = tmp.set_signatures[set_id_1];
+                covered_elements.clear();
+                for (SetId set_id_2: element_1.sets) {
+                    if (set_id_2 == set_id_1)
+                        continue;
+                    const ReductionSet& set_2 = reduction_instance.set(set_id_2);
+                    if (set_2.elements.size() <= 2)
+                        continue;
+                    if (set_2.elements.size() < set_1.elements.size())
+                        continue;
+                    if (set_2.cost > set_1.cost)
+                        continue;
+                    if (set_2.elements.size() == set_1.elements.size()
+                            && set_2.cost >= set_1.cost)
+                        continue;
+                    if (set_2.elements.size() <= set_1.elements.size()
+                            && set_1.cost == set_2.cost)
+                        continue;
+                    if ((signature_1 & ~tmp.set_signatures[set_id_2]) != 0)
+                        continue;
+                    if (covered_elements.size() == 0)
+                        for (ElementId element_id: set_1.elements)
+                            covered_elements.add(element_id);
+                    // Check if set_id_2 dominates set_id_1
+                    if (contains_marked(set_2.elements, covered_elements)) {
+                        threads_sets_to_remove[thread_id].push_back(set_id_1);
+                        break;
+                    }
                 }
             }
-            if (dominates) {
-                sets_to_remove.add(set_id_1);
-                break;
-            }
-        }
+        }));
     }
+    for (std::thread& thread: threads)
+        thread.join();
+
+    // Merge the sets found by each thread, in the order of the threads.
+    for (const std::vector<SetId>& set_ids: threads_sets_to_remove)
+        for (SetId set_id: set_ids)
+            sets_to_remove.add(set_id);
 
     if (sets_to_remove.size() == 0)
         return false;
@@ -2672,52 +3507,220 @@ bool Reduction::reduce_dominated_sets(
 
     // Update mandatory_sets.
     for (SetId set_id: sets_to_remove)
-        for (SetId orig_set_id: unreduction_operations_[set_id].out)
-            mandatory_sets_.push_back(orig_set_id);
-    // Update sets.
-    for (SetId set_id = 0;
-            set_id < tmp.instance.number_of_sets();
-            ++set_id) {
-        ReductionSet& set = tmp.instance.set(set_id);
-        if (set.removed)
-            continue;
-        if (sets_to_remove.contains(set_id))
-            set.removed = true;
+        for (SetId orig_set_id: tmp.unreduction_operations[set_id].out)
+            tmp.mandatory_sets.push_back(orig_set_id);
+    remove_sets(tmp, sets_to_remove);
+
+    //check(tmp.instance);
+    if (needs_update(tmp.instance))
+        update(tmp);
+    return true;
+}
+
+namespace
+{
+
+/** Maximum number of nodes explored to solve a small component exactly. */
+constexpr Counter small_component_maximum_number_of_nodes = 100000;
+
+/**
+ * Branch-and-bound solving exactly an instance with at most 64 sets and 64
+ * elements.
+ *
+ * The sets covering an element and the elements covered by a set are stored
+ * as bitsets. At each node, the algorithm branches on the sets covering the
+ * uncovered element covered by the fewest sets. The lower bound is the sum,
+ * over uncovered elements covered by pairwise disjoint groups of sets, of the
+ * cheapest set covering each of them. The lowest cost at which each set of
+ * uncovered elements has been reached is memoized, so that the nodes reached
+ * again with a higher cost are pruned.
+ */
+class SmallComponentSolver
+{
+
+public:
+
+    /** Constructor. */
+    SmallComponentSolver(
+            const std::vector<std::vector<ElementId>>& sets_elements,
+            const std::vector<Cost>& costs,
+            ElementId number_of_elements):
+        costs_(costs),
+        sets_elements_(sets_elements.size(), 0),
+        elements_sets_(number_of_elements),
+        elements_sets_masks_(number_of_elements, 0),
+        elements_minimum_costs_(number_of_elements, -1)
+    {
+        for (SetId set_id = 0; set_id < (SetId)sets_elements.size(); ++set_id) {
+            for (ElementId element_id: sets_elements[set_id]) {
+                if (elements_sets_masks_[element_id] & ((uint64_t)1 << set_id))
+                    continue;
+                sets_elements_[set_id] |= (uint64_t)1 << element_id;
+                elements_sets_[element_id].push_back(set_id);
+                elements_sets_masks_[element_id] |= (uint64_t)1 << set_id;
+                if (elements_minimum_costs_[element_id] == -1
+                        || elements_minimum_costs_[element_id] > costs[set_id]) {
+                    elements_minimum_costs_[element_id] = costs[set_id];
+                }
+            }
+        }
+        for (ElementId element_id = 0; element_id < number_of_elements; ++element_id)
+            sorted_elements_.push_back(element_id);
+        std::stable_sort(
+                sorted_elements_.begin(),
+                sorted_elements_.end(),
+                [this](ElementId element_id_1, ElementId element_id_2)
+                {
+                    return elements_sets_[element_id_1].size()
+                        < elements_sets_[element_id_2].size();
+                });
     }
-    // Update elements.
-    for (ElementId element_id = 0;
-            element_id < tmp.instance.number_of_elements();
-            ++element_id) {
-        ReductionElement& element = tmp.instance.element(element_id);
-        if (element.removed)
-            continue;
-        for (ElementPos pos = 0;
-                pos < (ElementPos)element.sets.size();
-                ) {
-            ElementId set_id = element.sets[pos];
-            if (sets_to_remove.contains(set_id)) {
-                element.sets[pos] = element.sets.back();
-                element.sets.pop_back();
-            } else {
-                pos++;
+
+    /**
+     * Solve the instance.
+     *
+     * Return 'false' if the maximum number of nodes has been reached before
+     * the optimal solution has been proved, or if the instance is infeasible.
+     */
+    bool solve(
+            const optimizationtools::Timer& timer,
+            uint64_t& solution)
+    {
+        uint64_t uncovered_elements = 0;
+        for (ElementId element_id: sorted_elements_)
+            uncovered_elements |= (uint64_t)1 << element_id;
+        branch(timer, uncovered_elements, 0, 0);
+        if (number_of_nodes_ > small_component_maximum_number_of_nodes
+                || best_cost_ == -1) {
+            return false;
+        }
+        solution = best_solution_;
+        return true;
+    }
+
+private:
+
+    /** Compute a lower bound of the cost to cover the uncovered elements. */
+    Cost bound(uint64_t uncovered_elements) const
+    {
+        Cost bound = 0;
+        uint64_t used_sets = 0;
+        for (ElementId element_id: sorted_elements_) {
+            if (!(uncovered_elements & ((uint64_t)1 << element_id)))
+                continue;
+            if (elements_sets_masks_[element_id] & used_sets)
+                continue;
+            bound += elements_minimum_costs_[element_id];
+            used_sets |= elements_sets_masks_[element_id];
+        }
+        return bound;
+    }
+
+    /** Explore a node of the branching tree. */
+    void branch(
+            const optimizationtools::Timer& timer,
+            uint64_t uncovered_elements,
+            uint64_t selected_sets,
+            Cost cost)
+    {
+        number_of_nodes_++;
+        if (number_of_nodes_ > small_component_maximum_number_of_nodes)
+            return;
+        if (timer.needs_to_end()) {
+            number_of_nodes_ = small_component_maximum_number_of_nodes + 1;
+            return;
+        }
+
+        if (uncovered_elements == 0) {
+            if (best_cost_ == -1 || cost < best_cost_) {
+                best_cost_ = cost;
+                best_solution_ = selected_sets;
+            }
+            return;
+        }
+
+        if (best_cost_ != -1
+                && cost + bound(uncovered_elements) >= best_cost_) {
+            return;
+        }
+
+        auto it = costs_to_reach_.find(uncovered_elements);
+        if (it != costs_to_reach_.end() && it->second <= cost)
+            return;
+        costs_to_reach_[uncovered_elements] = cost;
+
+        // Branch on the uncovered element covered by the fewest sets.
+        ElementId element_id = -1;
+        for (ElementId element_id_cur: sorted_elements_) {
+            if (uncovered_elements & ((uint64_t)1 << element_id_cur)) {
+                element_id = element_id_cur;
+                break;
             }
         }
+
+        // Try the sets with the smallest cost per newly covered element
+        // first.
+        std::vector<std::pair<double, SetId>> sorted_sets;
+        for (SetId set_id: elements_sets_[element_id]) {
+            ElementId number_of_covered_elements = 0;
+            uint64_t covered_elements = sets_elements_[set_id] & uncovered_elements;
+            for (; covered_elements != 0; covered_elements &= covered_elements - 1)
+                number_of_covered_elements++;
+            sorted_sets.push_back({
+                    (double)costs_[set_id] / number_of_covered_elements,
+                    set_id});
+        }
+        std::stable_sort(sorted_sets.begin(), sorted_sets.end());
+        for (const auto& p: sorted_sets) {
+            SetId set_id = p.second;
+            branch(
+                    timer,
+                    uncovered_elements & ~sets_elements_[set_id],
+                    selected_sets | ((uint64_t)1 << set_id),
+                    cost + costs_[set_id]);
+        }
     }
 
-    //check(tmp.instance);
-    if (needs_update(tmp.instance))
-        update(tmp.instance, unreduction_operations_);
-    return true;
+    /** Costs of the sets. */
+    const std::vector<Cost>& costs_;
+
+    /** Elements covered by each set. */
+    std::vector<uint64_t> sets_elements_;
+
+    /** Sets covering each element. */
+    std::vector<std::vector<SetId>> elements_sets_;
+
+    /** Sets covering each element. */
+    std::vector<uint64_t> elements_sets_masks_;
+
+    /** Cost of the cheapest set covering each element. */
+    std::vector<Cost> elements_minimum_costs_;
+
+    /** Elements sorted by number of sets covering them. */
+    std::vector<ElementId> sorted_elements_;
+
+    /** Lowest cost at which each set of uncovered elements has been reached. */
+    std::unordered_map<uint64_t, Cost> costs_to_reach_;
+
+    /** Number of nodes explored. */
+    Counter number_of_nodes_ = 0;
+
+    /** Cost of the best solution found. */
+    Cost best_cost_ = -1;
+
+    /** Best solution found. */
+    uint64_t best_solution_ = 0;
+
+};
+
 }
 
-void Reduction::reduce_small_components(Tmp& tmp)
+void Reduction::reduce_small_components(
+        Tmp& tmp,
+        const ReductionParameters& parameters)
 {
-    if (instance().number_of_components() == 1)
-        return;
     //std::cout << "reduce_small_components..." << std::endl;
 
-    optimizationtools::IndexedSet& covered_elements = tmp.indexed_set_;
-    covered_elements.resize_and_clear(instance().number_of_elements());
     optimizationtools::IndexedSet& sets_to_remove = tmp.indexed_set_2_;
     sets_to_remove.resize_and_clear(instance().number_of_sets());
     optimizationtools::IndexedSet& fixed_sets = tmp.indexed_set_5_;
@@ -2725,139 +3728,212 @@ void Reduction::reduce_small_components(Tmp& tmp)
     optimizationtools::IndexedSet& elements_to_remove = tmp.indexed_set_4_;
     elements_to_remove.resize_and_clear(instance().number_of_elements());
 
+    // The components are solved in parallel. Each component writes its own
+    // entries, and the results are merged in the order of the components, so
+    // that they don't depend on the number of threads.
     std::vector<SetId> sets_original2component(instance().number_of_sets(), -1);
     std::vector<ElementId> elements_original2component(instance().number_of_elements(), -1);
-    for (ComponentId component_id = 0;
-            component_id < instance().number_of_components();
-            ++component_id) {
-        const Component& component = instance().component(component_id);
-        bool solved = false;
-
-        // Build component instance.
-        InstanceBuilder component_instance_builder;
-        component_instance_builder.add_sets(component.sets.size());
-        component_instance_builder.add_elements(component.elements.size());
-        ElementId new_element_id = 0;
-        for (ElementId element_id: component.elements) {
-            elements_original2component[element_id] = new_element_id;
-            new_element_id++;
-        }
-        SetId new_set_id = 0;
-        for (SetId set_id: component.sets) {
-            sets_original2component[set_id] = new_set_id;
-            component_instance_builder.set_cost(new_set_id, instance().set(set_id).cost);
-            for (ElementId element_id: instance().set(set_id).elements) {
-                ElementId new_element_id = elements_original2component[element_id];
-                component_instance_builder.add_arc(
-                        new_set_id,
-                        new_element_id);
-            }
-            new_set_id++;
-        }
-        Instance component_instance = component_instance_builder.build();
-
-        // Compute bound.
-        Cost bound = 0;
-        Parameters component_trivial_bound_parameters;
-        component_trivial_bound_parameters.verbosity_level = 0;
-        component_trivial_bound_parameters.reduction_parameters.reduce = false;
-        auto component_trivial_bound_output = trivial_bound(component_instance, component_trivial_bound_parameters);
-        bound = (std::max)(bound, component_trivial_bound_output.bound);
-
-        //ElementPos number_of_2_elements = 0;
-        //for (ElementId element_id = 0;
-        //        element_id < component_instance.number_of_elements();
-        //        ++element_id) {
-        //    const Element& element = component_instance.element(element_id);
-        //    if (element.sets.size() == 2)
-        //        number_of_2_elements++;
-        //}
-        //ElementPos number_of_edges_complementary
-        //    = component_instance.number_of_sets() * (component_instance.number_of_sets() - 1) / 2
-        //    - number_of_2_elements;
-        //if (number_of_edges_complementary <= 1e7) {
-        //    Parameters clique_cover_bound_parameters;
-        //    clique_cover_bound_parameters.verbosity_level = 0;
-        //    clique_cover_bound_parameters.reduction_parameters.reduce = false;
-        //    auto clique_cover_output = clique_cover_bound(
-        //            component_instance,
-        //            clique_cover_bound_parameters);
-        //    bound = (std::max)(bound, clique_cover_output.bound);
-        //}
-
-        if (bound == 2) {
-
-            // Sort sets by number of covered elements.
-            std::vector<SetId> sorted_set_ids = component.sets;
-            std::sort(sorted_set_ids.begin(), sorted_set_ids.end(),
-                    [this](SetId set_id_1, SetId set_id_2) -> bool
-                    {
-                        return instance().set(set_id_1).elements.size() > instance().set(set_id_2).elements.size();
-                    });
+    std::vector<int8_t> components_solved(instance().number_of_components(), 0);
+    std::vector<std::vector<SetId>> components_fixed_sets(instance().number_of_components());
+    std::atomic<ComponentId> next_component_id(0);
+    Counter number_of_threads = (std::max)((Counter)1, (std::min)(
+                parameters.number_of_threads,
+                (Counter)instance().number_of_components()));
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([this, &parameters, &sets_original2component, &elements_original2component, &components_solved, &components_fixed_sets, &next_component_id]()
+        {
+            optimizationtools::IndexedSet covered_elements(instance().number_of_elements());
+            for (;;) {
+                ComponentId component_id = next_component_id++;
+                if (component_id >= instance().number_of_components())
+                    break;
+                const Component& component = instance().component(component_id);
+                std::vector<SetId>& fixed_sets = components_fixed_sets[component_id];
+                bool solved = false;
+
+                ElementId new_element_id = 0;
+                for (ElementId element_id: component.elements) {
+                    elements_original2component[element_id] = new_element_id;
+                    new_element_id++;
+                }
+                SetId new_set_id = 0;
+                for (SetId set_id: component.sets) {
+                    sets_original2component[set_id] = new_set_id;
+                    new_set_id++;
+                }
 
-            // Search for a solution containing 2 sets.
-            for (SetPos pos_1 = 0;
-                    pos_1 < (SetPos)sorted_set_ids.size();
-                    ++pos_1) {
-                SetId set_id_1 = sorted_set_ids[pos_1];
-                const Set& set_1 = instance().set(set_id_1);
+                // Solve small components exactly.
+                if ((SetId)component.sets.size() <= (std::min)(
+                            (SetId)64,
+                            parameters.small_components_maximum_number_of_sets)
+                        && component.elements.size() <= 64) {
+                    std::vector<std::vector<ElementId>> sets_elements(component.sets.size());
+                    std::vector<Cost> costs(component.sets.size());
+                    for (SetId set_id: component.sets) {
+                        SetId new_set_id = sets_original2component[set_id];
+                        costs[new_set_id] = instance().set(set_id).cost;
+                        for (ElementId element_id: instance().set(set_id).elements)
+                            sets_elements[new_set_id].push_back(elements_original2component[element_id]);
+                    }
+                    SmallComponentSolver solver(
+                            sets_elements,
+                            costs,
+                            component.elements.size());
+                    uint64_t solution = 0;
+                    if (solver.solve(parameters.timer, solution)) {
+                        for (SetId set_id: component.sets) {
+                            SetId new_set_id = sets_original2component[set_id];
+                            if (solution & ((uint64_t)1 << new_set_id))
+                                fixed_sets.push_back(set_id);
+                        }
+                        components_solved[component_id] = 1;
+                        continue;
+                    }
+                }
 
-                if (set_1.elements.size() * 2 < component.elements.size())
-                    break;
+                // The trivial bound of a single component is the one of the
+                // whole instance, it is not worth solving it here.
+                if (instance().number_of_components() == 1)
+                    continue;
 
-                covered_elements.clear();
-                for (ElementId element_id: set_1.elements)
-                    covered_elements.add(element_id);
+                // Build component instance.
+                InstanceBuilder component_instance_builder;
+                component_instance_builder.add_sets(component.sets.size());
+                component_instance_builder.add_elements(component.elements.size());
+                std::vector<ElementPos> numbers_of_elements;
+                numbers_of_elements.reserve(component.sets.size());
+                for (SetId set_id: component.sets)
+                    numbers_of_elements.push_back(instance().set(set_id).elements.size());
+                component_instance_builder.set_numbers_of_elements(numbers_of_elements);
+                for (SetId set_id: component.sets) {
+                    SetId new_set_id = sets_original2component[set_id];
+                    component_instance_builder.set_cost(new_set_id, instance().set(set_id).cost);
+                    ElementId* new_element_ids = component_instance_builder.set_elements(new_set_id);
+                    for (ElementId element_id: instance().set(set_id).elements) {
+                        *new_element_ids = elements_original2component[element_id];
+                        new_element_ids++;
+                    }
+                }
+                Instance component_instance = component_instance_builder.build();
+
+                // Compute bound.
+                Cost bound = 0;
+                Parameters component_trivial_bound_parameters;
+                component_trivial_bound_parameters.verbosity_level = 0;
+                component_trivial_bound_parameters.reduction_parameters.reduce = false;
+                auto component_trivial_bound_output = trivial_bound(component_instance, component_trivial_bound_parameters);
+                bound = (std::max)(bound, component_trivial_bound_output.bound);
+
+                //ElementPos number_of_2_elements = 0;
+                //for (ElementId element_id = 0;
+                //        element_id < component_instance.number_of_elements();
+                //        ++element_id) {
+                //    const Element& element = component_instance.element(element_id);
+                //    if (element.sets.size() == 2)
+                //        number_of_2_elements++;
+                //}
+                //ElementPos number_of_edges_complementary
+                //    = component_instance.number_of_sets() * (component_instance.number_of_sets() - 1) / 2
+                //    - number_of_2_elements;
+                //if (number_of_edges_complementary <= 1e7) {
+                //    Parameters clique_cover_bound_parameters;
+                //    clique_cover_bound_parameters.verbosity_level = 0;
+                //    clique_cover_bound_parameters.reduction_parameters.reduce = false;
+                //    auto clique_cover_output = clique_cover_bound(
+                //            component_instance,
+                //            clique_cover_bound_parameters);
+                //    bound = (std::max)(bound, clique_cover_output.bound);
+                //}
+
+                if (bound == 2) {
+
+                    // Sort sets by number of covered elements.
+                    std::vector<SetId> sorted_set_ids(component.sets.begin(), component.sets.end());
+                    std::sort(sorted_set_ids.begin(), sorted_set_ids.end(),
+                            [this](SetId set_id_1, SetId set_id_2) -> bool
+                            {
+                                return instance().set(set_id_1).elements.size() > instance().set(set_id_2).elements.size();
+                            });
+
+                    // Search for a solution containing 2 sets.
+                    for (SetPos pos_1 = 0;
+                            pos_1 < (SetPos)sorted_set_ids.size();
+                            ++pos_1) {
+                        SetId set_id_1 = sorted_set_ids[pos_1];
+                        const Set& set_1 = instance().set(set_id_1);
+
+                        if (set_1.elements.size() * 2 < component.elements.size())
+                            break;
 
-                for (SetPos pos_2 = pos_1 + 1;
-                        pos_2 < (SetPos)sorted_set_ids.size();
-                        ++pos_2) {
-                    SetId set_id_2 = sorted_set_ids[pos_2];
-                    const Set& set_2 = instance().set(set_id_2);
+                        covered_elements.clear();
+                        for (ElementId element_id: set_1.elements)
+                            covered_elements.add(element_id);
+
+                        for (SetPos pos_2 = pos_1 + 1;
+                                pos_2 < (SetPos)sorted_set_ids.size();
+                                ++pos_2) {
+                            SetId set_id_2 = sorted_set_ids[pos_2];
+                            const Set& set_2 = instance().set(set_id_2);
+
+                            if (set_1.elements.size() + set_2.elements.size() < component.elements.size())
+                                break;
+
+                            ElementPos number_of_covered_elements = covered_elements.size();
+                            for (ElementId element_id: set_2.elements)
+                                if (!covered_elements.contains(element_id))
+                                    number_of_covered_elements++;
+
+                            if (number_of_covered_elements == component.elements.size()) {
+                                fixed_sets.push_back(set_id_1);
+                                fixed_sets.push_back(set_id_2);
+                                solved = true;
+                                //std::cout << "solve component " << component_id << std::endl;
+                                break;
+                            }
+                        }
 
-                    if (set_1.elements.size() + set_2.elements.size() < component.elements.size())
-                        break;
+                        if (solved)
+                            break;
+                    }
+                } else {
 
-                    ElementPos number_of_covered_elements = covered_elements.size();
-                    for (ElementId element_id: set_2.elements)
-                        if (!covered_elements.contains(element_id))
-                            number_of_covered_elements++;
-
-                    if (number_of_covered_elements == component.elements.size()) {
-                        fixed_sets.add(set_id_1);
-                        fixed_sets.add(set_id_2);
-                        for (SetId set_id: component.sets)
-                            sets_to_remove.add(set_id);
-                        for (ElementId element_id: component.elements)
-                            elements_to_remove.add(element_id);
+                    Parameters component_greedy_parameters;
+                    component_greedy_parameters.verbosity_level = 0;
+                    component_greedy_parameters.reduction_parameters.reduce = false;
+                    auto component_greedy_output = greedy(component_instance, component_greedy_parameters);
+                    if (component_greedy_output.solution.cost() == bound) {
+                        for (SetId set_id: component.sets) {
+                            SetId new_set_id = sets_original2component[set_id];
+                            if (component_greedy_output.solution.contains(new_set_id))
+                                fixed_sets.push_back(set_id);
+                        }
                         solved = true;
-                        //std::cout << "solve component " << component_id << std::endl;
-                        break;
+                        //std::cout << "solve component " << component_id << " cost " << bound << std::endl;
                     }
+
                 }
 
                 if (solved)
-                    break;
-            }
-        } else {
-
-            Parameters component_greedy_parameters;
-            component_greedy_parameters.verbosity_level = 0;
-            component_greedy_parameters.reduction_parameters.reduce = false;
-            auto component_greedy_output = greedy(component_instance, component_greedy_parameters);
-            if (component_greedy_output.solution.cost() == bound) {
-                for (SetId set_id: component.sets) {
-                    SetId new_set_id = sets_original2component[set_id];
-                    if (component_greedy_output.solution.contains(new_set_id))
-                        fixed_sets.add(set_id);
-                    sets_to_remove.add(set_id);
-                }
-                for (ElementId element_id: component.elements)
-                    elements_to_remove.add(element_id);
-                //std::cout << "solve component " << component_id << " cost " << bound << std::endl;
+                    components_solved[component_id] = 1;
             }
+        }));
+    }
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id)
+        threads[thread_id].join();
 
-        }
+    for (ComponentId component_id = 0;
+            component_id < instance().number_of_components();
+            ++component_id) {
+        if (!components_solved[component_id])
+            continue;
+        const Component& component = instance().component(component_id);
+        for (SetId set_id: components_fixed_sets[component_id])
+            fixed_sets.add(set_id);
+        for (SetId set_id: component.sets)
+            sets_to_remove.add(set_id);
+        for (ElementId element_id: component.elements)
+            elements_to_remove.add(element_id);
     }
 
     if (sets_to_remove.size() == 0)
@@ -2879,16 +3955,14 @@ void Reduction::reduce_small_components(Tmp& tmp)
     SetId new_number_of_sets = instance().number_of_sets() - sets_to_remove.size();
     ElementId new_number_of_elements = instance().number_of_elements() - elements_to_remove.size();
     InstanceBuilder new_instance_builder;
+    new_instance_builder.set_number_of_threads(parameters.number_of_threads);
     new_instance_builder.add_elements(new_number_of_elements);
     new_instance_builder.add_sets(new_number_of_sets);
     //new_instance_builder.move(
     //        std::move(tmp.instance_),
     //        new_number_of_sets,
     //        new_number_of_elements);
-    for (SetId set_id = 0; set_id < new_number_of_sets; ++set_id) {
-        tmp.unreduction_operations[set_id].in.clear();
-        tmp.unreduction_operations[set_id].out.clear();
-    }
+    std::vector<UnreductionOperations> new_unreduction_operations(new_number_of_sets);
     // Add sets.
     std::vector<SetId> sets_original2reduced(instance().number_of_sets(), -1);
     std::vector<ElementId> elements_original2reduced(instance().number_of_elements(), -1);
@@ -2905,61 +3979,123 @@ void Reduction::reduce_small_components(Tmp& tmp)
         SetId set_id = *it;
         sets_original2reduced[set_id] = new_set_id;
         new_instance_builder.set_cost(new_set_id, instance().set(set_id).cost);
-        tmp.unreduction_operations[new_set_id]
-            = unreduction_operations_[set_id];
+        new_unreduction_operations[new_set_id]
+            = std::move(unreduction_operations_[set_id]);
         new_set_id++;
     }
     // Add arcs.
+    std::vector<ElementPos> numbers_of_elements(new_number_of_sets, 0);
     for (auto it = sets_to_remove.out_begin(); it != sets_to_remove.out_end(); ++it) {
         SetId set_id = *it;
         SetId new_set_id = sets_original2reduced[set_id];
-        if (new_set_id == -1)
-            continue;
+        for (ElementId element_id: instance().set(set_id).elements)
+            if (elements_original2reduced[element_id] != -1)
+                numbers_of_elements[new_set_id]++;
+    }
+    new_instance_builder.set_numbers_of_elements(numbers_of_elements);
+    for (auto it = sets_to_remove.out_begin(); it != sets_to_remove.out_end(); ++it) {
+        SetId set_id = *it;
+        SetId new_set_id = sets_original2reduced[set_id];
+        ElementId* new_element_ids = new_instance_builder.set_elements(new_set_id);
         for (ElementId element_id: instance().set(set_id).elements) {
             ElementId new_element_id = elements_original2reduced[element_id];
             if (new_element_id == -1)
                 continue;
-            new_instance_builder.add_arc(
-                    new_set_id,
-                    new_element_id);
+            *new_element_ids = new_element_id;
+            new_element_ids++;
         }
     }
 
-    unreduction_operations_.swap(tmp.unreduction_operations);
+    unreduction_operations_.swap(new_unreduction_operations);
     //tmp.instance_ = std::move(instance_);
     instance_ = new_instance_builder.build();
 }
 
-Reduction::Reduction(
-        const Instance& instance,
-        const ReductionParameters& parameters):
-    original_instance_(&instance),
-    instance_(instance)
+template <typename RuleFunction>
+bool Reduction::apply_rule(
+        Tmp& tmp,
+        const ReductionParameters& parameters,
+        Counter round_number,
+        const std::string& rule,
+        RuleFunction rule_function,
+        bool can_be_skipped)
 {
-    Tmp tmp(instance);
+    // The entries of the current round are at the end of the list.
+    auto find_rule_statistics = [&tmp, round_number, &rule]()
+    {
+        auto it = tmp.rule_statistics.rbegin();
+        while (it != tmp.rule_statistics.rend()
+                && it->round == round_number
+                && it->rule != rule) {
+            ++it;
+        }
+        if (it == tmp.rule_statistics.rend() || it->round != round_number) {
+            RuleStatistics rule_statistics;
+            rule_statistics.rule = rule;
+            rule_statistics.round = round_number;
+            tmp.rule_statistics.push_back(rule_statistics);
+            it = tmp.rule_statistics.rbegin();
+        }
+        return it;
+    };
 
-    std::uniform_int_distribution<uint64_t> distribution(
-        std::numeric_limits<uint64_t>::min(),
-        std::numeric_limits<uint64_t>::max()
-    );
-    for (SetId pos = 0; pos < (SetId)tmp.random_.size(); ++pos)
-        tmp.random_[pos] = distribution(tmp.generator_);
-    tmp.instance = instance_to_reduction(instance);
+    bool scheduled = parameters.adaptive_rule_scheduling && can_be_skipped;
+    if (scheduled && round_number < tmp.rule_schedules[rule].next_round) {
+        find_rule_statistics()->number_of_skipped_calls++;
+        return false;
+    }
 
-    // Initialize reduced instance.
-    unreduction_operations_ = std::vector<UnreductionOperations>(instance.number_of_sets());
-    for (SetId set_id = 0;
-            set_id < instance.number_of_sets();
-            ++set_id) {
-        unreduction_operations_[set_id].in.push_back(set_id);
+    SetId number_of_sets = tmp.instance.number_of_remaining_sets;
+    ElementId number_of_elements = tmp.instance.number_of_remaining_elements;
+    Counter number_of_arcs = tmp.instance.number_of_remaining_arcs;
+    SetId number_of_mandatory_sets = tmp.mandatory_sets.size();
+    Counter number_of_updates = tmp.number_of_updates;
+    double start = parameters.timer.elapsed_time();
+
+    bool found = rule_function();
+
+    double time = parameters.timer.elapsed_time() - start;
+    Counter number_of_removed_sets = number_of_sets - tmp.instance.number_of_remaining_sets;
+    Counter number_of_removed_elements = number_of_elements - tmp.instance.number_of_remaining_elements;
+    auto it = find_rule_statistics();
+    it->number_of_calls++;
+    it->time += time;
+    it->number_of_removed_sets += number_of_removed_sets;
+    it->number_of_removed_elements += number_of_removed_elements;
+    it->number_of_removed_arcs += number_of_arcs - tmp.instance.number_of_remaining_arcs;
+    it->number_of_mandatory_sets += (SetId)tmp.mandatory_sets.size() - number_of_mandatory_sets;
+    it->number_of_updates += tmp.number_of_updates - number_of_updates;
+
+    if (scheduled) {
+        double number_of_removals = number_of_removed_sets + number_of_removed_elements;
+        RuleSchedule& rule_schedule = tmp.rule_schedules[rule];
+        if (time >= parameters.minimum_rule_time
+                && number_of_removals < parameters.minimum_rule_yield * time) {
+            rule_schedule.number_of_skipped_rounds = (std::max)(
+                    (Counter)1,
+                    2 * rule_schedule.number_of_skipped_rounds);
+            rule_schedule.next_round = round_number + 1 + rule_schedule.number_of_skipped_rounds;
+        } else if (number_of_removals > 0) {
+            rule_schedule.number_of_skipped_rounds = 0;
+        }
     }
+    return found;
+}
 
-    for (Counter round_number = 0;
-            round_number < parameters.maximum_number_of_rounds;
-            ++round_number) {
+bool Reduction::apply_rules(
+        Tmp& tmp,
+        const ReductionParameters& parameters,
+        bool split)
+{
+    Counter number_of_arcs = -1;
+    for (;;) {
         // Check timer.
         if (parameters.timer.needs_to_end())
             break;
+        if (tmp.number_of_rounds >= parameters.maximum_number_of_rounds)
+            break;
+        Counter round_number = tmp.number_of_rounds;
+        tmp.number_of_rounds++;
         //std::cout << "round_number " << round_number
         //    << " number_of_elements " << this->instance().number_of_elements()
         //    << " number_of_sets " << this->instance().number_of_sets()
@@ -2967,33 +4103,42 @@ Reduction::Reduction(
         //    << std::endl;
         bool found = false;
 
-        found |= reduce_mandatory_sets(tmp);
+        auto mandatory_sets = [this, &tmp]() { return reduce_mandatory_sets(tmp); };
+        found |= apply_rule(tmp, parameters, round_number, "MandatorySets", mandatory_sets, false);
 
         if (parameters.vertex_cover_domination) {
             for (int i = 0; i < 16; ++i) {
-                bool found_cur = reduce_vertex_cover_domination(tmp, parameters);
+                bool found_cur = apply_rule(
+                        tmp, parameters, round_number, "VertexCoverDomination",
+                        [this, &tmp, &parameters]() { return reduce_vertex_cover_domination(tmp, parameters); });
                 if (parameters.timer.needs_to_end())
                     break;
                 if (!found_cur)
                     break;
                 found |= found_cur;
-                found |= reduce_mandatory_sets(tmp);
+                found |= apply_rule(tmp, parameters, round_number, "MandatorySets", mandatory_sets, false);
             }
         }
         if (parameters.timer.needs_to_end())
             break;
 
-        found |= reduce_dominated_sets_2(tmp, parameters);
+        found |= apply_rule(
+                tmp, parameters, round_number, "DominatedSets2",
+                [this, &tmp, &parameters]() { return reduce_dominated_sets_2(tmp, parameters); });
         if (parameters.timer.needs_to_end())
             break;
 
-        found |= reduce_dominated_elements_2(tmp, parameters);
+        found |= apply_rule(
+                tmp, parameters, round_number, "DominatedElements2",
+                [this, &tmp, &parameters]() { return reduce_dominated_elements_2(tmp, parameters); });
         if (parameters.timer.needs_to_end())
             break;
 
         if (parameters.set_folding) {
             for (int i = 0; i < 16; ++i) {
-                bool found_cur = reduce_set_folding(tmp);
+                bool found_cur = apply_rule(
+                        tmp, parameters, round_number, "SetFolding",
+                        [this, &tmp]() { return reduce_set_folding(tmp); });
                 if (!found_cur)
                     break;
                 found |= found_cur;
@@ -3003,44 +4148,456 @@ Reduction::Reduction(
         // Twin reduction fails if some elements are covered by only one vertex.
         // So, run the mandatory set reduction right before.
         if (parameters.twin) {
-            found |= reduce_mandatory_sets(tmp);
-            found |= reduce_twin(tmp);
+            found |= apply_rule(tmp, parameters, round_number, "MandatorySets", mandatory_sets, false);
+            found |= apply_rule(
+                    tmp, parameters, round_number, "Twin",
+                    [this, &tmp, &parameters]() { return reduce_twin(tmp, parameters); });
         }
 
-        found |= reduce_identical_sets(tmp);
-        found |= reduce_identical_elements(tmp);
+        found |= apply_rule(
+                tmp, parameters, round_number, "IdenticalSets",
+                [this, &tmp, &parameters]() { return reduce_identical_sets(tmp, parameters); });
+        found |= apply_rule(
+                tmp, parameters, round_number, "IdenticalElements",
+                [this, &tmp, &parameters]() { return reduce_identical_elements(tmp, parameters); });
 
         if (!found || round_number >= 4) {
-            if (parameters.unconfined_sets)
-                found |= reduce_unconfined_sets(tmp);
+            if (parameters.unconfined_sets) {
+                found |= apply_rule(
+                        tmp, parameters, round_number, "UnconfinedSets",
+                        [this, &tmp]() { return reduce_unconfined_sets(tmp); });
+            }
             if (parameters.dominated_sets_removal) {
-                found |= reduce_dominated_sets(tmp, parameters);
+                found |= apply_rule(
+                        tmp, parameters, round_number, "DominatedSets",
+                        [this, &tmp, &parameters]() { return reduce_dominated_sets(tmp, parameters); });
                 if (parameters.timer.needs_to_end())
                     break;
             }
             if (parameters.dominated_elements_removal) {
-                found |= reduce_dominated_elements(tmp, parameters);
+                found |= apply_rule(
+                        tmp, parameters, round_number, "DominatedElements",
+                        [this, &tmp, &parameters]() { return reduce_dominated_elements(tmp, parameters); });
                 if (parameters.timer.needs_to_end())
                     break;
             }
 
-            found |= reduce_mandatory_sets(tmp);
-            found |= reduce_linear_programming(tmp, parameters);
+            found |= apply_rule(tmp, parameters, round_number, "MandatorySets", mandatory_sets, false);
+            if (parameters.linear_programming) {
+                found |= apply_rule(
+                        tmp, parameters, round_number, "LinearProgramming",
+                        [this, &tmp, &parameters]() { return reduce_linear_programming(tmp, parameters); });
+            }
+            if (parameters.crown) {
+                found |= apply_rule(
+                        tmp, parameters, round_number, "Crown",
+                        [this, &tmp, &parameters]() { return reduce_crown(tmp, parameters); });
+            }
+        }
+
+        if (!found)
+            break;
+
+        // Check whether the instance has split. The check is repeated each
+        // time the number of arcs has been halved, so that its total cost
+        // remains small compared to the rules.
+        if (split
+                && (number_of_arcs == -1
+                    || tmp.instance.number_of_remaining_arcs < number_of_arcs / 2)) {
+            number_of_arcs = tmp.instance.number_of_remaining_arcs;
+            std::vector<ComponentId> sets_components;
+            std::vector<ComponentId> elements_components;
+            if (compute_components(
+                        tmp.instance,
+                        sets_components,
+                        elements_components) > 1) {
+                return true;
+            }
+        }
+    }
+    return false;
+
+}
+
+ComponentId Reduction::compute_components(
+        const ReductionInstance& reduction_instance,
+        std::vector<ComponentId>& sets_components,
+        std::vector<ComponentId>& elements_components) const
+{
+    sets_components.assign(reduction_instance.number_of_sets(), -1);
+    elements_components.assign(reduction_instance.number_of_elements(), -1);
+    ComponentId number_of_components = 0;
+    std::vector<SetId> stack;
+    for (SetId set_id = 0;
+            set_id < reduction_instance.number_of_sets();
+            ++set_id) {
+        if (reduction_instance.removed_sets[set_id]
+                || sets_components[set_id] != -1) {
+            continue;
+        }
+        sets_components[set_id] = number_of_components;
+        stack.push_back(set_id);
+        while (!stack.empty()) {
+            SetId set_id_cur = stack.back();
+            stack.pop_back();
+            for (ElementId element_id: reduction_instance.set(set_id_cur).elements) {
+                if (elements_components[element_id] != -1)
+                    continue;
+                elements_components[element_id] = number_of_components;
+                for (SetId set_id_next: reduction_instance.element(element_id).sets) {
+                    if (sets_components[set_id_next] != -1)
+                        continue;
+                    sets_components[set_id_next] = number_of_components;
+                    stack.push_back(set_id_next);
+                }
+            }
         }
+        number_of_components++;
+    }
 
-        if (found)
+    // Elements covered by no set.
+    for (ElementId element_id = 0;
+            element_id < reduction_instance.number_of_elements();
+            ++element_id) {
+        if (reduction_instance.removed_elements[element_id]
+                || elements_components[element_id] != -1) {
             continue;
-        break;
+        }
+        elements_components[element_id] = number_of_components;
+        number_of_components++;
+    }
+
+    return number_of_components;
+}
+
+void Reduction::reduce_components(
+        Tmp& tmp,
+        const ReductionParameters& parameters)
+{
+    update(tmp);
+    const ReductionInstance& reduction_instance = tmp.instance;
+
+    std::vector<ComponentId> sets_components;
+    std::vector<ComponentId> elements_components;
+    ComponentId number_of_components = compute_components(
+            reduction_instance,
+            sets_components,
+            elements_components);
+
+    // Sort the sets and the elements by component. Inside a component, they
+    // keep their relative order. Their position in the component is their id
+    // in the instance of the component.
+    std::vector<SetPos> components_sets_offsets(number_of_components + 1, 0);
+    for (SetId set_id = 0;
+            set_id < reduction_instance.number_of_sets();
+            ++set_id) {
+        components_sets_offsets[sets_components[set_id] + 1]++;
+    }
+    std::vector<ElementPos> components_elements_offsets(number_of_components + 1, 0);
+    for (ElementId element_id = 0;
+            element_id < reduction_instance.number_of_elements();
+            ++element_id) {
+        components_elements_offsets[elements_components[element_id] + 1]++;
+    }
+    for (ComponentId component_id = 0;
+            component_id < number_of_components;
+            ++component_id) {
+        components_sets_offsets[component_id + 1] += components_sets_offsets[component_id];
+        components_elements_offsets[component_id + 1] += components_elements_offsets[component_id];
+    }
+    std::vector<SetId> components_sets(reduction_instance.number_of_sets());
+    std::vector<SetId> sets_local_ids(reduction_instance.number_of_sets());
+    std::vector<SetPos> sets_positions(
+            components_sets_offsets.begin(),
+            components_sets_offsets.end() - 1);
+    for (SetId set_id = 0;
+            set_id < reduction_instance.number_of_sets();
+            ++set_id) {
+        ComponentId component_id = sets_components[set_id];
+        SetPos pos = sets_positions[component_id];
+        components_sets[pos] = set_id;
+        sets_local_ids[set_id] = pos - components_sets_offsets[component_id];
+        sets_positions[component_id]++;
+    }
+    std::vector<ElementId> components_elements(reduction_instance.number_of_elements());
+    std::vector<ElementId> elements_local_ids(reduction_instance.number_of_elements());
+    std::vector<ElementPos> elements_positions(
+            components_elements_offsets.begin(),
+            components_elements_offsets.end() - 1);
+    for (ElementId element_id = 0;
+            element_id < reduction_instance.number_of_elements();
+            ++element_id) {
+        ComponentId component_id = elements_components[element_id];
+        ElementPos pos = elements_positions[component_id];
+        components_elements[pos] = element_id;
+        elements_local_ids[element_id] = pos - components_elements_offsets[component_id];
+        elements_positions[component_id]++;
+    }
+
+    // The largest components are reduced first to balance the load of the
+    // threads.
+    std::vector<ComponentId> sorted_components(number_of_components);
+    for (ComponentId component_id = 0;
+            component_id < number_of_components;
+            ++component_id) {
+        sorted_components[component_id] = component_id;
+    }
+    std::stable_sort(
+            sorted_components.begin(),
+            sorted_components.end(),
+            [&components_sets_offsets](
+                ComponentId component_id_1,
+                ComponentId component_id_2)
+            {
+                return components_sets_offsets[component_id_1 + 1] - components_sets_offsets[component_id_1]
+                    > components_sets_offsets[component_id_2 + 1] - components_sets_offsets[component_id_2];
+            });
+
+    // Each component is reduced with its own temporary structure, and the
+    // components are merged back in their original order, so that the result
+    // doesn't depend on the number of threads. The threads already share the
+    // components, so the rules of a component are run on a single thread.
+    ReductionParameters component_parameters = parameters;
+    component_parameters.number_of_threads = 1;
+    std::vector<ReductionInstance> components_instances(number_of_components);
+    std::vector<std::vector<UnreductionOperations>> components_unreduction_operations(number_of_components);
+    std::vector<std::vector<SetId>> components_mandatory_sets(number_of_components);
+    std::vector<std::vector<RuleStatistics>> components_rule_statistics(number_of_components);
+    std::vector<Counter> components_numbers_of_rounds(number_of_components);
+    std::atomic<ComponentId> next_component_pos(0);
+    Counter number_of_threads = (std::max)((Counter)1, (std::min)(
+                parameters.number_of_threads,
+                (Counter)number_of_components));
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id) {
+        threads.push_back(std::thread([&]()
+        {
+            for (;;) {
+                ComponentId component_pos = next_component_pos++;
+                if (component_pos >= number_of_components)
+                    break;
+                ComponentId component_id = sorted_components[component_pos];
+                SetPos sets_offset = components_sets_offsets[component_id];
+                SetId number_of_sets = components_sets_offsets[component_id + 1] - sets_offset;
+                ElementPos elements_offset = components_elements_offsets[component_id];
+                ElementId number_of_elements = components_elements_offsets[component_id + 1] - elements_offset;
+
+                // Build the instance of the component.
+                Tmp component_tmp(number_of_sets, number_of_elements);
+                component_tmp.number_of_rounds = tmp.number_of_rounds;
+                ReductionInstance& component_instance = component_tmp.instance;
+                component_instance.set_costs.resize(number_of_sets);
+                component_instance.removed_sets.resize(number_of_sets, false);
+                component_instance.set_elements.starts.resize(number_of_sets);
+                component_instance.set_elements.sizes.resize(number_of_sets);
+                for (SetId set_id = 0; set_id < number_of_sets; ++set_id) {
+                    SetId set_id_orig = components_sets[sets_offset + set_id];
+                    const ReductionSet& set = reduction_instance.set(set_id_orig);
+                    component_instance.set_costs[set_id] = set.cost;
+                    component_instance.set_elements.starts[set_id] = component_instance.set_elements.arcs.size();
+                    component_instance.set_elements.sizes[set_id] = set.elements.size();
+                    for (ElementId element_id: set.elements)
+                        component_instance.set_elements.arcs.push_back(elements_local_ids[element_id]);
+                    component_tmp.unreduction_operations[set_id]
+                        = std::move(tmp.unreduction_operations[set_id_orig]);
+                }
+                component_instance.set_elements.capacities = component_instance.set_elements.sizes;
+                component_instance.removed_elements.resize(number_of_elements, false);
+                component_instance.element_sets.starts.resize(number_of_elements);
+                component_instance.element_sets.sizes.resize(number_of_elements);
+                for (ElementId element_id = 0; element_id < number_of_elements; ++element_id) {
+                    ElementId element_id_orig = components_elements[elements_offset + element_id];
+                    const ReductionElement& element = reduction_instance.element(element_id_orig);
+                    component_instance.element_sets.starts[element_id] = component_instance.element_sets.arcs.size();
+                    component_instance.element_sets.sizes[element_id] = element.sets.size();
+                    for (SetId set_id: element.sets)
+                        component_instance.element_sets.arcs.push_back(sets_local_ids[set_id]);
+                }
+                component_instance.element_sets.capacities = component_instance.element_sets.sizes;
+                component_instance.number_of_remaining_sets = number_of_sets;
+                component_instance.number_of_remaining_elements = number_of_elements;
+                component_instance.number_of_remaining_arcs = component_instance.set_elements.arcs.size();
+
+                // Reduce the component.
+                apply_rules(component_tmp, component_parameters, false);
+                update(component_tmp);
+
+                components_instances[component_id] = std::move(component_tmp.instance);
+                components_unreduction_operations[component_id] = std::move(component_tmp.unreduction_operations);
+                components_mandatory_sets[component_id] = std::move(component_tmp.mandatory_sets);
+                components_rule_statistics[component_id] = std::move(component_tmp.rule_statistics);
+                components_numbers_of_rounds[component_id] = component_tmp.number_of_rounds;
+            }
+        }));
+    }
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id)
+        threads[thread_id].join();
+
+    // Merge the components.
+    ReductionInstance merged_instance;
+    std::vector<UnreductionOperations> merged_unreduction_operations;
+    std::vector<SetId> sets_offsets(number_of_components + 1, 0);
+    std::vector<ElementId> elements_offsets(number_of_components + 1, 0);
+    for (ComponentId component_id = 0;
+            component_id < number_of_components;
+            ++component_id) {
+        const ReductionInstance& component_instance = components_instances[component_id];
+        sets_offsets[component_id + 1] = sets_offsets[component_id]
+            + component_instance.number_of_sets();
+        elements_offsets[component_id + 1] = elements_offsets[component_id]
+            + component_instance.number_of_elements();
+    }
+    merged_instance.set_costs.reserve(sets_offsets.back());
+    merged_instance.removed_sets.resize(sets_offsets.back(), false);
+    merged_instance.set_elements.starts.reserve(sets_offsets.back());
+    merged_instance.set_elements.sizes.reserve(sets_offsets.back());
+    merged_instance.removed_elements.resize(elements_offsets.back(), false);
+    merged_instance.element_sets.starts.reserve(elements_offsets.back());
+    merged_instance.element_sets.sizes.reserve(elements_offsets.back());
+    merged_unreduction_operations.reserve(sets_offsets.back());
+    for (ComponentId component_id = 0;
+            component_id < number_of_components;
+            ++component_id) {
+        const ReductionInstance& component_instance = components_instances[component_id];
+        for (SetId set_id = 0;
+                set_id < component_instance.number_of_sets();
+                ++set_id) {
+            const ReductionSet& set = component_instance.set(set_id);
+            merged_instance.set_costs.push_back(set.cost);
+            merged_instance.set_elements.starts.push_back(merged_instance.set_elements.arcs.size());
+            merged_instance.set_elements.sizes.push_back(set.elements.size());
+            for (ElementId element_id: set.elements)
+                merged_instance.set_elements.arcs.push_back(elements_offsets[component_id] + element_id);
+            merged_unreduction_operations.push_back(
+                    std::move(components_unreduction_operations[component_id][set_id]));
+        }
+        for (ElementId element_id = 0;
+                element_id < component_instance.number_of_elements();
+                ++element_id) {
+            const ReductionElement& element = component_instance.element(element_id);
+            merged_instance.element_sets.starts.push_back(merged_instance.element_sets.arcs.size());
+            merged_instance.element_sets.sizes.push_back(element.sets.size());
+            for (SetId set_id: element.sets)
+                merged_instance.element_sets.arcs.push_back(sets_offsets[component_id] + set_id);
+        }
+        tmp.mandatory_sets.insert(
+                tmp.mandatory_sets.end(),
+                components_mandatory_sets[component_id].begin(),
+                components_mandatory_sets[component_id].end());
+    }
+    merged_instance.set_elements.capacities = merged_instance.set_elements.sizes;
+    merged_instance.element_sets.capacities = merged_instance.element_sets.sizes;
+    merged_instance.number_of_remaining_sets = merged_instance.number_of_sets();
+    merged_instance.number_of_remaining_elements = merged_instance.number_of_elements();
+    merged_instance.number_of_remaining_arcs = merged_instance.set_elements.arcs.size();
+    tmp.instance = std::move(merged_instance);
+    tmp.unreduction_operations.swap(merged_unreduction_operations);
+
+    // The logs refer to the sets and elements before the split.
+    tmp.modified_sets_log.clear();
+    tmp.modified_elements_log.clear();
+    for (WorklistPosition& position: tmp.worklist_positions)
+        position = WorklistPosition();
+
+    // Merge the statistics of the rules, round by round.
+    std::map<std::pair<Counter, std::string>, Counter> rule_statistics_positions;
+    for (Counter pos = 0; pos < (Counter)tmp.rule_statistics.size(); ++pos) {
+        const RuleStatistics& rule_statistics = tmp.rule_statistics[pos];
+        rule_statistics_positions[{rule_statistics.round, rule_statistics.rule}] = pos;
+    }
+    for (ComponentId component_id = 0;
+            component_id < number_of_components;
+            ++component_id) {
+        for (const RuleStatistics& rule_statistics: components_rule_statistics[component_id]) {
+            auto it = rule_statistics_positions.find({rule_statistics.round, rule_statistics.rule});
+            if (it == rule_statistics_positions.end()) {
+                rule_statistics_positions[{rule_statistics.round, rule_statistics.rule}] = tmp.rule_statistics.size();
+                tmp.rule_statistics.push_back(rule_statistics);
+                continue;
+            }
+            RuleStatistics& merged_rule_statistics = tmp.rule_statistics[it->second];
+            merged_rule_statistics.number_of_calls += rule_statistics.number_of_calls;
+            merged_rule_statistics.time += rule_statistics.time;
+            merged_rule_statistics.number_of_removed_sets += rule_statistics.number_of_removed_sets;
+            merged_rule_statistics.number_of_removed_elements += rule_statistics.number_of_removed_elements;
+            merged_rule_statistics.number_of_removed_arcs += rule_statistics.number_of_removed_arcs;
+            merged_rule_statistics.number_of_mandatory_sets += rule_statistics.number_of_mandatory_sets;
+            merged_rule_statistics.number_of_updates += rule_statistics.number_of_updates;
+            merged_rule_statistics.number_of_skipped_calls += rule_statistics.number_of_skipped_calls;
+        }
+        tmp.number_of_rounds = (std::max)(
+                tmp.number_of_rounds,
+                components_numbers_of_rounds[component_id]);
+    }
+    std::stable_sort(
+            tmp.rule_statistics.begin(),
+            tmp.rule_statistics.end(),
+            [](const RuleStatistics& rule_statistics_1,
+                const RuleStatistics& rule_statistics_2)
+            {
+                return rule_statistics_1.round < rule_statistics_2.round;
+            });
+}
+
+Reduction::Reduction(
+        const Instance& instance,
+        const ReductionParameters& parameters):
+    original_instance_(&instance)
+{
+    if (!parameters.load_path.empty()) {
+        read(parameters.load_path);
+        return;
+    }
+    double start = parameters.timer.elapsed_time();
+
+    Tmp tmp(instance.number_of_sets(), instance.number_of_elements());
+    tmp.instance = instance_to_reduction(instance);
+
+    // Initialize reduced instance.
+    for (SetId set_id = 0;
+            set_id < instance.number_of_sets();
+            ++set_id) {
+        tmp.unreduction_operations[set_id].in.push_back(set_id);
     }
 
-    update(tmp.instance, unreduction_operations_);
-    instance_ = reduction_to_instance(tmp.instance);
-    if (!parameters.timer.needs_to_end())
-        reduce_small_components(tmp);
+    // Once the instance has split, its components are reduced independently.
+    if (apply_rules(tmp, parameters, true))
+        reduce_components(tmp, parameters);
+
+    update(tmp);
+    instance_ = reduction_to_instance(tmp.instance, parameters);
+    unreduction_operations_ = std::move(tmp.unreduction_operations);
+    mandatory_sets_ = std::move(tmp.mandatory_sets);
+    rule_statistics_ = std::move(tmp.rule_statistics);
+    number_of_rounds_ = tmp.number_of_rounds;
+    if (!parameters.timer.needs_to_end()) {
+        // The small components are solved on the reduced instance, so their
+        // statistics are computed from it.
+        SetId number_of_sets = instance_.number_of_sets();
+        ElementId number_of_elements = instance_.number_of_elements();
+        Counter number_of_arcs = instance_.number_of_arcs();
+        SetId number_of_mandatory_sets = mandatory_sets_.size();
+        double small_components_start = parameters.timer.elapsed_time();
+        reduce_small_components(tmp, parameters);
+        RuleStatistics rule_statistics;
+        rule_statistics.rule = "SmallComponents";
+        rule_statistics.round = number_of_rounds_;
+        rule_statistics.number_of_calls = 1;
+        rule_statistics.time = parameters.timer.elapsed_time() - small_components_start;
+        rule_statistics.number_of_removed_sets = number_of_sets - instance_.number_of_sets();
+        rule_statistics.number_of_removed_elements = number_of_elements - instance_.number_of_elements();
+        rule_statistics.number_of_removed_arcs = number_of_arcs - instance_.number_of_arcs();
+        rule_statistics.number_of_mandatory_sets = (SetId)mandatory_sets_.size() - number_of_mandatory_sets;
+        rule_statistics_.push_back(rule_statistics);
+    }
 
     extra_cost_ = 0;
     for (SetId orig_set_id: mandatory_sets_)
         extra_cost_ += instance.set(orig_set_id).cost;
+    time_ = parameters.timer.elapsed_time() - start;
+
+    if (!parameters.save_path.empty())
+        write(parameters.save_path);
 }
 
 void Reduction::unreduce_solution(
@@ -3072,6 +4629,32 @@ void Reduction::unreduce_solution(
     }
 }
 
+void Reduction::unreduce_solution(
+        Solution& new_solution,
+        const std::vector<SetId>& added_sets,
+        const std::vector<SetId>& removed_sets) const
+{
+    // Each set of the original instance belongs to the unreduction operations
+    // of at most one set of the reduced instance, so the sets can be updated
+    // independently.
+    for (SetId set_id: removed_sets) {
+        for (SetId set_id_2: unreduction_operations_[set_id].in)
+            if (new_solution.contains(set_id_2))
+                new_solution.remove(set_id_2);
+        for (SetId set_id_2: unreduction_operations_[set_id].out)
+            if (!new_solution.contains(set_id_2))
+                new_solution.add(set_id_2);
+    }
+    for (SetId set_id: added_sets) {
+        for (SetId set_id_2: unreduction_operations_[set_id].in)
+            if (!new_solution.contains(set_id_2))
+                new_solution.add(set_id_2);
+        for (SetId set_id_2: unreduction_operations_[set_id].out)
+            if (new_solution.contains(set_id_2))
+                new_solution.remove(set_id_2);
+    }
+}
+
 Solution Reduction::unreduce_solution(
         const Solution& solution) const
 {
@@ -3100,3 +4683,294 @@ Cost Reduction::unreduce_bound(
 {
     return extra_cost_ + bound;
 }
+
+nlohmann::json Reduction::to_json() const
+{
+    nlohmann::json json = {
+        {"NumberOfRounds", number_of_rounds_},
+        {"Time", time_},
+        {"Rules", nlohmann::json::array()},
+    };
+    for (const RuleStatistics& rule_statistics: rule_statistics_) {
+        json["Rules"].push_back({
+                {"Rule", rule_statistics.rule},
+                {"Round", rule_statistics.round},
+                {"NumberOfCalls", rule_statistics.number_of_calls},
+                {"Time", rule_statistics.time},
+                {"NumberOfRemovedSets", rule_statistics.number_of_removed_sets},
+                {"NumberOfRemovedElements", rule_statistics.number_of_removed_elements},
+                {"NumberOfRemovedArcs", rule_statistics.number_of_removed_arcs},
+                {"NumberOfMandatorySets", rule_statistics.number_of_mandatory_sets},
+                {"NumberOfUpdates", rule_statistics.number_of_updates},
+                {"NumberOfSkippedCalls", rule_statistics.number_of_skipped_calls}});
+    }
+    return json;
+}
+
+void Reduction::format(
+        std::ostream& os,
+        int verbosity_level) const
+{
+    if (verbosity_level >= 1) {
+        os
+            << "Number of rounds:                             " << number_of_rounds_ << std::endl
+            << "Time (s):                                     " << time_ << std::endl
+            ;
+    }
+
+    if (verbosity_level >= 2) {
+        std::streamsize precision = os.precision();
+        os << std::right << std::endl
+            << std::setw(6) << "Round"
+            << std::setw(24) << "Rule"
+            << std::setw(8) << "Calls"
+            << std::setw(10) << "Time (s)"
+            << std::setw(12) << "# sets"
+            << std::setw(12) << "# elts"
+            << std::setw(12) << "# arcs"
+            << std::setw(10) << "# mand."
+            << std::setw(8) << "# upd."
+            << std::setw(8) << "# skip."
+            << std::endl
+            << std::setw(6) << "-----"
+            << std::setw(24) << "----"
+            << std::setw(8) << "-----"
+            << std::setw(10) << "--------"
+            << std::setw(12) << "------"
+            << std::setw(12) << "------"
+            << std::setw(12) << "------"
+            << std::setw(10) << "-------"
+            << std::setw(8) << "------"
+            << std::setw(8) << "-------"
+            << std::endl;
+        for (const RuleStatistics& rule_statistics: rule_statistics_) {
+            os
+                << std::setw(6) << rule_statistics.round
+                << std::setw(24) << rule_statistics.rule
+                << std::setw(8) << rule_statistics.number_of_calls
+                << std::setw(10) << std::fixed << std::setprecision(3) << rule_statistics.time << std::defaultfloat << std::setprecision(precision)
+                << std::setw(12) << rule_statistics.number_of_removed_sets
+                << std::setw(12) << rule_statistics.number_of_removed_elements
+                << std::setw(12) << rule_statistics.number_of_removed_arcs
+                << std::setw(10) << rule_statistics.number_of_mandatory_sets
+                << std::setw(8) << rule_statistics.number_of_updates
+                << std::setw(8) << rule_statistics.number_of_skipped_calls
+                << std::endl;
+        }
+    }
+}
+
+namespace
+{
+
+/** Write an array of a reduction file, padded to a multiple of 8 bytes. */
+template <typename T>
+void write_reduction_array(
+        std::ofstream& file,
+        const std::vector<T>& values)
+{
+    size_t size = values.size() * sizeof(T);
+    file.write((const char*)values.data(), size);
+    const char padding[8] = {};
+    file.write(padding, (8 - size % 8) % 8);
+}
+
+/** Read an array of a reduction file written by 'write_reduction_array'. */
+template <typename T>
+void read_reduction_array(
+        const char*& position,
+        const char* end,
+        std::vector<T>& values,
+        uint64_t number_of_values,
+        const std::string& name)
+{
+    uint64_t remaining_size = end - position;
+    if (number_of_values > remaining_size / sizeof(T)) {
+        throw std::runtime_error(
+                "setcoveringsolver::Reduction::read: "
+                "truncated file; "
+                "array: " + name + ".");
+    }
+    uint64_t size = number_of_values * sizeof(T);
+    values.resize(number_of_values);
+    memcpy(values.data(), position, size);
+    position += (std::min)(remaining_size, size + (8 - size % 8) % 8);
+}
+
+/** Check that the sets of an array belong to the original instance. */
+void check_reduction_set_ids(
+        const std::vector<SetId>& set_ids,
+        SetId number_of_sets,
+        const std::string& name)
+{
+    for (SetId set_id: set_ids) {
+        if (set_id < 0 || set_id >= number_of_sets) {
+            throw std::runtime_error(
+                    "setcoveringsolver::Reduction::read: "
+                    "invalid set id; "
+                    "array: " + name + "; "
+                    "set_id: " + std::to_string(set_id) + ".");
+        }
+    }
+}
+
+}
+
+void Reduction::write(const std::string& reduction_path) const
+{
+    std::ofstream file(reduction_path, std::ios::out | std::ios::binary);
+    if (!file.good()) {
+        throw std::runtime_error(
+                "Unable to open file \"" + reduction_path + "\".");
+    }
+
+    // Store the unreduction operations in CSR form.
+    std::vector<SetPos> in_offsets = {0};
+    std::vector<SetPos> out_offsets = {0};
+    std::vector<SetId> in_set_ids;
+    std::vector<SetId> out_set_ids;
+    for (const UnreductionOperations& operations: unreduction_operations_) {
+        in_set_ids.insert(in_set_ids.end(), operations.in.begin(), operations.in.end());
+        out_set_ids.insert(out_set_ids.end(), operations.out.begin(), operations.out.end());
+        in_offsets.push_back(in_set_ids.size());
+        out_offsets.push_back(out_set_ids.size());
+    }
+
+    const InstanceFingerprint& fingerprint = original_instance_->fingerprint();
+    std::vector<uint64_t> header = {
+        binary_magic_number,
+        binary_version,
+        sizeof(Index),
+        fingerprint.high,
+        fingerprint.low,
+        (uint64_t)original_instance_->number_of_sets(),
+        (uint64_t)extra_cost_,
+        (uint64_t)mandatory_sets_.size(),
+        (uint64_t)unreduction_operations_.size(),
+        (uint64_t)in_set_ids.size(),
+        (uint64_t)out_set_ids.size()};
+    write_reduction_array(file, header);
+    write_reduction_array(file, mandatory_sets_);
+    write_reduction_array(file, in_offsets);
+    write_reduction_array(file, in_set_ids);
+    write_reduction_array(file, out_offsets);
+    write_reduction_array(file, out_set_ids);
+
+    // The reduced instance fills the rest of the file.
+    instance_.write_binary(file);
+    if (!file.good()) {
+        throw std::runtime_error(
+                "setcoveringsolver::Reduction::write: "
+                "unable to write file \"" + reduction_path + "\".");
+    }
+}
+
+void Reduction::read(const std::string& reduction_path)
+{
+    MappedFile file(reduction_path);
+
+    // Read and check the header.
+    std::vector<uint64_t> header(11);
+    size_t header_size = header.size() * sizeof(uint64_t);
+    if (file.size() < header_size) {
+        throw std::runtime_error(
+                "setcoveringsolver::Reduction::read: "
+                "truncated file; "
+                "size: " + std::to_string(file.size()) + ".");
+    }
+    memcpy(header.data(), file.data(), header_size);
+    if (header[0] != binary_magic_number) {
+        throw std::runtime_error(
+                "setcoveringsolver::Reduction::read: "
+                "not a reduction file or written on a platform "
+                "with a different byte order.");
+    }
+    if (header[1] != binary_version) {
+        throw std::runtime_error(
+                "setcoveringsolver::Reduction::read: "
+                "unsupported version; "
+                "version: " + std::to_string(header[1]) + "; "
+                "supported version: " + std::to_string(binary_version) + ".");
+    }
+    if (header[2] != sizeof(Index)) {
+        throw std::runtime_error(
+                "setcoveringsolver::Reduction::read: "
+                "file written with a different index size; "
+                "index_size: " + std::to_string(header[2]) + ".");
+    }
+    const InstanceFingerprint& fingerprint = original_instance_->fingerprint();
+    if (header[3] != fingerprint.high
+            || header[4] != fingerprint.low
+            || header[5] != (uint64_t)original_instance_->number_of_sets()) {
+        throw std::runtime_error(
+                "setcoveringsolver::Reduction::read: "
+                "the reduction has been computed for another instance; "
+                "fingerprint: " + InstanceFingerprint{header[3], header[4]}.to_string() + "; "
+                "instance fingerprint: " + fingerprint.to_string() + ".");
+    }
+    for (int pos = 7; pos < 11; ++pos) {
+        if (header[pos] >= (uint64_t)std::numeric_limits<Index>::max()) {
+            throw std::runtime_error(
+                    "setcoveringsolver::Reduction::read: "
+                    "invalid size; "
+                    "value: " + std::to_string(header[pos]) + ".");
+        }
+    }
+    extra_cost_ = header[6];
+    SetId number_of_reduced_sets = header[8];
+
+    // Read the unreduction operations.
+    const char* position = file.data() + header_size;
+    const char* end = file.data() + file.size();
+    std::vector<SetPos> in_offsets;
+    std::vector<SetPos> out_offsets;
+    std::vector<SetId> in_set_ids;
+    std::vector<SetId> out_set_ids;
+    read_reduction_array(position, end, mandatory_sets_, header[7], "mandatory_sets");
+    read_reduction_array(position, end, in_offsets, number_of_reduced_sets + 1, "in_offsets");
+    read_reduction_array(position, end, in_set_ids, header[9], "in_set_ids");
+    read_reduction_array(position, end, out_offsets, number_of_reduced_sets + 1, "out_offsets");
+    read_reduction_array(position, end, out_set_ids, header[10], "out_set_ids");
+    SetId number_of_sets = original_instance_->number_of_sets();
+    check_reduction_set_ids(mandatory_sets_, number_of_sets, "mandatory_sets");
+    check_reduction_set_ids(in_set_ids, number_of_sets, "in_set_ids");
+    check_reduction_set_ids(out_set_ids, number_of_sets, "out_set_ids");
+    bool offsets_ok = (in_offsets.front() == 0
+            && out_offsets.front() == 0
+            && (uint64_t)in_offsets.back() == header[9]
+            && (uint64_t)out_offsets.back() == header[10]);
+    for (SetId set_id = 1;
+            offsets_ok && set_id <= number_of_reduced_sets;
+            ++set_id) {
+        offsets_ok = (in_offsets[set_id - 1] <= in_offsets[set_id]
+                && out_offsets[set_id - 1] <= out_offsets[set_id]);
+    }
+    if (!offsets_ok) {
+        throw std::runtime_error(
+                "setcoveringsolver::Reduction::read: "
+                "invalid offsets.");
+    }
+    unreduction_operations_ = std::vector<UnreductionOperations>(number_of_reduced_sets);
+    for (SetId set_id = 0; set_id < number_of_reduced_sets; ++set_id) {
+        UnreductionOperations& operations = unreduction_operations_[set_id];
+        operations.in.assign(
+                in_set_ids.begin() + in_offsets[set_id],
+                in_set_ids.begin() + in_offsets[set_id + 1]);
+        operations.out.assign(
+                out_set_ids.begin() + out_offsets[set_id],
+                out_set_ids.begin() + out_offsets[set_id + 1]);
+    }
+
+    // Read the reduced instance.
+    InstanceBuilder instance_builder;
+    instance_builder.set_number_of_threads(original_instance_->number_of_threads_);
+    instance_builder.read_binary(position, end - position);
+    instance_ = instance_builder.build();
+    if (instance_.number_of_sets() != number_of_reduced_sets) {
+        throw std::runtime_error(
+                "setcoveringsolver::Reduction::read: "
+                "inconsistent number of sets; "
+                "number_of_sets: " + std::to_string(instance_.number_of_sets()) + "; "
+                "number_of_unreduction_operations: " + std::to_string(number_of_reduced_sets) + ".");
+    }
+}
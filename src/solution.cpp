@@ -1,7 +1,10 @@
 #include "setcoveringsolver/solution.hpp"
 
+#include "setcoveringsolver/tokenizer.hpp"
+
 #include "optimizationtools/utils/utils.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 
@@ -23,18 +26,17 @@ Solution::Solution(
 {
     if (certificate_path.empty())
         return;
-    std::ifstream file(certificate_path);
-    if (!file.good()) {
-        throw std::runtime_error(
-                "Unable to open file \"" + certificate_path + "\".");
-    }
+    MappedFile file(certificate_path);
+    Tokenizer tokenizer(file.data(), file.data() + file.size());
 
-    SetId number_of_sets;
+    SetId number_of_sets = 0;
     SetId set_id;
-    file >> number_of_sets;
+    tokenizer.read_int(number_of_sets);
     for (SetPos set_pos = 0; set_pos < number_of_sets; ++set_pos) {
-        file >> set_id;
-        add(set_id);
+        if (!tokenizer.read_int(set_id))
+            break;
+        instance.check_set_index(set_id);
+        add(instance.set_id(set_id));
     }
 }
 
@@ -85,28 +87,35 @@ void Solution::write(
     file.close();
 }
 
-void Solution::write_gecco2020(
-        std::ofstream& file) const
+std::vector<SetId> Solution::original_set_ids() const
 {
-    file << number_of_sets() << std::endl;
+    std::vector<SetId> original_set_ids;
+    original_set_ids.reserve(number_of_sets());
     for (SetId set_id = 0;
             set_id < instance().number_of_sets();
             ++set_id) {
         if (contains(set_id))
-            file << set_id << " ";
+            original_set_ids.push_back(instance().original_set_id(set_id));
     }
+    if (instance().renumbered())
+        std::sort(original_set_ids.begin(), original_set_ids.end());
+    return original_set_ids;
+}
+
+void Solution::write_gecco2020(
+        std::ofstream& file) const
+{
+    file << number_of_sets() << std::endl;
+    for (SetId set_id: original_set_ids())
+        file << set_id << " ";
 }
 
 void Solution::write_pace2025(
         std::ostream& file) const
 {
     file << number_of_sets() << std::endl;
-    for (SetId set_id = 0;
-            set_id < instance().number_of_sets();
-            ++set_id) {
-        if (contains(set_id))
-            file << set_id + 1 << std::endl;
-    }
+    for (SetId set_id: original_set_ids())
+        file << set_id + 1 << std::endl;
 }
 
 void Solution::format(
@@ -0,0 +1,265 @@
+#include "setcoveringsolver/tokenizer.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#if SETCOVERINGSOLVER_USE_ZLIB
+#include <zlib.h>
+#endif
+
+#if SETCOVERINGSOLVER_USE_LZMA
+#include <lzma.h>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace setcoveringsolver;
+
+MappedFile::MappedFile(const std::string& path)
+{
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error(
+                "Unable to open file \"" + path + "\".");
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+        void* address = mmap(
+                nullptr,
+                file_stat.st_size,
+                PROT_READ,
+                MAP_PRIVATE,
+                fd,
+                0);
+        if (address != MAP_FAILED) {
+            madvise(address, file_stat.st_size, MADV_WILLNEED);
+            data_ = (const char*)address;
+            size_ = file_stat.st_size;
+            mapped_ = true;
+        }
+    }
+    close(fd);
+    if (mapped_)
+        return;
+#endif
+
+    // Fallback: read the whole file.
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good()) {
+        throw std::runtime_error(
+                "Unable to open file \"" + path + "\".");
+    }
+    buffer_.assign(
+            std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+    if (mapped_)
+        munmap((void*)data_, size_);
+#endif
+}
+
+CompressionFormat setcoveringsolver::detect_compression_format(
+        const char* data,
+        size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    if (size >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b)
+        return CompressionFormat::Gzip;
+    if (size >= 6 && memcmp(data, "\xfd" "7zXZ\0", 6) == 0)
+        return CompressionFormat::Xz;
+    return CompressionFormat::None;
+}
+
+DecompressingSource::DecompressingSource(
+        const char* data,
+        size_t size,
+        CompressionFormat compression_format):
+    data_(data),
+    size_(size),
+    compression_format_(compression_format)
+{
+#if !SETCOVERINGSOLVER_USE_ZLIB
+    if (compression_format == CompressionFormat::Gzip) {
+        throw std::invalid_argument(
+                "setcoveringsolver::DecompressingSource: "
+                "gzip-compressed files are not supported; "
+                "compile with option SETCOVERINGSOLVER_USE_ZLIB.");
+    }
+#endif
+#if !SETCOVERINGSOLVER_USE_LZMA
+    if (compression_format == CompressionFormat::Xz) {
+        throw std::invalid_argument(
+                "setcoveringsolver::DecompressingSource: "
+                "xz-compressed files are not supported; "
+                "compile with option SETCOVERINGSOLVER_USE_LZMA.");
+    }
+#endif
+    thread_ = std::thread(&DecompressingSource::decompress, this);
+}
+
+DecompressingSource::~DecompressingSource()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_variable_.notify_all();
+    thread_.join();
+}
+
+size_t DecompressingSource::read(
+        char* buffer,
+        size_t size)
+{
+    if (block_position_ == block_.size()) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_variable_.wait(lock, [this] { return !blocks_.empty() || finished_; });
+        if (blocks_.empty()) {
+            if (exception_)
+                std::rethrow_exception(exception_);
+            return 0;
+        }
+        block_ = std::move(blocks_.front());
+        blocks_.pop_front();
+        block_position_ = 0;
+        lock.unlock();
+        condition_variable_.notify_all();
+    }
+    size_t number_of_characters = (std::min)(size, block_.size() - block_position_);
+    memcpy(buffer, block_.data() + block_position_, number_of_characters);
+    block_position_ += number_of_characters;
+    return number_of_characters;
+}
+
+void DecompressingSource::decompress()
+{
+    try {
+        if (compression_format_ == CompressionFormat::Gzip) {
+            decompress_gzip();
+        } else {
+            decompress_xz();
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        exception_ = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+    }
+    condition_variable_.notify_all();
+}
+
+bool DecompressingSource::push_block(std::vector<char>&& block)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_variable_.wait(lock, [this] { return blocks_.size() < maximum_number_of_blocks_ || stop_; });
+        if (stop_)
+            return false;
+        blocks_.push_back(std::move(block));
+    }
+    condition_variable_.notify_all();
+    return true;
+}
+
+void DecompressingSource::decompress_gzip()
+{
+#if SETCOVERINGSOLVER_USE_ZLIB
+    z_stream stream = {};
+    // 15 + 32: maximum window size, automatic zlib/gzip header detection.
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+        throw std::runtime_error(
+                "setcoveringsolver::DecompressingSource::decompress_gzip: "
+                "unable to initialize zlib.");
+    }
+    stream.next_in = (Bytef*)data_;
+    stream.avail_in = 0;
+    size_t remaining_size = size_;
+    for (;;) {
+        std::vector<char> block(block_size_);
+        stream.next_out = (Bytef*)block.data();
+        stream.avail_out = block.size();
+        int status = Z_OK;
+        while (stream.avail_out > 0) {
+            if (stream.avail_in == 0 && remaining_size > 0) {
+                // 'avail_in' is a 32-bit integer.
+                stream.avail_in = (uInt)(std::min)(remaining_size, (size_t)1 << 30);
+                remaining_size -= stream.avail_in;
+            }
+            status = inflate(&stream, Z_NO_FLUSH);
+            if (status == Z_STREAM_END) {
+                // A gzip file may contain several concatenated members.
+                if (stream.avail_in == 0 && remaining_size == 0)
+                    break;
+                inflateReset(&stream);
+            } else if (status != Z_OK) {
+                inflateEnd(&stream);
+                throw std::runtime_error(
+                        "setcoveringsolver::DecompressingSource::decompress_gzip: "
+                        "invalid or truncated gzip data; "
+                        "status: " + std::to_string(status) + ".");
+            }
+        }
+        block.resize(block.size() - stream.avail_out);
+        bool end = (status == Z_STREAM_END);
+        if (!block.empty() && !push_block(std::move(block)))
+            break;
+        if (end)
+            break;
+    }
+    inflateEnd(&stream);
+#endif
+}
+
+void DecompressingSource::decompress_xz()
+{
+#if SETCOVERINGSOLVER_USE_LZMA
+    lzma_stream stream = LZMA_STREAM_INIT;
+    if (lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+        throw std::runtime_error(
+                "setcoveringsolver::DecompressingSource::decompress_xz: "
+                "unable to initialize liblzma.");
+    }
+    stream.next_in = (const uint8_t*)data_;
+    stream.avail_in = size_;
+    for (;;) {
+        std::vector<char> block(block_size_);
+        stream.next_out = (uint8_t*)block.data();
+        stream.avail_out = block.size();
+        lzma_ret status = LZMA_OK;
+        while (stream.avail_out > 0) {
+            status = lzma_code(&stream, LZMA_FINISH);
+            if (status == LZMA_STREAM_END)
+                break;
+            if (status != LZMA_OK) {
+                lzma_end(&stream);
+                throw std::runtime_error(
+                        "setcoveringsolver::DecompressingSource::decompress_xz: "
+                        "invalid or truncated xz data; "
+                        "status: " + std::to_string(status) + ".");
+            }
+        }
+        block.resize(block.size() - stream.avail_out);
+        bool end = (status == LZMA_STREAM_END);
+        if (!block.empty() && !push_block(std::move(block)))
+            break;
+        if (end)
+            break;
+    }
+    lzma_end(&stream);
+#endif
+}